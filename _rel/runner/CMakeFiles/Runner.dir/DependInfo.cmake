@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/runner/Coordinator.cpp" "runner/CMakeFiles/Runner.dir/Coordinator.cpp.o" "gcc" "runner/CMakeFiles/Runner.dir/Coordinator.cpp.o.d"
+  "/root/repo/runner/Daemon.cpp" "runner/CMakeFiles/Runner.dir/Daemon.cpp.o" "gcc" "runner/CMakeFiles/Runner.dir/Daemon.cpp.o.d"
+  "/root/repo/runner/main.cpp" "runner/CMakeFiles/Runner.dir/main.cpp.o" "gcc" "runner/CMakeFiles/Runner.dir/main.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_rel/src/CMakeFiles/TrainTracks.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
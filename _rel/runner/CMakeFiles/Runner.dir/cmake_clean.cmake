@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/Runner.dir/Coordinator.cpp.o"
+  "CMakeFiles/Runner.dir/Coordinator.cpp.o.d"
+  "CMakeFiles/Runner.dir/Daemon.cpp.o"
+  "CMakeFiles/Runner.dir/Daemon.cpp.o.d"
+  "CMakeFiles/Runner.dir/main.cpp.o"
+  "CMakeFiles/Runner.dir/main.cpp.o.d"
+  "Runner"
+  "Runner.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Runner.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
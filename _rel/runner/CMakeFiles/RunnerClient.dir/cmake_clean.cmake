@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/RunnerClient.dir/client.cpp.o"
+  "CMakeFiles/RunnerClient.dir/client.cpp.o.d"
+  "RunnerClient"
+  "RunnerClient.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/RunnerClient.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
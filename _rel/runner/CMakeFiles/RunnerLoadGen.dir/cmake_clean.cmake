@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/RunnerLoadGen.dir/loadgen.cpp.o"
+  "CMakeFiles/RunnerLoadGen.dir/loadgen.cpp.o.d"
+  "RunnerLoadGen"
+  "RunnerLoadGen.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/RunnerLoadGen.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/BatchSolver.cpp" "src/CMakeFiles/TrainTracks.dir/BatchSolver.cpp.o" "gcc" "src/CMakeFiles/TrainTracks.dir/BatchSolver.cpp.o.d"
+  "/root/repo/src/Connections.cpp" "src/CMakeFiles/TrainTracks.dir/Connections.cpp.o" "gcc" "src/CMakeFiles/TrainTracks.dir/Connections.cpp.o.d"
+  "/root/repo/src/Grid.cpp" "src/CMakeFiles/TrainTracks.dir/Grid.cpp.o" "gcc" "src/CMakeFiles/TrainTracks.dir/Grid.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
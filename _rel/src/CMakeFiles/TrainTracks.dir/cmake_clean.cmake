@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/TrainTracks.dir/BatchSolver.cpp.o"
+  "CMakeFiles/TrainTracks.dir/BatchSolver.cpp.o.d"
+  "CMakeFiles/TrainTracks.dir/Connections.cpp.o"
+  "CMakeFiles/TrainTracks.dir/Connections.cpp.o.d"
+  "CMakeFiles/TrainTracks.dir/Grid.cpp.o"
+  "CMakeFiles/TrainTracks.dir/Grid.cpp.o.d"
+  "libTrainTracks.a"
+  "libTrainTracks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TrainTracks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTArena.dir/UTArena.cpp.o"
+  "CMakeFiles/UTArena.dir/UTArena.cpp.o.d"
+  "UTArena"
+  "UTArena.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTArena.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
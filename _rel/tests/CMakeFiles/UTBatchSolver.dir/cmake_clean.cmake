@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTBatchSolver.dir/UTBatchSolver.cpp.o"
+  "CMakeFiles/UTBatchSolver.dir/UTBatchSolver.cpp.o.d"
+  "UTBatchSolver"
+  "UTBatchSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTBatchSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
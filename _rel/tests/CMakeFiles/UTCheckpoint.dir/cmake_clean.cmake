@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTCheckpoint.dir/UTCheckpoint.cpp.o"
+  "CMakeFiles/UTCheckpoint.dir/UTCheckpoint.cpp.o.d"
+  "UTCheckpoint"
+  "UTCheckpoint.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTCheckpoint.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTConnections.dir/UTConnections.cpp.o"
+  "CMakeFiles/UTConnections.dir/UTConnections.cpp.o.d"
+  "UTConnections"
+  "UTConnections.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTConnections.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTFrontierSolver.dir/UTFrontierSolver.cpp.o"
+  "CMakeFiles/UTFrontierSolver.dir/UTFrontierSolver.cpp.o.d"
+  "UTFrontierSolver"
+  "UTFrontierSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTFrontierSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTGenerator.dir/UTGenerator.cpp.o"
+  "CMakeFiles/UTGenerator.dir/UTGenerator.cpp.o.d"
+  "UTGenerator"
+  "UTGenerator.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTGenerator.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTGrid.dir/UTGrid.cpp.o"
+  "CMakeFiles/UTGrid.dir/UTGrid.cpp.o.d"
+  "UTGrid"
+  "UTGrid.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTGrid.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTHintEngine.dir/UTHintEngine.cpp.o"
+  "CMakeFiles/UTHintEngine.dir/UTHintEngine.cpp.o.d"
+  "UTHintEngine"
+  "UTHintEngine.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTHintEngine.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTIncrementalSolver.dir/UTIncrementalSolver.cpp.o"
+  "CMakeFiles/UTIncrementalSolver.dir/UTIncrementalSolver.cpp.o.d"
+  "UTIncrementalSolver"
+  "UTIncrementalSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTIncrementalSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTLiveRenderer.dir/UTLiveRenderer.cpp.o"
+  "CMakeFiles/UTLiveRenderer.dir/UTLiveRenderer.cpp.o.d"
+  "UTLiveRenderer"
+  "UTLiveRenderer.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTLiveRenderer.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
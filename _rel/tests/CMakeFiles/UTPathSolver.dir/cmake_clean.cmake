@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPathSolver.dir/UTPathSolver.cpp.o"
+  "CMakeFiles/UTPathSolver.dir/UTPathSolver.cpp.o.d"
+  "UTPathSolver"
+  "UTPathSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPathSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
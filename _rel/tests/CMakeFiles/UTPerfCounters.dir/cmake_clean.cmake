@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPerfCounters.dir/UTPerfCounters.cpp.o"
+  "CMakeFiles/UTPerfCounters.dir/UTPerfCounters.cpp.o.d"
+  "UTPerfCounters"
+  "UTPerfCounters.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPerfCounters.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
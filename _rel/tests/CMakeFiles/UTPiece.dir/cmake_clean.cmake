@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPiece.dir/UTPiece.cpp.o"
+  "CMakeFiles/UTPiece.dir/UTPiece.cpp.o.d"
+  "UTPiece"
+  "UTPiece.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPiece.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
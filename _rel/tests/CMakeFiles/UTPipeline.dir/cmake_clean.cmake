@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPipeline.dir/UTPipeline.cpp.o"
+  "CMakeFiles/UTPipeline.dir/UTPipeline.cpp.o.d"
+  "UTPipeline"
+  "UTPipeline.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPipeline.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
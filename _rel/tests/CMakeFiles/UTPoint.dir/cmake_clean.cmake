@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPoint.dir/UTPoint.cpp.o"
+  "CMakeFiles/UTPoint.dir/UTPoint.cpp.o.d"
+  "UTPoint"
+  "UTPoint.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPoint.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPortfolioSolver.dir/UTPortfolioSolver.cpp.o"
+  "CMakeFiles/UTPortfolioSolver.dir/UTPortfolioSolver.cpp.o.d"
+  "UTPortfolioSolver"
+  "UTPortfolioSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPortfolioSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
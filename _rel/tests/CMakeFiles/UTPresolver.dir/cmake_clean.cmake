@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPresolver.dir/UTPresolver.cpp.o"
+  "CMakeFiles/UTPresolver.dir/UTPresolver.cpp.o.d"
+  "UTPresolver"
+  "UTPresolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPresolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
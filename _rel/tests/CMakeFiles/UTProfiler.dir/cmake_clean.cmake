@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTProfiler.dir/UTProfiler.cpp.o"
+  "CMakeFiles/UTProfiler.dir/UTProfiler.cpp.o.d"
+  "UTProfiler"
+  "UTProfiler.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTProfiler.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTPuzzle.dir/UTPuzzle.cpp.o"
+  "CMakeFiles/UTPuzzle.dir/UTPuzzle.cpp.o.d"
+  "UTPuzzle"
+  "UTPuzzle.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTPuzzle.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
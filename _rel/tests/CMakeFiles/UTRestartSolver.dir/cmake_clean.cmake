@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTRestartSolver.dir/UTRestartSolver.cpp.o"
+  "CMakeFiles/UTRestartSolver.dir/UTRestartSolver.cpp.o.d"
+  "UTRestartSolver"
+  "UTRestartSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTRestartSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
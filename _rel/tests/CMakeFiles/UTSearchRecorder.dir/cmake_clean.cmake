@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTSearchRecorder.dir/UTSearchRecorder.cpp.o"
+  "CMakeFiles/UTSearchRecorder.dir/UTSearchRecorder.cpp.o.d"
+  "UTSearchRecorder"
+  "UTSearchRecorder.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTSearchRecorder.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTSegmentSolver.dir/UTSegmentSolver.cpp.o"
+  "CMakeFiles/UTSegmentSolver.dir/UTSegmentSolver.cpp.o.d"
+  "UTSegmentSolver"
+  "UTSegmentSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTSegmentSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
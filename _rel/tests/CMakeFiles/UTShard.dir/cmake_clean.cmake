@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTShard.dir/UTShard.cpp.o"
+  "CMakeFiles/UTShard.dir/UTShard.cpp.o.d"
+  "UTShard"
+  "UTShard.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTShard.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTSolver.dir/UTSolver.cpp.o"
+  "CMakeFiles/UTSolver.dir/UTSolver.cpp.o.d"
+  "UTSolver"
+  "UTSolver.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTSolver.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
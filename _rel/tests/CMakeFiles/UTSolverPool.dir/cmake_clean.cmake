@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTSolverPool.dir/UTSolverPool.cpp.o"
+  "CMakeFiles/UTSolverPool.dir/UTSolverPool.cpp.o.d"
+  "UTSolverPool"
+  "UTSolverPool.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTSolverPool.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/UTTrace.dir/UTTrace.cpp.o"
+  "CMakeFiles/UTTrace.dir/UTTrace.cpp.o.d"
+  "UTTrace"
+  "UTTrace.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/UTTrace.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
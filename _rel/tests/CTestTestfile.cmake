@@ -0,0 +1,58 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_rel/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(UTArena.test "UTArena")
+set_tests_properties(UTArena.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTBatchSolver.test "UTBatchSolver")
+set_tests_properties(UTBatchSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTCheckpoint.test "UTCheckpoint")
+set_tests_properties(UTCheckpoint.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTConnections.test "UTConnections")
+set_tests_properties(UTConnections.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTFrontierSolver.test "UTFrontierSolver")
+set_tests_properties(UTFrontierSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTGenerator.test "UTGenerator")
+set_tests_properties(UTGenerator.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTGrid.test "UTGrid")
+set_tests_properties(UTGrid.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTHintEngine.test "UTHintEngine")
+set_tests_properties(UTHintEngine.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTIncrementalSolver.test "UTIncrementalSolver")
+set_tests_properties(UTIncrementalSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTLiveRenderer.test "UTLiveRenderer")
+set_tests_properties(UTLiveRenderer.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPathSolver.test "UTPathSolver")
+set_tests_properties(UTPathSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPerfCounters.test "UTPerfCounters")
+set_tests_properties(UTPerfCounters.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPiece.test "UTPiece")
+set_tests_properties(UTPiece.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPipeline.test "UTPipeline")
+set_tests_properties(UTPipeline.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPoint.test "UTPoint")
+set_tests_properties(UTPoint.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPortfolioSolver.test "UTPortfolioSolver")
+set_tests_properties(UTPortfolioSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPresolver.test "UTPresolver")
+set_tests_properties(UTPresolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTProfiler.test "UTProfiler")
+set_tests_properties(UTProfiler.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTPuzzle.test "UTPuzzle")
+set_tests_properties(UTPuzzle.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTRestartSolver.test "UTRestartSolver")
+set_tests_properties(UTRestartSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTSearchRecorder.test "UTSearchRecorder")
+set_tests_properties(UTSearchRecorder.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTSegmentSolver.test "UTSegmentSolver")
+set_tests_properties(UTSegmentSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTShard.test "UTShard")
+set_tests_properties(UTShard.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTSolver.test "UTSolver")
+set_tests_properties(UTSolver.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTSolverPool.test "UTSolverPool")
+set_tests_properties(UTSolverPool.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(UTTrace.test "UTTrace")
+set_tests_properties(UTTrace.test PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;14;add_test;/root/repo/tests/CMakeLists.txt;0;")
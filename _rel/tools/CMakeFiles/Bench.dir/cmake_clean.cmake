@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "Bench"
+  "Bench.pdb"
+  "CMakeFiles/Bench.dir/bench.cpp.o"
+  "CMakeFiles/Bench.dir/bench.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/Bench.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/SearchReplay.dir/replay.cpp.o"
+  "CMakeFiles/SearchReplay.dir/replay.cpp.o.d"
+  "SearchReplay"
+  "SearchReplay.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/SearchReplay.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/TraceDump.dir/tracedump.cpp.o"
+  "CMakeFiles/TraceDump.dir/tracedump.cpp.o.d"
+  "TraceDump"
+  "TraceDump.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/TraceDump.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
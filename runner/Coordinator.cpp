@@ -0,0 +1,180 @@
+#include "Coordinator.h"
+
+#include "Utils.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace TrainTracks {
+
+    Coordinator::Coordinator(const std::string& exe, const std::vector<std::string>& files, size_t shards)
+        : _shards(shards)
+        , _reported(0)
+        , _exhausted(0)
+    {
+        for (const auto& file : files) {
+            int fds[2];
+            if (::pipe2(fds, O_CLOEXEC) != 0) {
+                const auto error = std::string("pipe: ") + std::strerror(errno);
+                Stop();
+                Reap();
+                throw std::runtime_error(error);
+            }
+            const auto pid = ::fork();
+            if (pid == 0) {
+                ::dup2(fds[1], STDOUT_FILENO);
+                ::execl(exe.c_str(), exe.c_str(), "--solve-shard", file.c_str(), static_cast<char*>(nullptr));
+                ::_exit(127);
+            }
+            ::close(fds[1]);
+            if (pid < 0) {
+                const auto error = std::string("fork: ") + std::strerror(errno);
+                ::close(fds[0]);
+                Stop();
+                Reap();
+                throw std::runtime_error(error);
+            }
+            Worker w;
+            w.pid = pid;
+            w.fd = fds[0];
+            _workers.push_back(std::move(w));
+        }
+    }
+
+    Coordinator::~Coordinator() {
+        for (auto& w : _workers) {
+            if (w.pid > 0) {
+                ::kill(w.pid, SIGKILL);
+            }
+        }
+        Reap();
+    }
+
+    SolveResult Coordinator::Run(SolveClock::time_point deadline, const std::atomic<bool>* cancel) {
+        const auto start = SolveClock::now();
+        SolveResult merged;
+        bool stopped = false;
+        std::vector<pollfd> fds;
+        std::vector<Worker*> open;
+        for (;;) {
+            fds.clear();
+            open.clear();
+            for (auto& w : _workers) {
+                if (w.fd >= 0) {
+                    fds.push_back(pollfd{ w.fd, POLLIN, 0 });
+                    open.push_back(&w);
+                }
+            }
+            if (fds.empty()) {
+                break;
+            }
+            if (!stopped && cancel && cancel->load()) {
+                merged.status = SolveStatus::Cancelled;
+                stopped = true;
+                Stop();
+            } else if (!stopped && SolveClock::now() >= deadline) {
+                merged.status = SolveStatus::TimedOut;
+                stopped = true;
+                Stop();
+            }
+
+            // Wake up now and then to check the deadline and cancellation
+            int wait = 50;
+            if (!stopped && deadline != SolveClock::time_point::max()) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - SolveClock::now());
+                wait = static_cast<int>(std::clamp<int64_t>(left.count() + 1, 1, wait));
+            }
+            if (::poll(fds.data(), fds.size(), wait) < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("poll: ") + std::strerror(errno));
+            }
+            for (size_t i = 0; i < fds.size(); i++) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                auto& w = *open[i];
+                char chunk[64 * 1024];
+                const auto n = ::read(w.fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    ::close(w.fd);
+                    w.fd = -1;
+                    continue;
+                }
+                w.buffer.append(chunk, n);
+                size_t nl;
+                while ((nl = w.buffer.find('\n')) != std::string::npos) {
+                    const auto line = w.buffer.substr(0, nl);
+                    w.buffer.erase(0, nl + 1);
+                    Merge(line, merged);
+                    if (merged.solved() && !stopped) {
+                        stopped = true;
+                        Stop();
+                    }
+                }
+            }
+        }
+        Reap();
+
+        if (!stopped && _exhausted < _shards) {
+            throw std::runtime_error("Shard workers stopped after " + std::to_string(_exhausted) + " of " +
+                std::to_string(_shards) + " shards");
+        }
+        merged.elapsed = SolveClock::now() - start;
+        return merged;
+    }
+
+    void Coordinator::Merge(const std::string& line, SolveResult& merged) {
+        const auto status = json_value(line, "status");
+        if (status == "\"Error\"") {
+            throw std::runtime_error("Shard " + std::string(json_value(line, "id")) + ": " +
+                std::string(trim(json_value(line, "error"))));
+        }
+        _reported++;
+        const auto steps = json_value(line, "steps");
+        merged.steps += steps.empty() ? 0 : std::stoull(std::string(steps));
+        const auto peak = json_value(line, "peak_bytes");
+        merged.peakBytes = std::max<size_t>(merged.peakBytes, peak.empty() ? 0 : std::stoull(std::string(peak)));
+        if (status == "\"Unsolvable\"") {
+            _exhausted++;
+        } else if (status == "\"Solved\"" && !merged.solved()) {
+            merged.status = SolveStatus::Solved;
+            const auto solution = json_value(line, "solution");
+            if (startsWith(solution, "[")) {
+                parse_as_integers(std::string(solution.substr(1)), ',', [&merged](int i) {
+                    merged.solution.push_back(static_cast<Piece>(i));
+                });
+            }
+        }
+    }
+
+    // Workers take SIGTERM as cancelling the search they're on
+    void Coordinator::Stop() {
+        for (auto& w : _workers) {
+            if (w.pid > 0) {
+                ::kill(w.pid, SIGTERM);
+            }
+        }
+    }
+
+    void Coordinator::Reap() {
+        for (auto& w : _workers) {
+            if (w.fd >= 0) {
+                ::close(w.fd);
+                w.fd = -1;
+            }
+            while (w.pid > 0 && ::waitpid(w.pid, nullptr, 0) < 0 && errno == EINTR) { }
+            w.pid = -1;
+        }
+    }
+}
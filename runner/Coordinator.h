@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Solver.h"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace TrainTracks {
+
+    // Runs a sharded search (see Shard.h) as local processes, one
+    // `Runner --solve-shard <file>` per shard file. Each worker writes a
+    // Protocol.h result line, with the shard number as its id, for every
+    // shard it finishes and stops at the first it solves. The lines are
+    // merged as they arrive and the other workers are stopped as soon as
+    // one finds the solution.
+    class Coordinator {
+    public:
+        // Starts the workers straight away
+        Coordinator(const std::string& exe, const std::vector<std::string>& files, size_t shards);
+        ~Coordinator();
+
+        Coordinator(const Coordinator&) = delete;
+        Coordinator& operator=(const Coordinator&) = delete;
+
+        // Waits until a worker solves it, every shard has been searched, or
+        // the deadline or cancellation stops them. Steps are summed over
+        // every shard reported, finished or not. Throws if a worker dies
+        // before its shards are done.
+        SolveResult Run(SolveClock::time_point deadline, const std::atomic<bool>* cancel);
+
+        size_t Workers() const {
+            return _workers.size();
+        }
+
+        // Shards reported, and those searched to the end without a solution
+        size_t Reported() const {
+            return _reported;
+        }
+
+        size_t Exhausted() const {
+            return _exhausted;
+        }
+
+    private:
+        struct Worker {
+            pid_t pid = -1;
+            int fd = -1;
+            std::string buffer;
+        };
+
+        void Merge(const std::string& line, SolveResult& merged);
+        void Stop();
+        void Reap();
+
+        std::vector<Worker> _workers;
+        const size_t _shards;
+        size_t _reported;
+        size_t _exhausted;
+    };
+}
@@ -0,0 +1,136 @@
+#include "Daemon.h"
+#include "Protocol.h"
+#include "Socket.h"
+
+#include <iostream>
+#include <thread>
+
+namespace TrainTracks {
+
+    namespace {
+        struct Pending {
+            std::string id;
+            std::future<SolveResult> result;
+            std::string error;
+            bool failed = false;
+        };
+
+        // Optional per-request limits, on top of the pool's task timeout
+        SolveOptions RequestOptions(std::string_view request) {
+            SolveOptions options;
+            const auto deadline = json_value(request, "deadline_ms");
+            if (!deadline.empty()) {
+                options.deadline = SolveClock::now() + std::chrono::milliseconds(std::stol(std::string(deadline)));
+            }
+            const auto steps = json_value(request, "max_steps");
+            if (!steps.empty()) {
+                options.maxSteps = std::stoull(std::string(steps));
+            }
+            return options;
+        }
+    }
+
+    Daemon::Daemon(std::string path, const SolverPoolOptions& options)
+        : _path(std::move(path))
+        , _pool(options)
+        , _listenFd(LineSocket::Listen(_path))
+        , _stopping(false)
+    { }
+
+    Daemon::~Daemon() {
+        ::close(_listenFd);
+        ::unlink(_path.c_str());
+    }
+
+    void Daemon::Stop() {
+        _stopping = true;
+        ::shutdown(_listenFd, SHUT_RDWR);
+    }
+
+    void Daemon::Run() {
+        while (!_stopping) {
+            const int fd = ::accept(_listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (!_stopping) {
+                    std::cerr << "accept: " << std::strerror(errno) << std::endl;
+                }
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _connections.insert(fd);
+            std::thread([this, fd] { Serve(fd); }).detach();
+        }
+
+        // Stop reading new requests but let the ones in flight finish
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (const auto fd : _connections) {
+            ::shutdown(fd, SHUT_RD);
+        }
+        _drained.wait(lock, [this] { return _connections.empty(); });
+    }
+
+    void Daemon::Serve(int fd) {
+        LineSocket socket(fd);
+        BoundedQueue<Pending> pending(PipelineDepth);
+
+        std::thread writer([&socket, &pending] {
+            bool open = true;
+            Pending p;
+            while (pending.Pop(p)) {
+                std::string line;
+                if (p.failed) {
+                    line = FormatError(p.id, p.error);
+                } else {
+                    try {
+                        line = FormatResult(p.id, p.result.get());
+                    } catch (const std::exception& e) {
+                        line = FormatError(p.id, e.what());
+                    }
+                }
+                // Keep draining after the peer goes so the reader never blocks
+                open = open && socket.Write(line);
+            }
+        });
+
+        std::string line;
+        try {
+            while (socket.ReadLine(line)) {
+                if (trim(line).empty()) {
+                    continue;
+                }
+                Pending p;
+                p.id = RequestId(line);
+                try {
+                    p.result = _pool.Submit(Puzzle::fromJson(line), RequestOptions(line));
+                } catch (const std::exception& e) {
+                    p.failed = true;
+                    p.error = e.what();
+                }
+                if (!pending.Push(std::move(p))) {
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            // A request too long to take, answered and the connection closed
+            Pending p;
+            p.id = "null";
+            p.failed = true;
+            p.error = e.what();
+            pending.Push(std::move(p));
+        }
+
+        pending.Close();
+        writer.join();
+
+        // Forget the descriptor before it is closed and can be reused
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connections.erase(fd);
+        if (_connections.empty()) {
+            _drained.notify_all();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SolverPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace TrainTracks {
+
+    // Serves solve requests on a Unix domain socket until stopped. Every
+    // connection is read and answered in order (see Protocol.h) while its
+    // puzzles are solved on one shared SolverPool, so the workers and their
+    // solvers stay warm across requests and clients. A connection may
+    // pipeline up to PipelineDepth requests before reads stop.
+    class Daemon {
+    public:
+        static constexpr size_t PipelineDepth = 256;
+
+        Daemon(std::string path, const SolverPoolOptions& options = SolverPoolOptions());
+        ~Daemon();
+
+        Daemon(const Daemon&) = delete;
+        Daemon& operator=(const Daemon&) = delete;
+
+        // Accepts connections until Stop, then drains the open ones
+        void Run();
+
+        // Only touches an atomic and shuts the listening socket down, so it
+        // is safe to call from a signal handler
+        void Stop();
+
+        const SolverPool& Pool() const {
+            return _pool;
+        }
+
+    private:
+        void Serve(int fd);
+
+        const std::string _path;
+        SolverPool _pool;
+        int _listenFd;
+        std::atomic<bool> _stopping;
+
+        std::mutex _mutex;
+        std::condition_variable _drained;
+        std::set<int> _connections;
+    };
+}
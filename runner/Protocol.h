@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Puzzle.h"
+#include "Solver.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Wire format shared by the daemon, client and load generator. Requests are
+// one puzzle per line in Puzzle::fromJson format, with an optional "id" that
+// is echoed back verbatim. Each request gets exactly one response line, in
+// request order:
+//   {"id":7,"status":"Solved","steps":124,"elapsed_us":310,"waited_us":12,"peak_bytes":1152,"solution":[...]}
+//   {"id":8,"status":"Error","error":"Invalid number of exits"}
+// A line longer than LineSocket::MaxLine gets an error with a null id and
+// the daemon closes the connection.
+
+namespace TrainTracks {
+
+    inline std::string RequestId(std::string_view request) {
+        const auto id = json_value(request, "id");
+        return id.empty() ? std::string("null") : std::string(id);
+    }
+
+    inline std::string FormatResult(std::string_view id, const SolveResult& r) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        std::string out;
+        out.reserve(96 + r.solution.size() * 2);
+        out.append("{\"id\":").append(id);
+        out.append(",\"status\":\"").append(SolveStatusName(r.status)).append("\"");
+        out.append(",\"steps\":").append(std::to_string(r.steps));
+        out.append(",\"elapsed_us\":").append(std::to_string(duration_cast<microseconds>(r.elapsed).count()));
+        out.append(",\"waited_us\":").append(std::to_string(duration_cast<microseconds>(r.waited).count()));
+        out.append(",\"peak_bytes\":").append(std::to_string(r.peakBytes));
+        if (!r.solution.empty()) {
+            out.append(",\"solution\":[");
+            for (size_t i = 0; i < r.solution.size(); i++) {
+                if (i) { out.append(1, ','); }
+                out.append(std::to_string(static_cast<int>(r.solution[i])));
+            }
+            out.append(1, ']');
+        }
+        out.append("}\n");
+        return out;
+    }
+
+    inline std::string FormatError(std::string_view id, std::string_view message) {
+        std::string out;
+        out.append("{\"id\":").append(id);
+        out.append(",\"status\":\"Error\",\"error\":\"");
+        for (const auto c : message) {
+            if (c == '"' || c == '\\') {
+                out.append(1, '\\');
+            }
+            out.append(1, c == '\n' ? ' ' : c);
+        }
+        out.append("\"}\n");
+        return out;
+    }
+
+    // Request lines from a file: .jsonl holds one request per line, .json a
+    // single request, anything else is read with Puzzle::loadFromFile
+    inline void LoadRequests(const std::string& path, std::vector<std::string>& requests) {
+        if (endsWith(path, ".jsonl") || endsWith(path, ".json")) {
+            std::ifstream ifs(path);
+            if (!ifs) {
+                throw std::runtime_error("Unable to open " + path);
+            }
+            std::string line, whole;
+            while (std::getline(ifs, line)) {
+                if (endsWith(path, ".json")) {
+                    whole.append(trim(line));
+                } else if (!trim(line).empty()) {
+                    requests.push_back(line);
+                }
+            }
+            if (!whole.empty()) {
+                requests.push_back(whole);
+            }
+            return;
+        }
+        requests.push_back(Puzzle::loadFromFile(path).toJson());
+    }
+
+    // Request lines from a stream: one request per line if it starts with
+    // '{', otherwise a single puzzle in Puzzle::load's text format
+    inline void LoadRequests(std::istream& is, std::vector<std::string>& requests) {
+        is >> std::ws;
+        if (is.peek() != '{') {
+            requests.push_back(Puzzle::load(is).toJson());
+            return;
+        }
+        std::string line;
+        while (std::getline(is, line)) {
+            if (!trim(line).empty()) {
+                requests.push_back(line);
+            }
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace TrainTracks {
+
+    // Newline delimited messages over a connected stream socket
+    class LineSocket {
+    public:
+        static constexpr size_t MaxLine = 1 << 20;
+
+        explicit LineSocket(int fd, size_t maxLine = MaxLine)
+            : _fd(fd)
+            , _start(0)
+            , _scanned(0)
+            , _maxLine(maxLine)
+        { }
+
+        LineSocket(const LineSocket&) = delete;
+        LineSocket& operator=(const LineSocket&) = delete;
+
+        LineSocket(LineSocket&& o)
+            : _fd(o._fd)
+            , _buffer(std::move(o._buffer))
+            , _start(o._start)
+            , _scanned(o._scanned)
+            , _maxLine(o._maxLine)
+        {
+            o._fd = -1;
+        }
+
+        ~LineSocket() {
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+        }
+
+        int fd() const {
+            return _fd;
+        }
+
+        // Reads the next line without its newline, false at end of stream.
+        // Throws once a line runs past the longest allowed, so a peer which
+        // never sends a newline can't take all our memory.
+        bool ReadLine(std::string& line) {
+            for (;;) {
+                // Only the bytes which arrived since the last look
+                const auto nl = _buffer.find('\n', _scanned);
+                if (nl != std::string::npos) {
+                    line.assign(_buffer, _start, nl - _start);
+                    _start = nl + 1;
+                    _scanned = _start;
+                    if (_start > _buffer.size() / 2) {
+                        _buffer.erase(0, _start);
+                        _start = 0;
+                        _scanned = 0;
+                    }
+                    return true;
+                }
+                _scanned = _buffer.size();
+                if (_buffer.size() - _start > _maxLine) {
+                    throw std::runtime_error("Line longer than " + std::to_string(_maxLine) + " bytes");
+                }
+
+                char chunk[64 * 1024];
+                const auto n = ::read(_fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    // Hand back anything left without a trailing newline
+                    if (_start < _buffer.size()) {
+                        line.assign(_buffer, _start, std::string::npos);
+                        _buffer.clear();
+                        _start = 0;
+                        _scanned = 0;
+                        return true;
+                    }
+                    return false;
+                }
+                _buffer.append(chunk, n);
+            }
+        }
+
+        // Writes everything, false if the peer has gone away
+        bool Write(std::string_view data) {
+            while (!data.empty()) {
+                const auto n = ::send(_fd, data.data(), data.size(), MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                data.remove_prefix(n);
+            }
+            return true;
+        }
+
+        void ShutdownWrite() {
+            ::shutdown(_fd, SHUT_WR);
+        }
+
+        static LineSocket Connect(const std::string& path) {
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) {
+                throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+            }
+            LineSocket s(fd);
+            const auto addr = Address(path);
+            if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+                throw std::runtime_error("connect " + path + ": " + std::strerror(errno));
+            }
+            return s;
+        }
+
+        // Binds and listens on path, replacing any stale socket file
+        static int Listen(const std::string& path, int backlog = 128) {
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) {
+                throw std::runtime_error(std::string("socket: ") + std::strerror(errno));
+            }
+            ::unlink(path.c_str());
+            const auto addr = Address(path);
+            if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                ::listen(fd, backlog) != 0) {
+                const auto err = errno;
+                ::close(fd);
+                throw std::runtime_error("listen " + path + ": " + std::strerror(err));
+            }
+            return fd;
+        }
+
+    private:
+        static sockaddr_un Address(const std::string& path) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(addr.sun_path)) {
+                throw std::runtime_error("Socket path too long: " + path);
+            }
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            return addr;
+        }
+
+        int _fd;
+        std::string _buffer;
+        size_t _start;
+        // Where the search for the next newline picks up
+        size_t _scanned;
+        size_t _maxLine;
+    };
+}
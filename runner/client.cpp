@@ -0,0 +1,55 @@
+#include "Protocol.h"
+#include "Socket.h"
+
+#include <iostream>
+#include <thread>
+
+// RunnerClient <socket> [puzzle files...]
+//
+// Sends each puzzle to a running `Runner --daemon` and prints the response
+// lines. With no files, request lines are read from stdin. Requests are
+// pipelined; responses come back in the order they were sent.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket> [puzzle files...]" << std::endl;
+        return 64;
+    }
+
+    try {
+        std::vector<std::string> requests;
+        for (int i = 2; i < argc; i++) {
+            TrainTracks::LoadRequests(argv[i], requests);
+        }
+
+        auto socket = TrainTracks::LineSocket::Connect(argv[1]);
+
+        std::thread sender([&] {
+            if (argc > 2) {
+                for (const auto& r : requests) {
+                    if (!socket.Write(r) || !socket.Write("\n")) {
+                        break;
+                    }
+                }
+            } else {
+                std::string line;
+                while (std::getline(std::cin, line)) {
+                    if (!socket.Write(line) || !socket.Write("\n")) {
+                        break;
+                    }
+                }
+            }
+            socket.ShutdownWrite();
+        });
+
+        std::string response;
+        while (socket.ReadLine(response)) {
+            std::cout << response << '\n';
+        }
+        std::cout.flush();
+        sender.join();
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
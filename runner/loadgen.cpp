@@ -0,0 +1,187 @@
+#include "Protocol.h"
+#include "Socket.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+// RunnerLoadGen <socket> [-c connections] [-n requests] [-d depth] [--sweep] <puzzle files...>
+//
+// Replays the given puzzles against a running `Runner --daemon` from several
+// connections at once, each keeping up to `depth` requests in flight, and
+// reports latency percentiles and throughput. With --sweep the connection
+// count doubles from 1 up to -c and the best throughput is reported.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Run {
+        std::vector<double> latencies;
+        uint64_t errors = 0;
+        double seconds = 0;
+    };
+
+    void Connection(const std::string& path, const std::vector<std::string>& requests,
+        size_t count, size_t offset, size_t depth, Run& run, std::mutex& runMutex) {
+        auto socket = TrainTracks::LineSocket::Connect(path);
+
+        std::mutex mutex;
+        std::condition_variable window;
+        std::deque<Clock::time_point> sent;
+
+        std::thread sender([&] {
+            std::string line;
+            for (size_t i = 0; i < count; i++) {
+                line = requests[(offset + i) % requests.size()];
+                line.append(1, '\n');
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    window.wait(lock, [&] { return sent.size() < depth; });
+                    sent.push_back(Clock::now());
+                }
+                if (!socket.Write(line)) {
+                    break;
+                }
+            }
+            socket.ShutdownWrite();
+        });
+
+        std::vector<double> latencies;
+        latencies.reserve(count);
+        uint64_t errors = 0;
+        std::string response;
+        while (latencies.size() < count && socket.ReadLine(response)) {
+            const auto now = Clock::now();
+            Clock::time_point start;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                start = sent.front();
+                sent.pop_front();
+            }
+            window.notify_one();
+            latencies.push_back(std::chrono::duration<double, std::micro>(now - start).count());
+            if (response.find("\"status\":\"Error\"") != std::string::npos) {
+                errors++;
+            }
+        }
+        sender.join();
+
+        std::lock_guard<std::mutex> lock(runMutex);
+        run.latencies.insert(run.latencies.end(), latencies.begin(), latencies.end());
+        run.errors += errors + (count - latencies.size());
+    }
+
+    Run Measure(const std::string& path, const std::vector<std::string>& requests,
+        size_t connections, size_t perConnection, size_t depth) {
+        Run run;
+        std::mutex runMutex;
+        std::vector<std::thread> threads;
+
+        const auto start = Clock::now();
+        for (size_t c = 0; c < connections; c++) {
+            threads.emplace_back([&, c] {
+                try {
+                    Connection(path, requests, perConnection, c * perConnection, depth, run, runMutex);
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(runMutex);
+                    std::cerr << e.what() << std::endl;
+                    run.errors += perConnection;
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::sort(run.latencies.begin(), run.latencies.end());
+        return run;
+    }
+
+    double Percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        const auto i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    double Report(size_t connections, const Run& run) {
+        const auto rate = run.seconds > 0 ? run.latencies.size() / run.seconds : 0;
+        std::cout << std::setw(5) << connections
+                  << std::setw(10) << run.latencies.size()
+                  << std::setw(8) << run.errors
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(12) << rate
+                  << std::setw(10) << Percentile(run.latencies, 0.50)
+                  << std::setw(10) << Percentile(run.latencies, 0.90)
+                  << std::setw(10) << Percentile(run.latencies, 0.99)
+                  << std::setw(10) << (run.latencies.empty() ? 0 : run.latencies.back())
+                  << std::endl;
+        return rate;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t connections = 4;
+    size_t perConnection = 1000;
+    size_t depth = 1;
+    bool sweep = false;
+    std::vector<std::string> files;
+
+    bool valid = true;
+    try {
+        for (int i = 2; i < argc; i++) {
+            const std::string arg = argv[i];
+            if ((arg == "-c" || arg == "-n" || arg == "-d") && i + 1 < argc) {
+                const size_t value = std::max(1ul, std::stoul(argv[++i]));
+                (arg == "-c" ? connections : arg == "-n" ? perConnection : depth) = value;
+            } else if (arg == "--sweep") {
+                sweep = true;
+            } else {
+                files.push_back(arg);
+            }
+        }
+    } catch (const std::exception&) {
+        valid = false;
+    }
+    if (!valid || argc < 3 || files.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <socket> [-c connections] [-n requests] [-d depth] [--sweep] <puzzle files...>" << std::endl;
+        return 64;
+    }
+
+    try {
+        std::vector<std::string> requests;
+        for (const auto& f : files) {
+            TrainTracks::LoadRequests(f, requests);
+        }
+        if (requests.empty()) {
+            throw std::runtime_error("No requests to send");
+        }
+
+        std::cout << std::setw(5) << "conn" << std::setw(10) << "requests" << std::setw(8) << "errors"
+                  << std::setw(12) << "req/s" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+                  << std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::endl;
+
+        double best = 0;
+        size_t bestConnections = connections;
+        for (size_t c = sweep ? 1 : connections; c <= connections; c *= 2) {
+            const auto rate = Report(c, Measure(argv[1], requests, c, perConnection, depth));
+            if (rate > best) {
+                best = rate;
+                bestConnections = c;
+            }
+        }
+        if (sweep) {
+            std::cout << "Max " << std::fixed << std::setprecision(0) << best
+                      << " req/s with " << bestConnections << " connections" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
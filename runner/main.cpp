@@ -1,80 +1,814 @@
 #include <iostream>
+#include "Coordinator.h"
 #include "Puzzle.h"
+#include "FrontierSolver.h"
 #include "PathSolver.h"
+#include "PortfolioSolver.h"
+#include "RestartSolver.h"
+#include "SegmentSolver.h"
+#include "Shard.h"
+#include "SolverPool.h"
 #include "Utils.h"
+#include "Checkpoint.h"
 #include "Grid.h"
-#include "ConsoleReporter.h"
+#include "LiveRenderer.h"
+#include "Pipeline.h"
+#include "Daemon.h"
+#include "Profiler.h"
+#include "Protocol.h"
+#include "SearchRecorder.h"
+#include "Trace.h"
 
-int main(int argc, char** argv) {
-    //const auto puzzle = TrainTracks::Puzzle::loadFromFile(argv[1]);
-    
-    // Arrange: create puzzle from JSON
-    TrainTracks::Puzzle puzzle;
-    puzzle.gridWidth  = 12;
-    puzzle.gridHeight = 12;
-
-    puzzle.data.rowConstraints = {
-        5, 1, 2, 3, 9, 4, 6, 7, 7, 10, 7, 4
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <climits>
+#include <cstdlib>
+#include <unistd.h>
+
+// Runner [options] [puzzle files...]
+// Runner --daemon <socket> [workers]
+//
+// Solves each puzzle and prints the result. Files ending .json hold one
+// puzzle, .jsonl one per line, anything else is the ROWS/COLS/FIXED text
+// format; with no files (or "-") puzzles are read from stdin. Nothing is
+// interactive, so it can be timed and driven from scripts. --watch draws a
+// single puzzle's search in the terminal while it runs. --trace writes the
+// DEBUG_LOG trace points to a file for TraceDump (debug builds, or release
+// builds configured with TRAINTRACKS_TRACE). --record writes every search
+// decision for a single puzzle to a file for SearchReplay. --profile times
+// loading, placeObviousPieces, search and verification per puzzle, prints a
+// summary and writes a Chrome trace_event file. --stream solves JSON lines
+// as they are read through a staged pipeline, writing a JSON result line for
+// each as soon as it (and, unless --unordered, every line before it) is done;
+// --stages sets the parse,presolve,search,serialise thread counts.
+// --shards N splits a single puzzle's path search into shards (at
+// --shard-depth cells along the path, or deep enough for several per
+// process) written under --shard-dir, and searches them in N worker
+// processes (Runner --solve-shard <file>), stopping them all once one finds
+// the solution. --checkpoint saves a single puzzle's path search to a file
+// every --checkpoint-every seconds and when it is stopped, and --resume
+// carries on from one.
+//
+// Exit status is the worst outcome over all puzzles: 0 all solved,
+// 1 unsolvable, 2 timed out or cancelled, 3 unreadable or invalid puzzle,
+// 64 bad usage.
+
+namespace {
+    TrainTracks::Daemon* running = nullptr;
+    std::atomic<bool> cancelled(false);
+
+    enum ExitCode {
+        Solved = 0,
+        Unsolvable = 1,
+        TimedOut = 2,
+        BadPuzzle = 3,
+        Usage = 64,
     };
-    puzzle.data.colConstraints = {
-        5, 10, 5, 4, 5, 8, 6, 6, 4, 3, 4, 5
+
+    void stopDaemon(int) {
+        if (running) {
+            running->Stop();
+        }
+    }
+
+    void cancelSolves(int) {
+        cancelled = true;
+    }
+
+    // No SA_RESTART, so blocking calls return and we can shut down
+    void onInterrupt(void (*handler)(int)) {
+        struct sigaction sa{};
+        sa.sa_handler = handler;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGINT, &sa, nullptr);
+        sigaction(SIGTERM, &sa, nullptr);
+    }
+
+    // Runner --daemon <socket> [workers]
+    int runDaemon(const std::string& path, size_t workers) {
+        TrainTracks::SolverPoolOptions options;
+        if (workers > 0) {
+            options.workers = workers;
+        }
+        try {
+            TrainTracks::Daemon d(path, options);
+            running = &d;
+            onInterrupt(stopDaemon);
+
+            std::cerr << "Listening on " << path << " with " << d.Pool().Workers() << " workers" << std::endl;
+            d.Run();
+            running = nullptr;
+
+            const auto stats = d.Pool().Stats();
+            std::cerr << "Solved " << stats.completed << " puzzles" << std::endl;
+        } catch (const std::exception& e) {
+            running = nullptr;
+            std::cerr << e.what() << std::endl;
+            return ExitCode::Usage;
+        }
+        return 0;
+    }
+
+    struct Options {
+        std::string solver = "path";
+        size_t threads = 0;
+        int deadlineMs = 0;
+        uint64_t maxSteps = 0;
+        bool quiet = false;
+        bool json = false;
+        bool watch = false;
+        bool stream = false;
+        bool unordered = false;
+        std::vector<size_t> stages;
+        size_t shards = 0;
+        int shardDepth = 0;
+        std::string shardDir;
+        std::string solveShard;
+        std::string checkpoint;
+        int checkpointSeconds = 60;
+        std::string resume;
+        std::string trace;
+        std::string record;
+        std::string profile;
+        std::vector<std::string> files;
+    };
+
+    void usage(const char* name) {
+        std::cerr << "Usage: " << name << " [--solver path|segment|restart|portfolio|frontier] [--threads N]"
+                  << " [--deadline ms] [--max-steps N] [--quiet] [--json] [--watch]"
+                  << " [--stream [--unordered] [--stages P,R,S,W]]"
+                  << " [--shards N [--shard-depth D] [--shard-dir dir]]"
+                  << " [--checkpoint file [--checkpoint-every s]] [--resume file]"
+                  << " [--trace file] [--record file]"
+                  << " [--profile file] [puzzle files...]" << std::endl
+                  << "       " << name << " --daemon <socket> [workers]" << std::endl
+                  << "       " << name << " --solve-shard <file>" << std::endl;
+    }
+
+    bool parse(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--solver" && hasValue) {
+                options.solver = argv[++i];
+                if (options.solver != "path" && options.solver != "segment" &&
+                    options.solver != "restart" && options.solver != "portfolio" &&
+                    options.solver != "frontier") {
+                    return false;
+                }
+            } else if (arg == "--threads" && hasValue) {
+                options.threads = std::stoul(argv[++i]);
+            } else if (arg == "--deadline" && hasValue) {
+                options.deadlineMs = std::stoi(argv[++i]);
+            } else if (arg == "--max-steps" && hasValue) {
+                options.maxSteps = std::stoull(argv[++i]);
+            } else if (arg == "-q" || arg == "--quiet") {
+                options.quiet = true;
+            } else if (arg == "--json") {
+                options.json = true;
+            } else if (arg == "--watch") {
+                options.watch = true;
+            } else if (arg == "--stream") {
+                options.stream = true;
+            } else if (arg == "--unordered") {
+                options.unordered = true;
+            } else if (arg == "--stages" && hasValue) {
+                TrainTracks::parse_as_integers(std::string(argv[++i]), ',', [&options](int n) {
+                    options.stages.push_back(std::max(n, 0));
+                });
+                if (options.stages.size() != 4) {
+                    return false;
+                }
+            } else if (arg == "--shards" && hasValue) {
+                options.shards = std::stoul(argv[++i]);
+            } else if (arg == "--shard-depth" && hasValue) {
+                options.shardDepth = std::stoi(argv[++i]);
+            } else if (arg == "--shard-dir" && hasValue) {
+                options.shardDir = argv[++i];
+            } else if (arg == "--solve-shard" && hasValue) {
+                options.solveShard = argv[++i];
+            } else if (arg == "--checkpoint" && hasValue) {
+                options.checkpoint = argv[++i];
+            } else if (arg == "--checkpoint-every" && hasValue) {
+                options.checkpointSeconds = std::stoi(argv[++i]);
+            } else if (arg == "--resume" && hasValue) {
+                options.resume = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                options.trace = argv[++i];
+            } else if (arg == "--record" && hasValue) {
+                options.record = argv[++i];
+            } else if (arg == "--profile" && hasValue) {
+                options.profile = argv[++i];
+            } else if (arg == "-" || !TrainTracks::startsWith(arg, "-")) {
+                options.files.push_back(arg);
+            } else {
+                return false;
+            }
+        }
+        if (options.files.empty()) {
+            options.files.push_back("-");
+        }
+        return true;
+    }
+
+    TrainTracks::SolverFactory factory(const std::string& solver) {
+        if (solver == "segment") {
+            return [] { return std::make_unique<TrainTracks::SegmentSolver>(); };
+        }
+        if (solver == "restart") {
+            return [] { return std::make_unique<TrainTracks::RestartSolver>(); };
+        }
+        if (solver == "portfolio") {
+            return [] { return std::make_unique<TrainTracks::PortfolioSolver>(); };
+        }
+        if (solver == "frontier") {
+            return [] { return std::make_unique<TrainTracks::FrontierSolver>(); };
+        }
+        return [] { return std::make_unique<TrainTracks::PathSolver>(); };
+    }
+
+    std::string jsonString(const std::string& s) {
+        std::string out(1, '"');
+        for (const auto c : s) {
+            if (c == '"' || c == '\\') {
+                out.append(1, '\\');
+            }
+            out.append(1, c);
+        }
+        return out.append(1, '"');
+    }
+
+    // Lays a solution's pieces over the puzzle's grid and draws it
+    void printSolution(TrainTracks::Grid& grid, const std::vector<TrainTracks::Piece>& solution) {
+        for (int y = 0; y < grid.height(); y++) {
+            for (int x = 0; x < grid.width(); x++) {
+                const TrainTracks::Point pt{x, y};
+                const auto piece = solution[pt.project(grid.width())];
+                if (grid.isEmpty(pt) && piece != TrainTracks::Piece::Empty) {
+                    grid.place(pt, piece);
+                }
+            }
+        }
+        grid.bold(isatty(STDOUT_FILENO));
+        grid.displayConstraints(true);
+        std::cout << grid << std::endl;
+    }
+
+    int exitCode(TrainTracks::SolveStatus status) {
+        return status == TrainTracks::SolveStatus::Solved ? ExitCode::Solved :
+            status == TrainTracks::SolveStatus::Unsolvable ? ExitCode::Unsolvable : ExitCode::TimedOut;
+    }
+
+    struct Job {
+        // Where the puzzle came from, and its JSON id for the output: the
+        // request's own, or the name
+        std::string name;
+        std::string id;
+        std::string request;
+        std::optional<std::future<TrainTracks::SolveResult>> result;
+        std::string error;
     };
 
-    // startingGrid values map directly to Piece enum underlying ints:
-    // 0=Empty, 3=Horizontal, 4=Vertical, 5=CornerNE, 6=CornerSE, 7=CornerSW, 8=CornerNW
-    std::vector<int> flat = {
-        0, 0, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 8,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 4, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0,
-        6, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5,
-        0, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0
+    // Runner --watch|--record <file> <puzzle>: solves one puzzle on this
+    // thread, drawing it as it goes and/or recording every decision.
+    // --checkpoint/--resume <file> do the same for a path search that can
+    // be stopped and picked up again.
+    int runSingle(const Options& options) {
+        const char* flag = options.watch ? "--watch" : !options.record.empty() ? "--record" :
+            !options.checkpoint.empty() ? "--checkpoint" : "--resume";
+        if (options.files.size() != 1) {
+            std::cerr << flag << " takes a single puzzle" << std::endl;
+            return ExitCode::Usage;
+        }
+        const auto& file = options.files.front();
+        std::vector<std::string> requests;
+        std::optional<TrainTracks::Grid> grid;
+        try {
+            if (file == "-") {
+                TrainTracks::LoadRequests(std::cin, requests);
+            } else {
+                TrainTracks::LoadRequests(file, requests);
+            }
+            if (requests.size() != 1) {
+                throw std::runtime_error(std::string(flag) + " takes a single puzzle");
+            }
+            grid.emplace(TrainTracks::Puzzle::fromJson(requests.front()));
+        } catch (const std::exception& e) {
+            std::cerr << file << ": " << e.what() << std::endl;
+            return ExitCode::BadPuzzle;
+        }
+
+        std::ofstream recording;
+        std::optional<TrainTracks::SearchLog> log;
+        if (!options.record.empty()) {
+            recording.open(options.record, std::ios::binary);
+            if (!recording) {
+                std::cerr << "Unable to open " << options.record << std::endl;
+                return ExitCode::Usage;
+            }
+            log.emplace(recording, *grid);
+        }
+
+        const auto checkpointing = !options.checkpoint.empty() || !options.resume.empty();
+        if (checkpointing && options.solver != "path") {
+            std::cerr << flag << " needs --solver path" << std::endl;
+            return ExitCode::Usage;
+        }
+        std::optional<TrainTracks::PathCheckpoint> resume;
+        if (!options.resume.empty()) {
+            try {
+                resume = TrainTracks::CheckpointFile::Load(options.resume);
+            } catch (const std::exception& e) {
+                std::cerr << options.resume << ": " << e.what() << std::endl;
+                return ExitCode::BadPuzzle;
+            }
+        }
+
+        auto solver = factory(options.solver)();
+        auto* path = checkpointing ? static_cast<TrainTracks::PathSolver*>(solver.get()) : nullptr;
+        std::optional<TrainTracks::CheckpointFile> checkpoints;
+        if (!options.checkpoint.empty()) {
+            checkpoints.emplace(options.checkpoint);
+            path->Checkpoints([&checkpoints](const TrainTracks::PathCheckpoint& c) { checkpoints->Save(c); },
+                std::chrono::seconds(options.checkpointSeconds));
+        }
+        TrainTracks::SolveOptions solve;
+        solve.maxSteps = options.maxSteps;
+        solve.cancel = &cancelled;
+        solve.timeout = std::chrono::milliseconds(options.deadlineMs);
+        onInterrupt(cancelSolves);
+
+        std::optional<TrainTracks::LiveRenderer> renderer;
+        if (options.watch) {
+            renderer.emplace(*grid);
+            solver->Reporter(&*renderer);
+        }
+        if (log) {
+            solver->Recorder(&*log);
+        }
+        TrainTracks::SolveResult r;
+        try {
+            r = resume ? path->Resume(*grid, *resume, solve) : solver->Solve(*grid, solve);
+        } catch (const std::exception& e) {
+            std::cerr << (resume ? options.resume : file) << ": " << e.what() << std::endl;
+            return ExitCode::BadPuzzle;
+        }
+        if (renderer) {
+            renderer->Stop();
+        }
+
+        std::cout << file << ": " << r.status << " in " << r.steps << " steps, "
+                  << std::chrono::duration<double, std::milli>(r.elapsed).count() << " ms" << std::endl;
+        if (log) {
+            log->Flush();
+            std::cerr << "Recorded " << log->Events() << " events to " << options.record << std::endl;
+        }
+        if (checkpoints) {
+            if (!checkpoints->Error().empty()) {
+                std::cerr << checkpoints->Error() << std::endl;
+            }
+            std::cerr << "Saved " << checkpoints->Saved() << " checkpoints (" << checkpoints->Bytes()
+                      << " bytes) to " << options.checkpoint << std::endl;
+        }
+        return exitCode(r.status);
+    }
+
+    // Runner --stream [file]: JSON lines in, JSON result lines out, solved
+    // through a Pipeline so the input needn't fit in memory
+    int runStream(const Options& options) {
+        if (options.files.size() != 1) {
+            std::cerr << "--stream takes a single input" << std::endl;
+            return ExitCode::Usage;
+        }
+        const auto& file = options.files.front();
+        std::ifstream ifs;
+        if (file != "-") {
+            ifs.open(file);
+            if (!ifs) {
+                std::cerr << "Unable to open " << file << std::endl;
+                return ExitCode::BadPuzzle;
+            }
+        }
+        std::istream& in = file == "-" ? std::cin : ifs;
+
+        TrainTracks::PipelineOptions pipelineOptions;
+        if (options.threads > 0) {
+            pipelineOptions.searchers = options.threads;
+        }
+        if (!options.stages.empty()) {
+            pipelineOptions.parsers = options.stages[0];
+            pipelineOptions.presolvers = options.stages[1];
+            pipelineOptions.searchers = options.stages[2];
+            pipelineOptions.serialisers = options.stages[3];
+        }
+        pipelineOptions.ordered = !options.unordered;
+        pipelineOptions.solve.maxSteps = options.maxSteps;
+        pipelineOptions.solve.cancel = &cancelled;
+        pipelineOptions.solve.timeout = std::chrono::milliseconds(options.deadlineMs);
+
+        const bool quiet = options.quiet;
+        std::optional<TrainTracks::Pipeline> pipeline;
+        try {
+            pipeline.emplace([quiet](const TrainTracks::PipelineRecord& r) {
+                if (quiet) {
+                    return std::string();
+                }
+                return r.error.empty() ? TrainTracks::FormatResult(r.id, r.result) :
+                    TrainTracks::FormatError(r.id, r.error);
+            }, pipelineOptions, factory(options.solver));
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return ExitCode::Usage;
+        }
+        onInterrupt(cancelSolves);
+        const auto stats = pipeline->Run(in, std::cout);
+
+        const auto solved = stats.counts[static_cast<int>(TrainTracks::SolveStatus::Solved)];
+        const auto unsolvable = stats.counts[static_cast<int>(TrainTracks::SolveStatus::Unsolvable)];
+        const auto timedOut = stats.counts[static_cast<int>(TrainTracks::SolveStatus::TimedOut)] +
+            stats.counts[static_cast<int>(TrainTracks::SolveStatus::Cancelled)];
+        std::cerr << stats.records << " puzzles: " << solved << " solved, " << unsolvable << " unsolvable, "
+                  << timedOut << " timed out, " << stats.errors << " errors, " << stats.steps << " steps in "
+                  << std::chrono::duration<double, std::milli>(stats.elapsed).count() << " ms" << std::endl;
+        return stats.errors > 0 ? ExitCode::BadPuzzle :
+            timedOut > 0 ? ExitCode::TimedOut :
+            unsolvable > 0 ? ExitCode::Unsolvable : ExitCode::Solved;
+    }
+
+    // Runner --solve-shard <file>: searches each shard in the file (or
+    // stdin) in turn, printing a result line for each, until one solves
+    int runShardWorker(const Options& options) {
+        std::ifstream ifs;
+        if (options.solveShard != "-") {
+            ifs.open(options.solveShard);
+            if (!ifs) {
+                std::cerr << "Unable to open " << options.solveShard << std::endl;
+                return ExitCode::BadPuzzle;
+            }
+        }
+        std::istream& in = options.solveShard == "-" ? std::cin : ifs;
+
+        TrainTracks::SolveOptions solve;
+        solve.maxSteps = options.maxSteps;
+        solve.cancel = &cancelled;
+        solve.timeout = std::chrono::milliseconds(options.deadlineMs);
+        onInterrupt(cancelSolves);
+
+        auto status = TrainTracks::SolveStatus::Unsolvable;
+        std::string line;
+        while (status == TrainTracks::SolveStatus::Unsolvable && std::getline(in, line)) {
+            if (TrainTracks::trim(line).empty()) {
+                continue;
+            }
+            const auto id = TrainTracks::RequestId(line);
+            try {
+                const auto shard = TrainTracks::Shard::fromJson(line);
+                const auto r = TrainTracks::SolveShard(shard, solve);
+                std::cout << TrainTracks::FormatResult(std::to_string(shard.index), r) << std::flush;
+                status = r.status;
+            } catch (const std::exception& e) {
+                std::cout << TrainTracks::FormatError(id, e.what()) << std::flush;
+                return ExitCode::BadPuzzle;
+            }
+        }
+        return exitCode(status);
+    }
+
+    // Runner --shards N <puzzle>: splits the search, writes a shard file
+    // per worker and runs them, merging what they report
+    // A temporary shard directory, removed with the files written to it
+    // however runShards returns
+    class ShardDir {
+    public:
+        ShardDir() = default;
+        ShardDir(const ShardDir&) = delete;
+        ShardDir& operator=(const ShardDir&) = delete;
+
+        ~ShardDir() {
+            if (_path.empty()) {
+                return;
+            }
+            for (const auto& f : _files) {
+                ::unlink(f.c_str());
+            }
+            ::rmdir(_path.c_str());
+        }
+
+        bool Create() {
+            char tmp[] = "/tmp/traintracks-shards-XXXXXX";
+            if (!::mkdtemp(tmp)) {
+                return false;
+            }
+            _path = tmp;
+            return true;
+        }
+
+        const std::string& Path() const {
+            return _path;
+        }
+
+        void Add(const std::string& file) {
+            _files.push_back(file);
+        }
+
+    private:
+        std::string _path;
+        std::vector<std::string> _files;
     };
-    // convert to Pieces
-    puzzle.data.startingGrid.reserve(flat.size());
-    for (int v : flat) {
-        puzzle.data.startingGrid.push_back(static_cast<TrainTracks::Piece>(v));
-    }
-    
-    auto grid = TrainTracks::Grid(puzzle);
-    TrainTracks::ConsoleReporter r(grid, 10000000);
-
-    grid.displayConstraints(true);
-
-    std::cout << TrainTracks::cls;
-    std::cout << "Initial grid:" << std::endl;
-    std::cout << grid << std::endl;
-    std::cout << "Entry: " << grid.entry() << std::endl;
-    std::cout << "Exit: " << grid.exit() << std::endl;
-    std::cout << "Total pieces: " << grid.target() << std::endl;
-    std::cout << "Placed pieces: " << grid.placed() << std::endl;
-
-    std::cout << "Press Enter to continue..." << std::endl;
-    std::cin.get();
-    std::cout << TrainTracks::cls;
-
-    grid.displayConstraints(false);
-
-    TrainTracks::PathSolver ps;
-    ps.Reporter(&r);
-
-    bool solved;
-    double elapsed;
-    {
-        TrainTracks::AutoTimer t("Solving");
-        solved = ps.Solve(grid);
-        elapsed = t.elapsed();
-    }
-    std::cout << TrainTracks::cls;
-    std::cout << grid << std::endl;
-    std::cout << (solved ? "Solved" : "Unable to solve") << std::endl;
-    std::cout << "Total steps: " << ps.Steps() << std::endl;
-    std::cout << "Elapsed time: " << elapsed << " seconds" << std::endl;
-    return 0;
-}
\ No newline at end of file
+
+    int runShards(const Options& options) {
+        if (options.files.size() != 1) {
+            std::cerr << "--shards takes a single puzzle" << std::endl;
+            return ExitCode::Usage;
+        }
+        const auto& file = options.files.front();
+        const auto start = TrainTracks::SolveClock::now();
+        std::optional<TrainTracks::Grid> grid;
+        try {
+            std::vector<std::string> requests;
+            if (file == "-") {
+                TrainTracks::LoadRequests(std::cin, requests);
+            } else {
+                TrainTracks::LoadRequests(file, requests);
+            }
+            if (requests.size() != 1) {
+                throw std::runtime_error("--shards takes a single puzzle");
+            }
+            grid.emplace(TrainTracks::Puzzle::fromJson(requests.front()));
+        } catch (const std::exception& e) {
+            std::cerr << file << ": " << e.what() << std::endl;
+            return ExitCode::BadPuzzle;
+        }
+
+        TrainTracks::SolveOptions solve;
+        solve.cancel = &cancelled;
+        if (options.deadlineMs > 0) {
+            solve.deadline = start + std::chrono::milliseconds(options.deadlineMs);
+        }
+        onInterrupt(cancelSolves);
+
+        // Deep enough that a worker finishing its shards early leaves
+        // little to wait for on the others
+        constexpr size_t ShardsPerProcess = 8;
+        int depth = std::max(options.shardDepth, 1);
+        TrainTracks::ShardSplit split;
+        for (;;) {
+            split = TrainTracks::SplitIntoShards(*grid, depth, TrainTracks::PathSolverOptions(), solve);
+            if (options.shardDepth > 0 || split.shards.empty() ||
+                split.shards.size() >= ShardsPerProcess * options.shards ||
+                depth >= static_cast<int>(grid->cells())) {
+                break;
+            }
+            depth++;
+        }
+
+        auto r = split.result;
+        size_t processes = 0;
+        if (!split.shards.empty()) {
+            std::string dir = options.shardDir;
+            ShardDir temporary;
+            if (dir.empty()) {
+                if (!temporary.Create()) {
+                    std::cerr << "Unable to create a shard directory" << std::endl;
+                    return ExitCode::Usage;
+                }
+                dir = temporary.Path();
+            }
+
+            // Dealt out in turn, so each worker has early and late shards
+            processes = std::min(options.shards, split.shards.size());
+            std::vector<std::string> files;
+            std::vector<std::ofstream> outs;
+            for (size_t i = 0; i < processes; i++) {
+                files.push_back(dir + "/shard-" + std::to_string(i) + ".jsonl");
+                temporary.Add(files.back());
+                outs.emplace_back(files.back());
+                if (!outs.back()) {
+                    std::cerr << "Unable to open " << files.back() << std::endl;
+                    return ExitCode::Usage;
+                }
+            }
+            for (const auto& shard : split.shards) {
+                outs[shard.index % processes] << shard.toJson() << '\n';
+            }
+            outs.clear();
+
+            char exe[PATH_MAX];
+            const auto n = ::readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+            if (n <= 0) {
+                std::cerr << "Unable to find the Runner executable" << std::endl;
+                return ExitCode::Usage;
+            }
+            exe[n] = '\0';
+
+            try {
+                TrainTracks::Coordinator coordinator(exe, files, split.shards.size());
+                const auto merged = coordinator.Run(solve.deadline, &cancelled);
+                r.status = merged.status;
+                r.steps += merged.steps;
+                r.solution = merged.solution;
+                r.peakBytes = std::max(r.peakBytes, merged.peakBytes);
+            } catch (const std::exception& e) {
+                std::cerr << file << ": " << e.what() << std::endl;
+                return ExitCode::BadPuzzle;
+            }
+        }
+        r.elapsed = TrainTracks::SolveClock::now() - start;
+
+        if (options.json) {
+            std::cout << TrainTracks::FormatResult(jsonString(file), r);
+        } else {
+            std::cout << file << ": " << r.status << " in " << r.steps << " steps, "
+                      << std::chrono::duration<double, std::milli>(r.elapsed).count() << " ms ("
+                      << split.shards.size() << " shards at depth " << depth << " over "
+                      << processes << " processes)" << std::endl;
+            if (r.solved() && !options.quiet) {
+                printSolution(*grid, r.solution);
+            }
+        }
+        return exitCode(r.status);
+    }
+
+    int runSolver(const Options& options) {
+        std::vector<Job> jobs;
+        int worst = ExitCode::Solved;
+        for (const auto& file : options.files) {
+            std::vector<std::string> requests;
+            try {
+                if (file == "-") {
+                    TrainTracks::LoadRequests(std::cin, requests);
+                } else {
+                    TrainTracks::LoadRequests(file, requests);
+                }
+            } catch (const std::exception& e) {
+                std::cerr << file << ": " << e.what() << std::endl;
+                worst = std::max<int>(worst, ExitCode::BadPuzzle);
+                continue;
+            }
+            for (size_t i = 0; i < requests.size(); i++) {
+                Job job;
+                job.name = requests.size() == 1 ? file : file + ":" + std::to_string(i + 1);
+                job.id = TrainTracks::RequestId(requests[i]);
+                if (job.id == "null") {
+                    job.id = jsonString(job.name);
+                }
+                job.request = std::move(requests[i]);
+                jobs.push_back(std::move(job));
+            }
+        }
+
+        TrainTracks::SolverPoolOptions poolOptions;
+        if (options.threads > 0) {
+            poolOptions.workers = options.threads;
+        }
+        poolOptions.workers = std::max<size_t>(1, std::min(poolOptions.workers, jobs.size()));
+        TrainTracks::SolverPool pool(poolOptions, factory(options.solver));
+        onInterrupt(cancelSolves);
+
+        const auto start = TrainTracks::SolveClock::now();
+        for (auto& job : jobs) {
+            TrainTracks::SolveOptions solve;
+            solve.maxSteps = options.maxSteps;
+            solve.cancel = &cancelled;
+            solve.timeout = std::chrono::milliseconds(options.deadlineMs);
+            try {
+                job.result = pool.Submit(TrainTracks::Puzzle::fromJson(job.request), solve);
+            } catch (const std::exception& e) {
+                job.error = e.what();
+            }
+        }
+
+        uint64_t counts[4] = {};
+        uint64_t errors = 0;
+        uint64_t steps = 0;
+        std::optional<TrainTracks::Grid> grid;
+        for (auto& job : jobs) {
+            TrainTracks::SolveResult r;
+            if (job.result) {
+                try {
+                    r = job.result->get();
+                } catch (const std::exception& e) {
+                    job.error = e.what();
+                }
+            }
+            if (!job.error.empty()) {
+                errors++;
+                worst = std::max<int>(worst, ExitCode::BadPuzzle);
+                if (options.json && !options.quiet) {
+                    std::cout << TrainTracks::FormatError(job.id, job.error);
+                } else {
+                    std::cerr << job.name << ": " << job.error << std::endl;
+                }
+                continue;
+            }
+
+            counts[static_cast<int>(r.status)]++;
+            steps += r.steps;
+            worst = std::max<int>(worst, exitCode(r.status));
+            if (options.quiet) {
+                continue;
+            }
+            if (options.json) {
+                std::cout << TrainTracks::FormatResult(job.id, r);
+                continue;
+            }
+
+            std::cout << job.name << ": " << r.status << " in " << r.steps << " steps, "
+                      << std::chrono::duration<double, std::milli>(r.elapsed).count() << " ms" << std::endl;
+            if (r.solved()) {
+                const auto puzzle = TrainTracks::Puzzle::fromJson(job.request);
+                if (grid) {
+                    grid->reset(puzzle);
+                } else {
+                    grid.emplace(puzzle);
+                }
+                printSolution(*grid, r.solution);
+            }
+        }
+        const auto elapsed = TrainTracks::SolveClock::now() - start;
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+        const auto solved = counts[static_cast<int>(TrainTracks::SolveStatus::Solved)];
+        const auto unsolvable = counts[static_cast<int>(TrainTracks::SolveStatus::Unsolvable)];
+        const auto timedOut = counts[static_cast<int>(TrainTracks::SolveStatus::TimedOut)];
+        const auto cancels = counts[static_cast<int>(TrainTracks::SolveStatus::Cancelled)];
+        if (options.json) {
+            std::cout << "{\"summary\":{\"puzzles\":" << jobs.size() << ",\"solved\":" << solved
+                      << ",\"unsolvable\":" << unsolvable << ",\"timed_out\":" << timedOut
+                      << ",\"cancelled\":" << cancels << ",\"errors\":" << errors
+                      << ",\"steps\":" << steps << ",\"elapsed_us\":" << micros
+                      << ",\"threads\":" << pool.Workers() << ",\"solver\":\"" << options.solver << "\"}}" << std::endl;
+        } else {
+            std::cout << jobs.size() << " puzzles: " << solved << " solved, " << unsolvable << " unsolvable, "
+                      << timedOut + cancels << " timed out, " << errors << " errors, " << steps << " steps in "
+                      << micros / 1000.0 << " ms" << std::endl;
+        }
+        return worst;
+    }
+}
+
+int main(int argc, char** argv) {
+    const auto daemon = argc >= 2 && std::string(argv[1]) == "--daemon";
+    size_t daemonWorkers = 0;
+    Options options;
+    try {
+        if (daemon ? argc < 3 || argc > 4 : !parse(argc, argv, options)) {
+            usage(argv[0]);
+            return ExitCode::Usage;
+        }
+        if (daemon && argc > 3) {
+            daemonWorkers = std::stoul(argv[3]);
+        }
+    } catch (const std::exception&) {
+        usage(argv[0]);
+        return ExitCode::Usage;
+    }
+    if (daemon) {
+        return runDaemon(argv[2], daemonWorkers);
+    }
+    if (!options.trace.empty()) {
+        try {
+            TrainTracks::Trace::Start(options.trace);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return ExitCode::Usage;
+        }
+    }
+    std::ofstream profile;
+    if (!options.profile.empty()) {
+        profile.open(options.profile);
+        if (!profile) {
+            std::cerr << "Unable to open " << options.profile << std::endl;
+            return ExitCode::Usage;
+        }
+        TrainTracks::Profiler::Enable();
+    }
+    const auto single = options.watch || !options.record.empty() || !options.checkpoint.empty() ||
+        !options.resume.empty();
+    int code;
+    if (single) {
+        code = runSingle(options);
+    } else if (!options.solveShard.empty()) {
+        code = runShardWorker(options);
+    } else if (options.shards > 0) {
+        code = runShards(options);
+    } else if (options.stream) {
+        code = runStream(options);
+    } else {
+        code = runSolver(options);
+    }
+    if (profile.is_open()) {
+        TrainTracks::Profiler::Enable(false);
+        TrainTracks::Profiler::WriteChromeTrace(profile);
+        TrainTracks::Profiler::Print(std::cerr);
+    }
+    if (!options.trace.empty()) {
+        const auto stats = TrainTracks::Trace::Stop();
+        std::cerr << "Traced " << stats.records << " records (" << stats.dropped << " dropped) to "
+                  << options.trace << std::endl;
+    }
+    return code;
+}
@@ -0,0 +1,383 @@
+#include "include/BatchSolver.h"
+
+#include <array>
+#include <utility>
+
+// The propagation kernel for BatchSolver. It is written once, as a template
+// over the word it works on: a uint64_t for one board, or where the
+// compiler has vector extensions four of them side by side, one board to a
+// lane. Every rule is the same and/or/shift sequence on each lane, so the
+// lanes run in lock-step until the last of them stops changing. The vector
+// version is built for AVX2 and for the baseline instruction set, and the
+// one the CPU supports is picked when the program loads.
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__clang__)
+// The helpers pass vectors by value, which an AVX2 caller does in
+// registers and a baseline one in memory, so they are always inlined into
+// the clone calling them, debug builds included, and never called across.
+// src/CMakeLists.txt turns off GCC's -Wpsabi note for this file.
+#define TRAINTRACKS_BITBOARD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define TRAINTRACKS_BITBOARD_CLONES
+#endif
+
+#if defined(__GNUC__)
+#define TRAINTRACKS_BITBOARD_INLINE inline __attribute__((always_inline))
+#else
+#define TRAINTRACKS_BITBOARD_INLINE inline
+#endif
+
+namespace TrainTracks
+{
+
+namespace {
+
+    constexpr uint64_t Ones = 0x0101010101010101ull;
+    constexpr uint64_t Highs = 0x8080808080808080ull;
+    // Enough for every board to settle, each round adds or cuts something
+    constexpr uint32_t MaxRounds = 512;
+
+#if defined(__GNUC__)
+    typedef uint64_t Lanes __attribute__((vector_size(32)));
+    constexpr size_t LaneCount = 4;
+
+    TRAINTRACKS_BITBOARD_INLINE bool Any(Lanes x) {
+        return (x[0] | x[1] | x[2] | x[3]) != 0;
+    }
+
+    TRAINTRACKS_BITBOARD_INLINE bool Lane(Lanes x, size_t i) {
+        return x[i] != 0;
+    }
+#endif
+
+    TRAINTRACKS_BITBOARD_INLINE bool Any(uint64_t x) {
+        return x != 0;
+    }
+
+    TRAINTRACKS_BITBOARD_INLINE bool Lane(uint64_t x, size_t) {
+        return x != 0;
+    }
+
+    // Track in each byte, which is at most 8
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE W BytePopcount(W x) {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        return (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    }
+
+    // 0xFF in each byte where a and b, both below 16, are equal
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE W ByteEqual(W a, W b) {
+        const W d = a ^ b;
+        W eq = ((d | (d >> 1) | (d >> 2) | (d >> 3)) & Ones) ^ Ones;
+        eq |= eq << 1;
+        eq |= eq << 2;
+        eq |= eq << 4;
+        return eq;
+    }
+
+    // The high bit of each byte where a > b, both below 16
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE W ByteGreater(W a, W b) {
+        return ((a | Highs) - (b + Ones)) & Highs;
+    }
+
+    // Swaps rows and columns, so the row rules also do the columns
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE W Transpose(W x) {
+        W t = (x ^ (x << 28)) & 0x0F0F0F0F00000000ull;
+        x ^= t ^ (t >> 28);
+        t = (x ^ (x << 14)) & 0x3333000033330000ull;
+        x ^= t ^ (t >> 14);
+        t = (x ^ (x << 7)) & 0x5500550055005500ull;
+        x ^= t ^ (t >> 7);
+        return x;
+    }
+
+    // Bit-sliced count of the five ways a cell can link, into whether
+    // there is exactly one, exactly two or more than two
+    template <typename W>
+    struct LinkCount {
+        W ones{};
+        W twos{};
+        W more{};
+
+        TRAINTRACKS_BITBOARD_INLINE LinkCount(W off, W east, W south) {
+            for (const W x : { off, east, east << 1, south, south << 8 }) {
+                const W carry = ones & x;
+                ones ^= x;
+                more |= twos & carry;
+                twos ^= carry;
+            }
+            more |= twos & ones;
+        }
+
+        TRAINTRACKS_BITBOARD_INLINE W two() const {
+            return twos & ~ones & ~more;
+        }
+
+        TRAINTRACKS_BITBOARD_INLINE W atLeastTwo() const {
+            return twos | more;
+        }
+    };
+
+    // A row (or, transposed, a column) with as much track as it needs has
+    // its open cells empty, and one with only as many cells not empty has
+    // them all track
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE void Lines(W& track, W& empty, W valid, W counts, W& bad) {
+        const W open = valid & ~track & ~empty;
+        const W placed = BytePopcount(track);
+        const W room = BytePopcount(valid & ~empty);
+        bad |= ByteGreater(placed, counts) | ByteGreater(counts, room);
+        empty |= open & ByteEqual(placed, counts);
+        track |= open & ByteEqual(room, counts);
+    }
+
+    template <typename W>
+    struct Board {
+        W valid, rows, cols, track, empty, east, south, eastKnown, southKnown, off, bad;
+    };
+
+    template <typename W>
+    TRAINTRACKS_BITBOARD_INLINE void Propagate(Board<W>& b, uint32_t* rounds) {
+        const W validT = Transpose(b.valid);
+        for (uint32_t round = 1; round <= MaxRounds; round++) {
+            const auto was = b;
+
+            // Both ends of a link hold track, and no link reaches an empty cell
+            b.track |= b.eastKnown | (b.eastKnown << 1) | b.southKnown | (b.southKnown << 8) | b.off;
+            b.east &= ~(b.empty | (b.empty >> 1));
+            b.south &= ~(b.empty | (b.empty >> 8));
+            b.bad |= (b.eastKnown & ~b.east) | (b.southKnown & ~b.south) | (b.track & b.empty);
+
+            // A cell with fewer than two ways to link is empty, and track
+            // with exactly two uses both
+            const LinkCount<W> may(b.off, b.east, b.south);
+            const W stuck = b.valid & ~may.atLeastTwo();
+            b.bad |= b.track & stuck;
+            b.empty |= stuck;
+            const W forced = b.track & may.two();
+            b.eastKnown |= b.east & (forced | (forced >> 1));
+            b.southKnown |= b.south & (forced | (forced >> 8));
+
+            // Track with two links can't take another
+            const LinkCount<W> must(b.off, b.eastKnown, b.southKnown);
+            b.bad |= must.more;
+            const W full = must.two();
+            b.east &= b.eastKnown | ~(full | (full >> 1));
+            b.south &= b.southKnown | ~(full | (full >> 8));
+
+            Lines(b.track, b.empty, b.valid, b.rows, b.bad);
+            W track = Transpose(b.track);
+            W empty = Transpose(b.empty);
+            Lines(track, empty, validT, b.cols, b.bad);
+            b.track |= Transpose(track);
+            b.empty |= Transpose(empty);
+
+            const W changed = (b.track ^ was.track) | (b.empty ^ was.empty) | (b.east ^ was.east) |
+                (b.south ^ was.south) | (b.eastKnown ^ was.eastKnown) | (b.southKnown ^ was.southKnown);
+            if (!Any(changed)) {
+                break;
+            }
+            for (size_t i = 0; i < sizeof(W) / sizeof(uint64_t); i++) {
+                if (Lane(changed, i)) {
+                    rounds[i] = round;
+                }
+            }
+        }
+    }
+
+    Board<uint64_t> Unpack(const Bitboard& s) {
+        return Board<uint64_t>{ s.valid, s.rows, s.cols, s.track, s.empty, s.east, s.south,
+            s.eastKnown, s.southKnown, s.off, s.bad };
+    }
+
+    void Pack(const Board<uint64_t>& b, Bitboard& s) {
+        s.track = b.track;
+        s.empty = b.empty;
+        s.east = b.east;
+        s.south = b.south;
+        s.eastKnown = b.eastKnown;
+        s.southKnown = b.southKnown;
+        s.bad = b.bad;
+    }
+
+    void PropagateScalar(Bitboard* boards, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            auto b = Unpack(boards[i]);
+            uint32_t rounds = 0;
+            Propagate(b, &rounds);
+            Pack(b, boards[i]);
+            boards[i].rounds = rounds + 1;
+        }
+    }
+
+    // The cells joined to seeds by known links
+    uint64_t Reach(const Board<uint64_t>& b, uint64_t seeds) {
+        while (true) {
+            const uint64_t next = seeds | ((seeds & b.eastKnown) << 1) | ((seeds >> 1) & b.eastKnown) |
+                ((seeds & b.southKnown) << 8) | ((seeds >> 8) & b.southKnown);
+            if (next == seeds) {
+                return seeds;
+            }
+            seeds = next;
+        }
+    }
+
+    // Whether the known links join every track cell to the entry
+    bool Connected(const Board<uint64_t>& b) {
+        return Reach(b, b.off & (~b.off + 1)) == b.track;
+    }
+
+    // Whether the known links close a loop. Every other run of links ends
+    // at the entry or exit or at a cell still missing a link.
+    bool Looped(const Board<uint64_t>& b, const LinkCount<uint64_t>& must) {
+        const uint64_t linked = b.eastKnown | (b.eastKnown << 1) | b.southKnown | (b.southKnown << 8);
+        return (linked & ~Reach(b, b.off | (linked & ~must.two()))) != 0;
+    }
+
+    enum class Branched {
+        Solved,
+        Failed,
+        OutOfNodes,
+    };
+
+    // Depth first over the links of the first track cell still missing
+    // one, propagating after each choice
+    Branched Branch(Board<uint64_t>& b, uint64_t& nodes, uint64_t maxNodes, uint32_t& rounds) {
+        if (++nodes > maxNodes) {
+            return Branched::OutOfNodes;
+        }
+        uint32_t settled = 0;
+        Propagate(b, &settled);
+        rounds += settled + 1;
+        if (b.bad != 0) {
+            return Branched::Failed;
+        }
+
+        const LinkCount<uint64_t> must(b.off, b.eastKnown, b.southKnown);
+        if (Looped(b, must)) {
+            return Branched::Failed;
+        }
+        const uint64_t missing = b.track & ~must.two();
+        if (missing == 0) {
+            // Any more track would be apart from the path
+            const uint64_t open = b.valid & ~b.track & ~b.empty;
+            if (open != 0) {
+                b.empty |= open;
+                Propagate(b, &settled);
+                rounds += settled + 1;
+            }
+            return b.bad == 0 && Connected(b) ? Branched::Solved : Branched::Failed;
+        }
+
+        const uint64_t cell = missing & (~missing + 1);
+        const std::array<std::pair<uint64_t Board<uint64_t>::*, uint64_t>, 4> links{ {
+            { &Board<uint64_t>::eastKnown, cell },
+            { &Board<uint64_t>::eastKnown, cell >> 1 },
+            { &Board<uint64_t>::southKnown, cell },
+            { &Board<uint64_t>::southKnown, cell >> 8 },
+        } };
+        for (const auto& [known, bit] : links) {
+            const auto& may = known == &Board<uint64_t>::eastKnown ? b.east : b.south;
+            if ((may & ~(b.*known) & bit) == 0) {
+                continue;
+            }
+            // Use the link, then failing that rule it out
+            auto child = b;
+            child.*known |= bit;
+            const auto outcome = Branch(child, nodes, maxNodes, rounds);
+            if (outcome != Branched::Failed) {
+                if (outcome == Branched::Solved) {
+                    b = child;
+                }
+                return outcome;
+            }
+            (known == &Board<uint64_t>::eastKnown ? b.east : b.south) &= ~bit;
+            return Branch(b, nodes, maxNodes, rounds);
+        }
+        return Branched::Failed;
+    }
+
+#if defined(__GNUC__)
+    TRAINTRACKS_BITBOARD_CLONES
+    void PropagateLanes(Bitboard* boards, size_t count) {
+        for (size_t first = 0; first < count; first += LaneCount) {
+            const size_t n = std::min(LaneCount, count - first);
+            Board<Lanes> b{};
+            // Lanes past the end are left as empty 0x0 boards, which settle
+            // straight away
+            for (size_t i = 0; i < n; i++) {
+                const auto& s = boards[first + i];
+                b.valid[i] = s.valid;
+                b.rows[i] = s.rows;
+                b.cols[i] = s.cols;
+                b.track[i] = s.track;
+                b.empty[i] = s.empty;
+                b.east[i] = s.east;
+                b.south[i] = s.south;
+                b.eastKnown[i] = s.eastKnown;
+                b.southKnown[i] = s.southKnown;
+                b.off[i] = s.off;
+                b.bad[i] = s.bad;
+            }
+            uint32_t rounds[LaneCount] = {};
+            Propagate(b, rounds);
+            for (size_t i = 0; i < n; i++) {
+                auto& s = boards[first + i];
+                s.track = b.track[i];
+                s.empty = b.empty[i];
+                s.east = b.east[i];
+                s.south = b.south[i];
+                s.eastKnown = b.eastKnown[i];
+                s.southKnown = b.southKnown[i];
+                s.bad = b.bad[i];
+                s.rounds = rounds[i] + 1;
+            }
+        }
+    }
+#endif
+}
+
+void PropagateBitboards(Bitboard* boards, size_t count, bool simd) {
+#if defined(__GNUC__)
+    if (simd) {
+        PropagateLanes(boards, count);
+        return;
+    }
+#endif
+    (void)simd;
+    PropagateScalar(boards, count);
+}
+
+bool BranchBitboard(Bitboard& board, uint64_t maxNodes) {
+    auto b = Unpack(board);
+    uint64_t nodes = 0;
+    uint32_t rounds = 0;
+    const auto outcome = Branch(b, nodes, maxNodes, rounds);
+    board.rounds += rounds;
+    if (outcome == Branched::OutOfNodes) {
+        return false;
+    }
+    Pack(b, board);
+    board.bad |= outcome == Branched::Failed;
+    return true;
+}
+
+const char* BitboardKernel(bool simd) {
+#if defined(__GNUC__)
+    if (simd) {
+#if defined(__x86_64__) && !defined(__clang__)
+        return __builtin_cpu_supports("avx2") ? "avx2" : "sse2";
+#else
+        return "vector";
+#endif
+    }
+#endif
+    (void)simd;
+    return "scalar";
+}
+
+} // namespace TrainTracks
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace TrainTracks {
+
+    // Bump allocator for per-solve scratch state. Everything a solve needs is
+    // carved out of a few large blocks and released together by Reset, which
+    // keeps the storage for the next puzzle. After the first solve of a given
+    // size a reused solver makes no heap allocations at all.
+    class Arena {
+    public:
+        explicit Arena(size_t capacity = 0)
+            : _block(0)
+            , _offset(0)
+            , _used(0)
+        {
+            if (capacity > 0) {
+                addBlock(capacity);
+            }
+        }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // Returns n values initialised to `value`. Only trivially
+        // destructible types, as nothing is ever destroyed.
+        template <typename T>
+        T* Allocate(size_t n, const T& value = T()) {
+            static_assert(std::is_trivially_destructible_v<T>, "Arena never runs destructors");
+            auto* p = static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+            std::uninitialized_fill_n(p, n, value);
+            return p;
+        }
+
+        // Releases everything. If the last solve spilled into extra blocks
+        // they are merged into one, so the next solve of that size fits.
+        void Reset() {
+            if (_blocks.size() > 1) {
+                const auto capacity = Capacity();
+                _blocks.clear();
+                addBlock(capacity);
+            }
+            _block = 0;
+            _offset = 0;
+            _used = 0;
+        }
+
+        // Bytes handed out since the last Reset, including alignment padding
+        size_t Used() const {
+            return _used;
+        }
+
+        size_t Capacity() const {
+            size_t capacity = 0;
+            for (const auto& b : _blocks) {
+                capacity += b.size;
+            }
+            return capacity;
+        }
+
+    private:
+        static constexpr size_t MinBlock = 4096;
+
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t size;
+        };
+
+        void* allocate(size_t bytes, size_t align) {
+            for (;;) {
+                if (_block < _blocks.size()) {
+                    auto& b = _blocks[_block];
+                    const auto start = (_offset + align - 1) & ~(align - 1);
+                    if (start + bytes <= b.size) {
+                        _used += start + bytes - _offset;
+                        _offset = start + bytes;
+                        return b.data.get() + start;
+                    }
+                    if (_block + 1 < _blocks.size()) {
+                        _block++;
+                        _offset = 0;
+                        continue;
+                    }
+                }
+                addBlock(std::max({ bytes + align, Capacity(), MinBlock }));
+                _block = _blocks.size() - 1;
+                _offset = 0;
+            }
+        }
+
+        void addBlock(size_t size) {
+            _blocks.push_back(Block{ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+        }
+
+        std::vector<Block> _blocks;
+        size_t _block;
+        size_t _offset;
+        size_t _used;
+    };
+}
@@ -0,0 +1,407 @@
+#pragma once
+
+#include "Domains.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Solver.h"
+
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace TrainTracks
+{
+
+    // A puzzle of at most 8x8 as 64 bit boards, bit y * 8 + x for each
+    // cell whatever the width, so each row is a byte. A link between two
+    // cells is kept at the one west of (or above) it.
+    struct Bitboard {
+        // Cells on the grid
+        uint64_t valid = 0;
+        // Byte y holds row y's constraint, byte x column x's
+        uint64_t rows = 0;
+        uint64_t cols = 0;
+        // Cells known to hold track, and known to be empty
+        uint64_t track = 0;
+        uint64_t empty = 0;
+        // Links to the cell east (south) which may still be used, and
+        // those which must be
+        uint64_t east = 0;
+        uint64_t south = 0;
+        uint64_t eastKnown = 0;
+        uint64_t southKnown = 0;
+        // The entry and exit, whose track leaves the grid
+        uint64_t off = 0;
+        // Non-zero once the boards contradict the puzzle
+        uint64_t bad = 0;
+        // Rounds of propagation until nothing changed
+        uint32_t rounds = 0;
+    };
+
+    // Runs the line and link rules over each board until none of them
+    // changes. With simd the boards are packed four to a vector and run in
+    // lock-step, using AVX2 where the CPU has it; otherwise one at a time.
+    // Defined in BatchSolver.cpp.
+    void PropagateBitboards(Bitboard* boards, size_t count, bool simd);
+
+    // Searches a propagated board, choosing links depth first and
+    // propagating after each, for at most maxNodes choices. Returns false
+    // if that wasn't enough, leaving the board as it was; otherwise the
+    // board is solved, or bad if it has no solution.
+    bool BranchBitboard(Bitboard& board, uint64_t maxNodes);
+
+    // The instruction set PropagateBitboards runs on
+    const char* BitboardKernel(bool simd);
+
+    struct BatchOptions {
+        // Run the boards in SIMD lanes, otherwise one at a time
+        bool simd = true;
+        // Choices BranchBitboard may make for a puzzle propagation leaves
+        // open before it goes to the fallback solver, 0 for none
+        uint64_t branchNodes = 4096;
+        // Searches the puzzles left open and those too big for a bitboard,
+        // PathSolver if not given
+        SolverFactory fallback = nullptr;
+    };
+
+    struct BatchStats {
+        uint64_t puzzles = 0;
+        // Solved, or shown unsolvable, by propagation alone, and by
+        // branching on the boards
+        uint64_t propagated = 0;
+        uint64_t branched = 0;
+        // Handed to the fallback solver, and how many of those because
+        // they were bigger than 8x8
+        uint64_t searched = 0;
+        uint64_t oversized = 0;
+    };
+
+    // Solves packs of small puzzles together. Each puzzle of at most 8x8 is
+    // loaded into a Bitboard and they are all propagated at once, which
+    // settles most small puzzles without any search for a few hundred word
+    // operations each. The rest keep what propagation found, as cell
+    // domains, and are searched one at a time by the fallback solver, as
+    // are puzzles too big for a board.
+    class BatchSolver {
+    public:
+        BatchSolver(const BatchOptions& options = BatchOptions())
+            : _config(options)
+        { }
+
+        static bool Fits(const Puzzle& p) {
+            return p.gridWidth <= 8 && p.gridHeight <= 8;
+        }
+
+        const char* Kernel() const {
+            return BitboardKernel(_config.simd);
+        }
+
+        // A result per puzzle, in order, with the solution filled in for
+        // those solved. options apply to each puzzle searched. Throws if
+        // any puzzle is invalid, as Grid would.
+        std::vector<SolveResult> Solve(const std::vector<Puzzle>& puzzles, const SolveOptions& options = SolveOptions()) {
+            PROFILE_ZONE("batch");
+            const auto start = SolveClock::now();
+            std::vector<SolveResult> results(puzzles.size());
+            _boards.clear();
+            _index.clear();
+            for (size_t i = 0; i < puzzles.size(); i++) {
+                if (Fits(puzzles[i])) {
+                    _boards.push_back(Load(puzzles[i]));
+                    _index.push_back(i);
+                }
+            }
+
+            PropagateBitboards(_boards.data(), _boards.size(), _config.simd);
+            // Propagation time is shared out evenly, it isn't kept per board
+            const std::chrono::nanoseconds share = _boards.empty() ? std::chrono::nanoseconds(0) :
+                std::chrono::nanoseconds(SolveClock::now() - start) / static_cast<int64_t>(_boards.size());
+
+            std::vector<bool> loaded(puzzles.size(), false);
+            for (size_t k = 0; k < _boards.size(); k++) {
+                auto& board = _boards[k];
+                const auto& puzzle = puzzles[_index[k]];
+                auto& result = results[_index[k]];
+                loaded[_index[k]] = true;
+                if (board.bad != 0) {
+                    result.status = SolveStatus::Unsolvable;
+                    _stats.propagated++;
+                } else if (Decode(puzzle, board, result.solution)) {
+                    result.status = SolveStatus::Solved;
+                    _stats.propagated++;
+                } else if (_config.branchNodes > 0 && BranchBitboard(board, _config.branchNodes)) {
+                    result.status = board.bad == 0 && Decode(puzzle, board, result.solution) ?
+                        SolveStatus::Solved : SolveStatus::Unsolvable;
+                    _stats.branched++;
+                } else {
+                    result = Search(puzzle, &board, options);
+                    _stats.searched++;
+                }
+                result.steps += board.rounds;
+                result.elapsed += share;
+            }
+            for (size_t i = 0; i < puzzles.size(); i++) {
+                if (!loaded[i]) {
+                    results[i] = Search(puzzles[i], nullptr, options);
+                    _stats.searched++;
+                    _stats.oversized++;
+                }
+            }
+            _stats.puzzles += puzzles.size();
+            return results;
+        }
+
+        const BatchStats& Stats() const {
+            return _stats;
+        }
+
+    private:
+        static constexpr uint8_t North = 1;
+        static constexpr uint8_t East = 2;
+        static constexpr uint8_t South = 4;
+        static constexpr uint8_t West = 8;
+
+        static uint8_t Links(Piece p) {
+            switch (p) {
+                case Piece::Horizontal: return East | West;
+                case Piece::Vertical: return North | South;
+                case Piece::CornerNE: return North | East;
+                case Piece::CornerSE: return South | East;
+                case Piece::CornerSW: return South | West;
+                case Piece::CornerNW: return North | West;
+                case Piece::Empty: break;
+            }
+            return 0;
+        }
+
+        static Piece FromLinks(uint8_t links) {
+            for (const auto p : ValidPieces) {
+                if (Links(p) == links) {
+                    return p;
+                }
+            }
+            return Piece::Empty;
+        }
+
+        static uint64_t Bit(int x, int y) {
+            return uint64_t(1) << (y * 8 + x);
+        }
+
+        static bool Has(uint64_t board, int x, int y) {
+            return (board >> (y * 8 + x)) & 1;
+        }
+
+        // The links at (x, y) in a pair of link boards, off the grid ones
+        // left out
+        static uint8_t LinksAt(uint64_t east, uint64_t south, int x, int y) {
+            return (y > 0 && Has(south, x, y - 1) ? North : 0) | (Has(east, x, y) ? East : 0) |
+                (Has(south, x, y) ? South : 0) | (x > 0 && Has(east, x - 1, y) ? West : 0);
+        }
+
+        // Checks the puzzle as the Grid constructor does, then sets the
+        // fixed pieces and their links
+        static Bitboard Load(const Puzzle& p) {
+            const int width = p.gridWidth;
+            const int height = p.gridHeight;
+            if (width <= 0 || height <= 0 ||
+                p.data.rowConstraints.size() != static_cast<size_t>(height) ||
+                p.data.colConstraints.size() != static_cast<size_t>(width) ||
+                p.data.startingGrid.size() != static_cast<size_t>(width) * height) {
+                throw std::runtime_error("Constraints don't match the grid size");
+            }
+
+            Bitboard b;
+            int total = 0;
+            for (int y = 0; y < height; y++) {
+                const auto c = p.data.rowConstraints[y];
+                if (c < 0 || c > width) {
+                    throw std::runtime_error("Row constraint out of range");
+                }
+                b.rows |= static_cast<uint64_t>(c) << (8 * y);
+                total += c;
+            }
+            for (int x = 0; x < width; x++) {
+                const auto c = p.data.colConstraints[x];
+                if (c < 0 || c > height) {
+                    throw std::runtime_error("Column constraint out of range");
+                }
+                b.cols |= static_cast<uint64_t>(c) << (8 * x);
+                total -= c;
+            }
+            if (total != 0) {
+                throw std::runtime_error("Row and Column constraint missmatch");
+            }
+
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    b.valid |= Bit(x, y);
+                    b.east |= x + 1 < width ? Bit(x, y) : 0;
+                    b.south |= y + 1 < height ? Bit(x, y) : 0;
+                }
+            }
+
+            // A fixed piece's links must be used and the others can't be
+            uint64_t eastCut = 0;
+            uint64_t southCut = 0;
+            int exits = 0;
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    const auto links = Links(p.data.startingGrid[Point{x, y}.project(width)]);
+                    if (links == 0) {
+                        continue;
+                    }
+                    b.track |= Bit(x, y);
+                    const int off = ((links & North) && y == 0) + ((links & South) && y + 1 == height) +
+                        ((links & West) && x == 0) + ((links & East) && x + 1 == width);
+                    if (off > 1) {
+                        throw std::runtime_error("Piece goes off grid more than once!");
+                    }
+                    if (off == 1) {
+                        b.off |= Bit(x, y);
+                        exits++;
+                    }
+                    if (x + 1 < width) {
+                        (links & East ? b.eastKnown : eastCut) |= Bit(x, y);
+                    }
+                    if (x > 0) {
+                        (links & West ? b.eastKnown : eastCut) |= Bit(x - 1, y);
+                    }
+                    if (y + 1 < height) {
+                        (links & South ? b.southKnown : southCut) |= Bit(x, y);
+                    }
+                    if (y > 0) {
+                        (links & North ? b.southKnown : southCut) |= Bit(x, y - 1);
+                    }
+                }
+            }
+            if (exits != 2) {
+                throw std::runtime_error("Invalid number of exits");
+            }
+            b.east &= ~eastCut;
+            b.south &= ~southCut;
+            return b;
+        }
+
+        // Reads the solution off a board propagation settled, checking the
+        // track is one path from the entry to the exit. False if any cell
+        // is still open or the track isn't a path.
+        static bool Decode(const Puzzle& p, const Bitboard& b, std::vector<Piece>& solution) {
+            if ((b.valid & ~b.track & ~b.empty) != 0) {
+                return false;
+            }
+            const int width = p.gridWidth;
+            const int height = p.gridHeight;
+            solution.assign(static_cast<size_t>(width) * height, Piece::Empty);
+            Point start{-1, -1};
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    if (!Has(b.track, x, y)) {
+                        continue;
+                    }
+                    const auto idx = Point{x, y}.project(width);
+                    if (Has(b.off, x, y)) {
+                        // The entry or exit, which the puzzle fixed
+                        solution[idx] = p.data.startingGrid[idx];
+                        start = Point{x, y};
+                    } else {
+                        solution[idx] = FromLinks(LinksAt(b.eastKnown, b.southKnown, x, y));
+                        if (solution[idx] == Piece::Empty) {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            // Follow the track from one end, it must cover every piece
+            int length = 0;
+            Point pos = start;
+            Point from{-1, -1};
+            while (true) {
+                length++;
+                Point next = pos;
+                for (const auto& d : Connections::GetConnections(solution[pos.project(width)])) {
+                    const auto n = pos + d;
+                    if (n != from && n.x >= 0 && n.y >= 0 && n.x < width && n.y < height) {
+                        next = n;
+                    }
+                }
+                if (next == pos || length > width * height) {
+                    break;
+                }
+                from = pos;
+                pos = next;
+            }
+            const bool path = Has(b.off, pos.x, pos.y) && pos != start;
+            return path && length == static_cast<int>(std::bitset<64>(b.track).count());
+        }
+
+        // What propagation left open at each cell, for the fallback solver
+        static CellDomains Domains(const Puzzle& p, const Bitboard& b) {
+            CellDomains domains(p.gridWidth, p.gridHeight);
+            for (int y = 0; y < p.gridHeight; y++) {
+                for (int x = 0; x < p.gridWidth; x++) {
+                    const Point pt{x, y};
+                    auto& d = domains.at(pt);
+                    if (Has(b.empty, x, y)) {
+                        d = EmptyDomain;
+                        continue;
+                    }
+                    const auto fixed = p.data.startingGrid[pt.project(p.gridWidth)];
+                    if (fixed != Piece::Empty) {
+                        d = DomainBit(fixed);
+                        continue;
+                    }
+                    const auto may = LinksAt(b.east, b.south, x, y);
+                    const auto must = LinksAt(b.eastKnown, b.southKnown, x, y);
+                    d = Has(b.track, x, y) ? 0 : EmptyDomain;
+                    for (const auto piece : ValidPieces) {
+                        const auto links = Links(piece);
+                        if ((links & ~may) == 0 && (must & ~links) == 0) {
+                            d |= DomainBit(piece);
+                        }
+                    }
+                }
+            }
+            return domains;
+        }
+
+        SolveResult Search(const Puzzle& puzzle, const Bitboard* board, const SolveOptions& options) {
+            if (!_solver) {
+                _solver = _config.fallback ? _config.fallback() : std::make_unique<PathSolver>();
+            }
+            CellDomains domains;
+            if (board) {
+                domains = Domains(puzzle, *board);
+                _solver->Domains(&domains);
+            }
+            if (_grid) {
+                _grid->reset(puzzle);
+            } else {
+                _grid.emplace(puzzle);
+            }
+            auto result = _solver->Solve(*_grid, options);
+            _solver->Domains(nullptr);
+            if (result.solved()) {
+                result.solution.reserve(_grid->cells());
+                for (int y = 0; y < _grid->height(); y++) {
+                    for (int x = 0; x < _grid->width(); x++) {
+                        result.solution.push_back(_grid->at(x, y));
+                    }
+                }
+            }
+            return result;
+        }
+
+        const BatchOptions _config;
+        BatchStats _stats;
+        std::unique_ptr<Solver> _solver;
+        // Reused between batches and searches
+        std::vector<Bitboard> _boards;
+        std::vector<size_t> _index;
+        std::optional<Grid> _grid;
+    };
+} // namespace TrainTracks
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace TrainTracks {
+
+    // Fixed capacity multi-producer, multi-consumer queue. Storage is
+    // allocated once up front; Push blocks while the queue is full and
+    // TryPush refuses instead, so producers get backpressure or rejection.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity)
+            : _items(capacity)
+            , _head(0)
+            , _count(0)
+            , _closed(false)
+        {
+            if (capacity == 0) {
+                throw std::runtime_error("BoundedQueue capacity must be non-zero");
+            }
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // Blocks while full, returns false if the queue was closed
+        bool Push(T&& item) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _notFull.wait(lock, [this] { return _closed || _count < _items.size(); });
+            if (_closed) {
+                return false;
+            }
+            emplace(std::move(item));
+            lock.unlock();
+            _notEmpty.notify_one();
+            return true;
+        }
+
+        // Returns false straight away if full or closed
+        bool TryPush(T&& item) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_closed || _count == _items.size()) {
+                return false;
+            }
+            emplace(std::move(item));
+            lock.unlock();
+            _notEmpty.notify_one();
+            return true;
+        }
+
+        // Blocks while empty, returns false once closed and drained
+        bool Pop(T& item) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _notEmpty.wait(lock, [this] { return _closed || _count > 0; });
+            if (_count == 0) {
+                return false;
+            }
+            item = std::move(_items[_head]);
+            _head = (_head + 1) % _items.size();
+            _count--;
+            lock.unlock();
+            _notFull.notify_one();
+            return true;
+        }
+
+        // Wakes everyone up; queued items can still be popped
+        void Close() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+            }
+            _notEmpty.notify_all();
+            _notFull.notify_all();
+        }
+
+        size_t Size() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _count;
+        }
+
+        size_t Capacity() const {
+            return _items.size();
+        }
+
+    private:
+        void emplace(T&& item) {
+            _items[(_head + _count) % _items.size()] = std::move(item);
+            _count++;
+        }
+
+        mutable std::mutex _mutex;
+        std::condition_variable _notEmpty;
+        std::condition_variable _notFull;
+        std::vector<T> _items;
+        size_t _head;
+        size_t _count;
+        bool _closed;
+    };
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "PathSolver.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace TrainTracks {
+
+    // PathCheckpoint file format, little endian: the magic, a header of
+    //   u32 version, u32 width, u32 height, u32 levels, u64 seed,
+    //   u64 fingerprint, u64 random, u64 steps, u8 fromExit, u8[3] order
+    // then the track per row and column as u16s, and eight bytes a level:
+    //   u32 cell, u8 count << 4 | choice, u8[3] candidates
+    // with pieces packed two to a byte, low nibble first.
+    constexpr char CheckpointMagic[8] = { 'T', 'T', 'C', 'H', 'E', 'C', 'K', 'P' };
+    constexpr uint32_t CheckpointVersion = 1;
+
+    namespace CheckpointDetail {
+        template <typename T>
+        void Put(std::ostream& out, T v) {
+            out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+        }
+
+        template <typename T>
+        T Get(std::istream& in) {
+            T v{};
+            if (!in.read(reinterpret_cast<char*>(&v), sizeof(v))) {
+                throw std::runtime_error("Truncated checkpoint");
+            }
+            return v;
+        }
+
+        inline void PutPieces(std::ostream& out, const std::array<Piece, 6>& pieces) {
+            for (size_t i = 0; i < pieces.size(); i += 2) {
+                Put<uint8_t>(out, static_cast<uint8_t>(static_cast<uint8_t>(pieces[i]) |
+                    static_cast<uint8_t>(pieces[i + 1]) << 4));
+            }
+        }
+
+        inline void GetPieces(std::istream& in, std::array<Piece, 6>& pieces, size_t count) {
+            for (size_t i = 0; i < pieces.size(); i += 2) {
+                const auto b = Get<uint8_t>(in);
+                pieces[i] = static_cast<Piece>(b & 0xF);
+                pieces[i + 1] = static_cast<Piece>(b >> 4);
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (pieces[i] < Piece::Horizontal || pieces[i] > Piece::CornerNW) {
+                    throw std::runtime_error("Corrupt checkpoint");
+                }
+            }
+        }
+    }
+
+    inline void WriteCheckpoint(std::ostream& out, const PathCheckpoint& c) {
+        using namespace CheckpointDetail;
+        const auto width = static_cast<uint32_t>(c.colCounts.size());
+        out.write(CheckpointMagic, sizeof(CheckpointMagic));
+        Put(out, CheckpointVersion);
+        Put(out, width);
+        Put(out, static_cast<uint32_t>(c.rowCounts.size()));
+        Put(out, static_cast<uint32_t>(c.levels.size()));
+        Put(out, c.seed);
+        Put(out, c.fingerprint);
+        Put(out, c.random);
+        Put(out, c.steps);
+        Put<uint8_t>(out, c.fromExit);
+        PutPieces(out, c.order);
+        for (const auto n : c.rowCounts) {
+            Put(out, n);
+        }
+        for (const auto n : c.colCounts) {
+            Put(out, n);
+        }
+        for (const auto& level : c.levels) {
+            Put(out, static_cast<uint32_t>(level.cell.project(width)));
+            Put<uint8_t>(out, static_cast<uint8_t>(level.count << 4 | level.choice));
+            PutPieces(out, level.candidates);
+        }
+    }
+
+    inline PathCheckpoint ReadCheckpoint(std::istream& in) {
+        using namespace CheckpointDetail;
+        char magic[sizeof(CheckpointMagic)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CheckpointMagic, sizeof(magic)) != 0) {
+            throw std::runtime_error("Not a checkpoint");
+        }
+        if (Get<uint32_t>(in) != CheckpointVersion) {
+            throw std::runtime_error("Unsupported checkpoint version");
+        }
+        PathCheckpoint c;
+        const auto width = Get<uint32_t>(in);
+        const auto height = Get<uint32_t>(in);
+        const auto levels = Get<uint32_t>(in);
+        if (width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF ||
+            levels > static_cast<uint64_t>(width) * height) {
+            throw std::runtime_error("Corrupt checkpoint");
+        }
+        c.seed = Get<uint64_t>(in);
+        c.fingerprint = Get<uint64_t>(in);
+        c.random = Get<uint64_t>(in);
+        c.steps = Get<uint64_t>(in);
+        c.fromExit = Get<uint8_t>(in) != 0;
+        GetPieces(in, c.order, c.order.size());
+        c.rowCounts.resize(height);
+        for (auto& n : c.rowCounts) {
+            n = Get<uint16_t>(in);
+        }
+        c.colCounts.resize(width);
+        for (auto& n : c.colCounts) {
+            n = Get<uint16_t>(in);
+        }
+        c.levels.resize(levels);
+        for (auto& level : c.levels) {
+            const auto cell = Get<uint32_t>(in);
+            if (cell >= width * height) {
+                throw std::runtime_error("Corrupt checkpoint");
+            }
+            level.cell = Point{ static_cast<int>(cell % width), static_cast<int>(cell / width) };
+            const auto packed = Get<uint8_t>(in);
+            level.count = packed >> 4;
+            level.choice = packed & 0xF;
+            if (level.count > level.candidates.size()) {
+                throw std::runtime_error("Corrupt checkpoint");
+            }
+            GetPieces(in, level.candidates, level.count);
+        }
+        return c;
+    }
+
+    // Writes each checkpoint over the last in a file. It is written
+    // alongside and renamed into place, so a crash part way through leaves
+    // the previous one. Save is called from inside the search, so failures
+    // are kept for afterwards rather than thrown.
+    class CheckpointFile {
+    public:
+        explicit CheckpointFile(std::string path)
+            : _path(std::move(path))
+            , _saved(0)
+            , _bytes(0)
+        { }
+
+        bool Save(const PathCheckpoint& c) {
+            const auto temp = _path + ".tmp";
+            {
+                std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+                WriteCheckpoint(out, c);
+                out.flush();
+                if (!out) {
+                    _error = "Unable to write " + temp;
+                    return false;
+                }
+                _bytes = static_cast<size_t>(out.tellp());
+            }
+            if (std::rename(temp.c_str(), _path.c_str()) != 0) {
+                _error = "Unable to replace " + _path;
+                return false;
+            }
+            _saved++;
+            return true;
+        }
+
+        static PathCheckpoint Load(const std::string& path) {
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw std::runtime_error("Unable to open " + path);
+            }
+            return ReadCheckpoint(in);
+        }
+
+        uint64_t Saved() const {
+            return _saved;
+        }
+
+        // Size of the last checkpoint written
+        size_t Bytes() const {
+            return _bytes;
+        }
+
+        // Why the last failed Save failed, empty if none has
+        const std::string& Error() const {
+            return _error;
+        }
+
+    private:
+        const std::string _path;
+        uint64_t _saved;
+        size_t _bytes;
+        std::string _error;
+    };
+}
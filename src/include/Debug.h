@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Log.h"
+#include "Trace.h"
 
 #ifndef NDEBUG
 #define DEBUG(x) do { \
@@ -10,4 +11,11 @@
 #define DEBUG(x)
 #endif
 
-#define DEBUG_LOG(...) DEBUG(LOG(__func__, __VA_ARGS__))
\ No newline at end of file
+// Traced rather than logged, so it is cheap enough to leave in the search:
+// start tracing with Trace::Start (Runner --trace) and read the file back
+// with TraceDump. Release builds keep it with -DTRAINTRACKS_TRACE=ON.
+#if !defined(NDEBUG) || defined(TRAINTRACKS_TRACE)
+#define DEBUG_LOG(...) TRACE(__VA_ARGS__)
+#else
+#define DEBUG_LOG(...)
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Piece.h"
+#include "Point.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace TrainTracks {
+
+    // A set of possible cell states, one bit for Empty and one per piece
+    using Domain = uint8_t;
+
+    constexpr Domain EmptyDomain = 0x01;
+    constexpr Domain TrackDomain = 0x7E;
+    constexpr Domain FullDomain = EmptyDomain | TrackDomain;
+
+    constexpr Domain DomainBit(Piece p) {
+        return p == Piece::Empty ? EmptyDomain :
+            static_cast<Domain>(1 << (static_cast<int>(p) - 2));
+    }
+
+    constexpr Piece DomainPiece(Domain d) {
+        switch (d) {
+            case DomainBit(Piece::Horizontal): return Piece::Horizontal;
+            case DomainBit(Piece::Vertical): return Piece::Vertical;
+            case DomainBit(Piece::CornerNE): return Piece::CornerNE;
+            case DomainBit(Piece::CornerSE): return Piece::CornerSE;
+            case DomainBit(Piece::CornerSW): return Piece::CornerSW;
+            case DomainBit(Piece::CornerNW): return Piece::CornerNW;
+        }
+        return Piece::Empty;
+    }
+
+    constexpr bool IsSingleton(Domain d) {
+        return d != 0 && (d & (d - 1)) == 0;
+    }
+
+    // Per-cell domains for a grid, row-major
+    class CellDomains {
+    public:
+        CellDomains()
+            : _width(0)
+            , _height(0)
+        { }
+
+        CellDomains(int width, int height)
+            : _width(width)
+            , _height(height)
+            , _domains(static_cast<size_t>(width) * height, FullDomain)
+        { }
+
+        int width() const {
+            return _width;
+        }
+
+        int height() const {
+            return _height;
+        }
+
+        Domain& at(const Point& pt) {
+            return _domains[pt.project(_width)];
+        }
+
+        Domain at(const Point& pt) const {
+            return _domains[pt.project(_width)];
+        }
+
+        bool allows(const Point& pt, Piece p) const {
+            return (at(pt) & DomainBit(p)) != 0;
+        }
+
+        // The piece a cell is known to hold, or Empty if it is still open
+        // (or known to be empty)
+        Piece known(const Point& pt) const {
+            return DomainPiece(at(pt));
+        }
+
+    private:
+        int _width;
+        int _height;
+        std::vector<Domain> _domains;
+    };
+}
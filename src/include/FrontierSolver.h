@@ -0,0 +1,460 @@
+#pragma once
+
+#include "Presolver.h"
+#include "Solver.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace TrainTracks
+{
+
+    struct FrontierOptions {
+        // Most memory the states may take, past which the solve gives up
+        // as TimedOut with Stats().outOfMemory set
+        size_t maxBytes = size_t(1) << 30;
+    };
+
+    struct FrontierStats {
+        // States built over the whole sweep, and in the largest frontier
+        uint64_t states = 0;
+        uint64_t peakStates = 0;
+        // Solutions to the grid as given, saturating at the largest uint64_t
+        uint64_t solutions = 0;
+        size_t peakBytes = 0;
+        bool outOfMemory = false;
+    };
+
+    // Sweeps the cells in row-major order carrying every distinct way the
+    // track can cross the frontier between the cells done and those to
+    // come, so its work grows with the grid's width rather than with the
+    // length of the path. A frontier state holds:
+    //  - a label per stub crossing the frontier, one per column pointing
+    //    down plus one pointing right into the next cell. The two ends of
+    //    each piece of track so far share a label, and an end whose piece
+    //    leads off the grid (from the entry or exit) is Free.
+    //  - how much track is in each column so far, and in the current row.
+    //  - whether the path is complete, after which every cell stays empty.
+    // States are hash-consed per cell, labels being renumbered in order so
+    // equal frontiers meet, and each keeps how many ways reach it and one
+    // state it came from, so the sweep both counts the solutions and
+    // rebuilds one. Joining both ends of one piece would close a loop and
+    // is never allowed; row counts are checked at the end of each row and
+    // column counts as soon as the column can't reach its target. There is
+    // no tree of decisions to record, so a recorder sees each cell visited
+    // once per state and then the pieces of the solution as tries.
+    class FrontierSolver
+        : public Solver {
+
+    public:
+        FrontierSolver(const FrontierOptions& options = FrontierOptions())
+            : Solver()
+            , _config(options)
+        { }
+
+        using Solver::Solve;
+
+        bool Solve(Grid& grid) override {
+            _stats = FrontierStats();
+            _arena.Reset();
+            const int width = grid.width();
+            const int height = grid.height();
+            if (width + 1 >= Free || height >= std::numeric_limits<uint8_t>::max()) {
+                throw std::runtime_error("Grid too large for the frontier solver");
+            }
+            _width = width;
+            _keySize = static_cast<size_t>(2 * width + 3);
+            _layers.assign(grid.cells(), nullptr);
+
+            // Without domains from the caller the presolver's narrow the
+            // pieces each cell may take, which prunes far more states than
+            // the counts alone
+            Presolver presolver(grid);
+            const auto* given = _domains;
+            if (!given) {
+                if (!presolver.Propagate()) {
+                    return false;
+                }
+                _domains = &presolver.domains();
+            }
+            const bool solved = Sweep(grid);
+            _domains = given;
+            return solved;
+        }
+
+        // Statistics for the last solve
+        const FrontierStats& Stats() const {
+            return _stats;
+        }
+
+    private:
+        bool Sweep(Grid& grid) {
+            const int width = grid.width();
+            const int height = grid.height();
+            _rowsAfter.assign(height, 0);
+            for (int y = height - 2; y >= 0; y--) {
+                _rowsAfter[y] = _rowsAfter[y + 1] + grid.rowConstraint(y + 1);
+            }
+            // Cells after each one in its row, and below it in its column,
+            // which may still take track
+            _rowRoom.assign(grid.cells(), 0);
+            _colRoom.assign(grid.cells(), 0);
+            for (int y = height - 1; y >= 0; y--) {
+                for (int x = width - 1; x >= 0; x--) {
+                    const auto idx = Point{x, y}.project(width);
+                    if (x + 1 < width) {
+                        _rowRoom[idx] = _rowRoom[idx + 1] + MayHoldTrack(grid, Point{x + 1, y});
+                    }
+                    if (y + 1 < height) {
+                        _colRoom[idx] = _colRoom[idx + width] + MayHoldTrack(grid, Point{x, y + 1});
+                    }
+                }
+            }
+
+            // Nothing crosses the frontier before the first cell
+            _keys.assign(_keySize, 0);
+            _counts.assign(1, 1);
+            std::vector<uint8_t> next(_keySize);
+
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    const Point pos{x, y};
+                    const auto states = _counts.size();
+                    Begin();
+
+                    std::array<Piece, 7> candidates;
+                    int count = 0;
+                    if (grid.isFilled(pos)) {
+                        candidates[count++] = grid.at(pos);
+                    } else {
+                        if (Allowed(pos, Piece::Empty)) {
+                            candidates[count++] = Piece::Empty;
+                        }
+                        for (const auto p : ValidPieces) {
+                            if (Allowed(pos, p)) {
+                                candidates[count++] = p;
+                            }
+                        }
+                    }
+                    const bool offGrid = pos == grid.entry() || pos == grid.exit();
+
+                    for (size_t s = 0; s < states; s++) {
+                        Step(pos);
+                        if (Interrupted()) {
+                            return false;
+                        }
+                        const uint8_t* key = &_keys[s * _keySize];
+                        for (int i = 0; i < count; i++) {
+                            if (Advance(grid, pos, key, candidates[i], offGrid, next.data())) {
+                                Add(next.data(), _counts[s], static_cast<uint32_t>(s), candidates[i]);
+                            }
+                        }
+                    }
+
+                    if (!End(pos.project(width))) {
+                        _stats.outOfMemory = true;
+                        Interrupt(SolveStatus::TimedOut);
+                        return false;
+                    }
+                    if (_counts.empty()) {
+                        return false;
+                    }
+                }
+            }
+
+            // Every state left has placed the whole path
+            int accept = -1;
+            for (size_t s = 0; s < _counts.size(); s++) {
+                if (_keys[s * _keySize + _keySize - 1]) {
+                    _stats.solutions = SaturatingAdd(_stats.solutions, _counts[s]);
+                    if (accept < 0) {
+                        accept = static_cast<int>(s);
+                    }
+                }
+            }
+            if (accept < 0) {
+                return false;
+            }
+
+            for (auto idx = static_cast<int>(grid.cells()) - 1; idx >= 0; idx--) {
+                const auto& from = _layers[idx][accept];
+                const Point pt{ idx % width, idx / width };
+                const auto p = static_cast<Piece>(from.piece);
+                if (p != Piece::Empty && grid.isEmpty(pt)) {
+                    grid.place(pt, p);
+                    Tried(pt, p);
+                }
+                accept = static_cast<int>(from.state);
+            }
+            return true;
+        }
+
+        // Directions as bits
+        static constexpr uint8_t North = 1;
+        static constexpr uint8_t East = 2;
+        static constexpr uint8_t South = 4;
+        static constexpr uint8_t West = 8;
+        // Label of an end whose piece of track leads off the grid
+        static constexpr uint8_t Free = 0x7F;
+        // Label for a new piece of track before renumbering
+        static constexpr uint8_t Fresh = 0x7E;
+
+        struct Parent {
+            uint32_t state;
+            uint8_t piece;
+        };
+
+        static uint8_t Links(Piece p) {
+            switch (p) {
+                case Piece::Horizontal: return East | West;
+                case Piece::Vertical: return North | South;
+                case Piece::CornerNE: return North | East;
+                case Piece::CornerSE: return South | East;
+                case Piece::CornerSW: return South | West;
+                case Piece::CornerNW: return North | West;
+                case Piece::Empty: break;
+            }
+            return 0;
+        }
+
+        // Key layout: a label per column stub then the stub into the next
+        // cell, track per column, track in this row, and whether the path
+        // is complete
+        uint8_t* Labels(uint8_t* key) const { return key; }
+        uint8_t* Cols(uint8_t* key) const { return key + _width + 1; }
+        uint8_t& Row(uint8_t* key) const { return key[2 * _width + 1]; }
+        uint8_t& Done(uint8_t* key) const { return key[2 * _width + 2]; }
+
+        // Whether pt is fixed or may still take track
+        bool MayHoldTrack(const Grid& grid, const Point& pt) const {
+            return grid.isFilled(pt) || (_domains->at(pt) & TrackDomain) != 0;
+        }
+
+        // The state after placing p at pos, if p fits
+        bool Advance(const Grid& grid, const Point& pos, const uint8_t* from, Piece p, bool offGrid,
+                uint8_t* to) const {
+            const int x = pos.x;
+            const int w = _width;
+            const auto idx = pos.project(w);
+            const auto links = Links(p);
+            const uint8_t up = from[x];
+            const uint8_t left = from[w];
+            if (from[2 * w + 2] && p != Piece::Empty) {
+                return false;
+            }
+
+            // Which way each link leads: a stub already on the frontier, off
+            // the grid, or a new stub
+            const bool northOff = pos.y == 0;
+            const bool westOff = x == 0;
+            const bool southOff = pos.y == grid.height() - 1;
+            const bool eastOff = x == w - 1;
+            if (((links & North) != 0) != (up != 0) && !northOff) { return false; }
+            if (((links & West) != 0) != (left != 0) && !westOff) { return false; }
+            const int off = ((links & North) && northOff) + ((links & West) && westOff) +
+                ((links & South) && southOff) + ((links & East) && eastOff);
+            if (off > 0 && !offGrid) {
+                return false;
+            }
+
+            std::memcpy(to, from, _keySize);
+            uint8_t* labels = to;
+            if (p != Piece::Empty) {
+                const auto row = Row(to) + 1;
+                const auto col = Cols(to)[x] + 1;
+                if (row > grid.rowConstraint(pos.y) || col > grid.colConstraint(x)) {
+                    return false;
+                }
+                Row(to) = static_cast<uint8_t>(row);
+                Cols(to)[x] = static_cast<uint8_t>(col);
+            }
+            labels[x] = 0;
+            labels[w] = 0;
+
+            // Ends already fixed in place, and new stubs
+            uint8_t ends[2];
+            int fixed = 0;
+            if (links & North) { ends[fixed++] = northOff ? Free : up; }
+            if (links & West) { ends[fixed++] = westOff ? Free : left; }
+            if ((links & South) && southOff) { ends[fixed++] = Free; }
+            if ((links & East) && eastOff) { ends[fixed++] = Free; }
+            const bool south = (links & South) && !southOff;
+            const bool east = (links & East) && !eastOff;
+
+            if (fixed == 0 && p != Piece::Empty) {
+                labels[x] = Fresh;
+                labels[w] = Fresh;
+            } else if (fixed == 1) {
+                labels[south ? x : w] = ends[0];
+            } else if (fixed == 2) {
+                const auto a = ends[0];
+                const auto b = ends[1];
+                if (a == b && a != Free) {
+                    // Both ends of one piece, a loop
+                    return false;
+                }
+                if (a == Free && b == Free) {
+                    // The path runs from the entry to the exit, so it is
+                    // done if nothing else is left open and every count is
+                    // met
+                    for (int i = 0; i <= w; i++) {
+                        if (labels[i]) {
+                            return false;
+                        }
+                    }
+                    if (Row(to) != grid.rowConstraint(pos.y) || _rowsAfter[pos.y] != 0) {
+                        return false;
+                    }
+                    for (int c = 0; c < w; c++) {
+                        if (Cols(to)[c] != grid.colConstraint(c)) {
+                            return false;
+                        }
+                    }
+                    Done(to) = 1;
+                } else {
+                    // The far ends of the two pieces are now the ends of one
+                    const auto keep = a == Free ? Free : (b == Free ? Free : a);
+                    for (int i = 0; i <= w; i++) {
+                        if (labels[i] == a || labels[i] == b) {
+                            labels[i] = keep;
+                        }
+                    }
+                }
+            }
+
+            // Counts which can no longer be met
+            if (x == w - 1) {
+                if (Row(to) != grid.rowConstraint(pos.y)) {
+                    return false;
+                }
+                Row(to) = 0;
+            } else if (Row(to) + _rowRoom[idx] < grid.rowConstraint(pos.y) ||
+                    (east && Row(to) >= grid.rowConstraint(pos.y))) {
+                return false;
+            }
+            if (Cols(to)[x] + _colRoom[idx] < grid.colConstraint(x) ||
+                    (south && Cols(to)[x] >= grid.colConstraint(x))) {
+                return false;
+            }
+
+            Normalize(labels);
+            return true;
+        }
+
+        // Renumbers piece labels in order of first appearance
+        void Normalize(uint8_t* labels) const {
+            std::array<uint8_t, 256> map{};
+            uint8_t next = 1;
+            for (int i = 0; i <= _width; i++) {
+                const auto l = labels[i];
+                if (l == 0 || l == Free) {
+                    continue;
+                }
+                if (map[l] == 0) {
+                    map[l] = next++;
+                }
+                labels[i] = map[l];
+            }
+        }
+
+        // Starts the next frontier
+        void Begin() {
+            _nextKeys.clear();
+            _nextCounts.clear();
+            _parents.clear();
+            // Sized for a frontier like the last, Add grows it if not
+            size_t size = 1024;
+            while (size < _counts.size() * 4) {
+                size <<= 1;
+            }
+            _table.assign(size, 0);
+        }
+
+        void Add(const uint8_t* key, uint64_t count, uint32_t from, Piece p) {
+            if ((_nextCounts.size() + 1) * 2 > _table.size()) {
+                Grow();
+            }
+            const auto mask = _table.size() - 1;
+            for (auto slot = Hash(key) & mask; ; slot = (slot + 1) & mask) {
+                const auto entry = _table[slot];
+                if (entry == 0) {
+                    _table[slot] = static_cast<uint32_t>(_nextCounts.size() + 1);
+                    _nextKeys.insert(_nextKeys.end(), key, key + _keySize);
+                    _nextCounts.push_back(count);
+                    _parents.push_back(Parent{ from, static_cast<uint8_t>(p) });
+                    return;
+                }
+                if (std::memcmp(&_nextKeys[(entry - 1) * _keySize], key, _keySize) == 0) {
+                    _nextCounts[entry - 1] = SaturatingAdd(_nextCounts[entry - 1], count);
+                    return;
+                }
+            }
+        }
+
+        void Grow() {
+            std::vector<uint32_t> table(_table.size() * 2, 0);
+            const auto mask = table.size() - 1;
+            for (size_t s = 0; s < _nextCounts.size(); s++) {
+                auto slot = Hash(&_nextKeys[s * _keySize]) & mask;
+                while (table[slot] != 0) {
+                    slot = (slot + 1) & mask;
+                }
+                table[slot] = static_cast<uint32_t>(s + 1);
+            }
+            _table.swap(table);
+        }
+
+        // Keeps the finished frontier's parents and makes it current.
+        // Returns false if the states no longer fit in memory.
+        bool End(int64_t idx) {
+            auto* parents = _arena.Allocate<Parent>(_parents.size());
+            std::copy(_parents.begin(), _parents.end(), parents);
+            _layers[idx] = parents;
+            _keys.swap(_nextKeys);
+            _counts.swap(_nextCounts);
+
+            _stats.states += _counts.size();
+            _stats.peakStates = std::max<uint64_t>(_stats.peakStates, _counts.size());
+            const auto bytes = _arena.Used() + (_keys.capacity() + _nextKeys.capacity()) +
+                (_counts.capacity() + _nextCounts.capacity()) * sizeof(uint64_t) +
+                _parents.capacity() * sizeof(Parent) + _table.capacity() * sizeof(uint32_t);
+            _stats.peakBytes = std::max(_stats.peakBytes, bytes);
+            return bytes <= _config.maxBytes;
+        }
+
+        // FNV-1a
+        uint64_t Hash(const uint8_t* key) const {
+            uint64_t h = 0xcbf29ce484222325ull;
+            for (size_t i = 0; i < _keySize; i++) {
+                h = (h ^ key[i]) * 0x100000001b3ull;
+            }
+            return h ^ (h >> 29);
+        }
+
+        static uint64_t SaturatingAdd(uint64_t a, uint64_t b) {
+            return a > std::numeric_limits<uint64_t>::max() - b ? std::numeric_limits<uint64_t>::max() : a + b;
+        }
+
+        const FrontierOptions _config;
+        FrontierStats _stats;
+        int _width = 0;
+        size_t _keySize = 0;
+
+        // The current frontier's states, and the one being built with its
+        // hash table and parents
+        std::vector<uint8_t> _keys;
+        std::vector<uint64_t> _counts;
+        std::vector<uint8_t> _nextKeys;
+        std::vector<uint64_t> _nextCounts;
+        std::vector<Parent> _parents;
+        std::vector<uint32_t> _table;
+        std::vector<int> _rowsAfter;
+        std::vector<int> _rowRoom;
+        std::vector<int> _colRoom;
+        // Arena backed parents of every frontier, one per cell
+        std::vector<Parent*> _layers;
+    };
+} // namespace TrainTracks
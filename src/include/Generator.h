@@ -0,0 +1,149 @@
+#pragma once
+
+#include "Connections.h"
+#include "Puzzle.h"
+
+#include <array>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace TrainTracks {
+
+    struct GeneratorOptions {
+        int width = 8;
+        int height = 8;
+        uint64_t seed = 0;
+        // Fraction of the path's pieces given as fixed hints, on top of the
+        // entry and exit
+        double hints = 0.1;
+        // Shortest acceptable path, 0 for width + height
+        int minLength = 0;
+    };
+
+    // Builds random puzzles by walking a self-avoiding path from one edge of
+    // the grid to another and counting its pieces per row and column. Every
+    // generated puzzle has at least that path as a solution, though it need
+    // not be the only one.
+    class Generator {
+    public:
+        static Puzzle Generate(const GeneratorOptions& options, std::vector<Piece>* solution = nullptr) {
+            if (options.width < 2 || options.height < 2) {
+                throw std::runtime_error("Generated grids must be at least 2x2");
+            }
+            std::mt19937_64 rng(options.seed);
+            const int minLength = options.minLength > 0 ? options.minLength : options.width + options.height;
+
+            std::vector<Point> path;
+            for (int attempt = 0; !Walk(options.width, options.height, minLength, rng, path); attempt++) {
+                if (attempt == 100) {
+                    throw std::runtime_error("Unable to generate a path");
+                }
+            }
+
+            const size_t cells = static_cast<size_t>(options.width) * options.height;
+            std::vector<Piece> pieces(cells, Piece::Empty);
+            for (size_t i = 0; i < path.size(); i++) {
+                // The ends connect off the grid
+                const auto in = i == 0 ? OffGrid(path[i], options.height) : path[i - 1] - path[i];
+                const auto out = i + 1 == path.size() ? OffGrid(path[i], options.height) : path[i + 1] - path[i];
+                pieces[path[i].project(options.width)] = Connections::GetPiece(in, out);
+            }
+
+            Puzzle puzzle;
+            puzzle.gridWidth = options.width;
+            puzzle.gridHeight = options.height;
+            puzzle.data.rowConstraints.assign(options.height, 0);
+            puzzle.data.colConstraints.assign(options.width, 0);
+            puzzle.data.startingGrid.assign(cells, Piece::Empty);
+            for (const auto& pt : path) {
+                puzzle.data.rowConstraints[pt.y]++;
+                puzzle.data.colConstraints[pt.x]++;
+            }
+
+            std::bernoulli_distribution hint(options.hints);
+            for (size_t i = 0; i < path.size(); i++) {
+                if (i == 0 || i + 1 == path.size() || hint(rng)) {
+                    const auto idx = path[i].project(options.width);
+                    puzzle.data.startingGrid[idx] = pieces[idx];
+                }
+            }
+
+            if (solution) {
+                *solution = std::move(pieces);
+            }
+            return puzzle;
+        }
+
+    private:
+        // Randomised depth first search from an edge cell until it reaches
+        // another edge cell with at least minLength cells behind it
+        static bool Walk(int width, int height, int minLength, std::mt19937_64& rng, std::vector<Point>& path) {
+            static constexpr std::array<Point, 4> Directions{ Point{0, 1}, Point{1, 0}, Point{0, -1}, Point{-1, 0} };
+
+            const int perimeter = 2 * (width + height) - 4;
+            const auto start = EdgeCell(std::uniform_int_distribution<int>(0, perimeter - 1)(rng), width, height);
+
+            std::vector<bool> used(static_cast<size_t>(width) * height, false);
+            // Per depth, the shuffled directions and how many have been tried
+            std::vector<std::pair<std::array<int, 4>, int>> tried;
+            path.assign(1, start);
+            used[start.project(width)] = true;
+            tried.push_back({ Shuffled(rng), 0 });
+
+            // Bounds the search on grids where the walk paints itself into a corner
+            uint64_t budget = static_cast<uint64_t>(width) * height * 64;
+            while (!path.empty() && budget-- > 0) {
+                const auto pt = path.back();
+                if (static_cast<int>(path.size()) >= minLength && path.size() > 1 && IsEdge(pt, width, height)) {
+                    return true;
+                }
+
+                auto& [order, next] = tried.back();
+                if (next == 4) {
+                    used[pt.project(width)] = false;
+                    path.pop_back();
+                    tried.pop_back();
+                    continue;
+                }
+
+                const auto n = pt + Directions[order[next++]];
+                if (n.x < 0 || n.y < 0 || n.x >= width || n.y >= height || used[n.project(width)]) {
+                    continue;
+                }
+                used[n.project(width)] = true;
+                path.push_back(n);
+                tried.push_back({ Shuffled(rng), 0 });
+            }
+            return false;
+        }
+
+        static std::array<int, 4> Shuffled(std::mt19937_64& rng) {
+            std::array<int, 4> order{ 0, 1, 2, 3 };
+            std::shuffle(order.begin(), order.end(), rng);
+            return order;
+        }
+
+        // Walks the border clockwise from the top left
+        static Point EdgeCell(int i, int width, int height) {
+            if (i < width) { return Point{ i, 0 }; }
+            i -= width;
+            if (i < height - 1) { return Point{ width - 1, i + 1 }; }
+            i -= height - 1;
+            if (i < width - 1) { return Point{ width - 2 - i, height - 1 }; }
+            i -= width - 1;
+            return Point{ 0, height - 2 - i };
+        }
+
+        static bool IsEdge(const Point& pt, int width, int height) {
+            return pt.x == 0 || pt.y == 0 || pt.x == width - 1 || pt.y == height - 1;
+        }
+
+        static Point OffGrid(const Point& pt, int height) {
+            if (pt.y == 0) { return Point{ 0, -1 }; }
+            if (pt.y == height - 1) { return Point{ 0, 1 }; }
+            if (pt.x == 0) { return Point{ -1, 0 }; }
+            return Point{ 1, 0 };
+        }
+    };
+}
@@ -5,38 +5,72 @@
 #include "Puzzle.h"
 #include "Connections.h"
 #include "Debug.h"
+#include "Profiler.h"
+#include <cstdint>
+#include <limits>
 #include <vector>
-#include <queue>
 #include <assert.h>
 
 namespace TrainTracks {
 
+    // Storage is one allocation holding, in order, the row and column
+    // constraints and the track placed in each row and column as 16 bit
+    // counts, then a byte per cell: the piece in the low bits and whether
+    // the puzzle fixed it above them. A grid is a little over a byte per
+    // cell, so thousands can be in flight and one fits in L1 while it is
+    // searched.
+    //
+    // Grids can be moved, copied and reset to another puzzle, and reset()
+    // and copyFrom() reuse the storage they have when it is big enough, so
+    // a worker can keep one grid for every puzzle it is given.
     class Grid {
-    private:
-        Grid(int rows, int cols)
-            : _rows(rows)
-            , _cols(cols)
-            , _bottom(_rows - 1)
-            , _right(cols - 1)
-            , _fixedCount(0)
-            , _totalCount(0)
-            , _placedCount(0)
-            , _displayConstraints(false)
-            , _bold(true)
-            , _grid(rows * cols, Piece::Empty)
-            , _rowConstraints(rows, 0)
-            , _colConstraints(cols, 0)
-            , _placedInRow(rows, 0)
-            , _placedInCol(cols, 0)
-        {
-        }
     public:
 
-        Grid(const Puzzle& p)
-            : Grid(p.gridHeight, p.gridWidth)
-        {
-            _rowConstraints = p.data.rowConstraints;
-            _colConstraints = p.data.colConstraints;
+        Grid(const Puzzle& p) {
+            reset(p);
+        }
+
+        Grid(const Grid&) = default;
+        Grid(Grid&&) noexcept = default;
+        Grid& operator=(const Grid&) = default;
+        Grid& operator=(Grid&&) noexcept = default;
+
+        // Starts over on another puzzle, as if constructed from it, keeping
+        // the display settings. If it throws the grid can only be reset
+        // again or assigned to.
+        void reset(const Puzzle& p) {
+            if (p.gridHeight <= 0 || p.gridWidth <= 0 || p.gridHeight > MaxLine || p.gridWidth > MaxLine) {
+                throw std::runtime_error("Invalid grid size");
+            }
+            _rows = p.gridHeight;
+            _cols = p.gridWidth;
+            _bottom = _rows - 1;
+            _right = _cols - 1;
+            _fixedCount = 0;
+            _totalCount = 0;
+            _placedCount = 0;
+            const size_t cells = static_cast<size_t>(_rows) * _cols;
+            _storage.assign(2 * (static_cast<size_t>(_rows) + _cols) + (cells + 1) / 2, 0);
+
+            if (p.data.rowConstraints.size() != static_cast<size_t>(_rows) ||
+                p.data.colConstraints.size() != static_cast<size_t>(_cols)) {
+                throw std::runtime_error("Constraints don't match the grid size");
+            }
+            int cols = 0;
+            for (int r = 0; r < _rows; r++) {
+                if (p.data.rowConstraints[r] < 0 || p.data.rowConstraints[r] > _cols) {
+                    throw std::runtime_error("Row constraint out of range");
+                }
+                rowConstraints()[r] = static_cast<uint16_t>(p.data.rowConstraints[r]);
+                _totalCount += p.data.rowConstraints[r];
+            }
+            for (int c = 0; c < _cols; c++) {
+                if (p.data.colConstraints[c] < 0 || p.data.colConstraints[c] > _rows) {
+                    throw std::runtime_error("Column constraint out of range");
+                }
+                colConstraints()[c] = static_cast<uint16_t>(p.data.colConstraints[c]);
+                cols += p.data.colConstraints[c];
+            }
 
             for (int r = 0; r < _rows; r++)
             {
@@ -46,6 +80,7 @@ namespace TrainTracks {
                     const auto piece = p.data.startingGrid[pt.project(_cols)];
                     if (piece != Piece::Empty) {
                         place(pt, piece);
+                        cellBytes()[flatten(pt)] |= FixedBit;
                         _fixedCount++;
                     }
                 }
@@ -53,14 +88,6 @@ namespace TrainTracks {
 
             extractEntryAndExit();
 
-            for (const auto i : _rowConstraints) {
-                _totalCount += i;
-            }
-            int cols = 0;
-            for (const auto i : _colConstraints) {
-                cols += i;
-            }
-
             if (cols != _totalCount) {
                 throw std::runtime_error("Row and Column constraint missmatch");
             }
@@ -68,6 +95,27 @@ namespace TrainTracks {
             placeObviousPieces();
         }
 
+        // Makes this grid a copy of other, pieces and counts included, for
+        // handing a search to another thread. A flat copy into the storage
+        // already held if it is big enough.
+        void copyFrom(const Grid& other) {
+            if (this == &other) {
+                return;
+            }
+            _rows = other._rows;
+            _cols = other._cols;
+            _bottom = other._bottom;
+            _right = other._right;
+            _fixedCount = other._fixedCount;
+            _totalCount = other._totalCount;
+            _placedCount = other._placedCount;
+            _displayConstraints = other._displayConstraints;
+            _bold = other._bold;
+            _entry = other._entry;
+            _exit = other._exit;
+            _storage.assign(other._storage.cbegin(), other._storage.cend());
+        }
+
         int width() const {
             return _cols;
         }
@@ -76,6 +124,15 @@ namespace TrainTracks {
             return _rows;
         }
 
+        size_t cells() const {
+            return static_cast<size_t>(_rows) * _cols;
+        }
+
+        // Heap memory held by the grid, which is linear in its cell count
+        size_t bytes() const {
+            return _storage.capacity() * sizeof(uint16_t);
+        }
+
         int placed() const {
             return _placedCount;
         }
@@ -106,12 +163,8 @@ namespace TrainTracks {
             return _exit;
         }
         
-        Piece& at(const Point& p) {
-            return _grid[flatten(p)];
-        }
-
         Piece at(const Point& p) const {
-            return _grid[flatten(p)];
+            return static_cast<Piece>(cellBytes()[flatten(p)] & PieceMask);
         }
 
         Piece at(int x, int y) const {
@@ -120,7 +173,7 @@ namespace TrainTracks {
 
         bool isInBounds(const Point& pt) const {
             return pt.x >= 0 &&
-                pt.y >= 0 &
+                pt.y >= 0 &&
                 pt.x < _cols &&
                 pt.y < _rows;
         }
@@ -140,14 +193,20 @@ namespace TrainTracks {
             return !isEmpty(pt);
         }
 
+        // Whether the puzzle gave the piece at pt, rather than it being
+        // deduced or searched for
+        bool isFixed(const Point& pt) const {
+            return (cellBytes()[flatten(pt)] & FixedBit) != 0;
+        }
+
         bool canPlace(const Point& pt, Piece p) const {
             // Must be inbounds
             if (!isInBounds(pt)) { DEBUG_LOG(!isInBounds(pt)); return false; }
             // Must be empty
             if (isFilled(pt)) { DEBUG_LOG(isFilled(pt)); return false; }
             // Must satisfy row counts
-            if (trackInRowCount(pt.y) >= _rowConstraints[pt.y]) { DEBUG_LOG(_rowConstraints[pt.y]); return false; }
-            if (trackInColCount(pt.x) >= _colConstraints[pt.x]) { DEBUG_LOG(_colConstraints[pt.x]); return false; }
+            if (trackInRowCount(pt.y) >= rowConstraint(pt.y)) { DEBUG_LOG(rowConstraint(pt.y)); return false; }
+            if (trackInColCount(pt.x) >= colConstraint(pt.x)) { DEBUG_LOG(colConstraint(pt.x)); return false; }
 
             // Entry/Exit requirements - we can't leave the grid
             switch (p) {
@@ -203,101 +262,98 @@ namespace TrainTracks {
                 if (isEmpty(n)) {
                     const auto rowCount = n.y == pt.y ? newTrackingInRowCount : trackInRowCount(n.y);
                     const auto colCount = n.x == pt.x ? newTrackingInColCount : trackInColCount(n.x);
-                    if (rowCount >= _rowConstraints[n.y] ||
-                        colCount >= _colConstraints[n.x]) {
+                    if (rowCount >= rowConstraint(n.y) ||
+                        colCount >= colConstraint(n.x)) {
                         return false;
                     }
                 }
             }
 
-            DEBUG_LOG(pt, p, trackInRowCount(pt.y), _rowConstraints[pt.y], trackInColCount(pt.x), _colConstraints[pt.x]);
+            DEBUG_LOG(pt, p, trackInRowCount(pt.y), rowConstraint(pt.y), trackInColCount(pt.x), colConstraint(pt.x));
     
             return true;
         }
 
         int trackInRowCount(int r) const {
-            return _placedInRow[r];
+            return rowCounts()[r];
         }
 
         int trackInColCount(int c) const {
-            return _placedInCol[c];
+            return colCounts()[c];
+        }
+
+        int rowConstraint(int r) const {
+            return rowConstraints()[r];
+        }
+
+        int colConstraint(int c) const {
+            return colConstraints()[c];
         }
 
         void place(const Point& pt, Piece p) {
             if (p == Piece::Empty) {
                 throw std::runtime_error("Cannot place empty piece");
             }
-            at(pt) = p;
+            auto& cell = cellBytes()[flatten(pt)];
+            cell = static_cast<uint8_t>((cell & ~PieceMask) | static_cast<uint8_t>(p));
             DEBUG_LOG(pt, p);
-            _placedInCol[pt.x]++;
-            _placedInRow[pt.y]++;
+            colCounts()[pt.x]++;
+            rowCounts()[pt.y]++;
             _placedCount++;
         }
 
         void remove(const Point& pt) {
             if (!isEmpty(pt)) {
-                _placedInCol[pt.x]--;
-                _placedInRow[pt.y]--;
+                colCounts()[pt.x]--;
+                rowCounts()[pt.y]--;
                 _placedCount--;
             }
-            at(pt) = Piece::Empty;
+            cellBytes()[flatten(pt)] = 0;
         }
 
+        // Every piece connects to at most two others, so the pieces joined
+        // to the first one are found by following the track from it both
+        // ways, and they are all the pieces if they number as many as were
+        // placed. Reads the grid only, so it is safe to call from several
+        // threads at once.
         bool isSingleConnectedPath() const {
             Point first;
             if (!findFirst(first)) {
                 return false;
             }
 
-            std::vector<bool> visited(_rows * _cols, false);
-            std::queue<Point> dfs;
-            visited[flatten(first)] = true;
-            dfs.emplace(std::move(first));
-
-            const std::array<Point, 4> dirs{ Point{0, 1}, Point{1, 0}, Point{0, -1}, Point{-1, 0}};
-            while (!dfs.empty()) {
-                const auto pt = dfs.front();
-                dfs.pop();
-                for (const auto& d : dirs) {
-                    auto next = pt + d;
-                    // Check if the neighbor is in bounds and not visited,
-                    // the neighbor connects to the current piece, and the
-                    // current piece connects to the neighbor
-                    if (isInBounds(next) && !isEmpty(next) &&
-                        !visited[flatten(next)])
-                    {
-                        const auto p = at(pt);
-                        const auto n = at(next);
-                        if (Connections::ConnectsTo(p, d) && Connections::ConnectsTo(n, d.inverse())) {
-                            visited[flatten(next)] = true;
-                            dfs.emplace(std::move(next));
-                        }
+            int joined = 1;
+            for (const auto& out : Connections::GetConnections(at(first))) {
+                Point pt = first;
+                Point d = out;
+                while (true) {
+                    const auto next = pt + d;
+                    if (next == first) {
+                        // A loop, every piece on it has been counted
+                        return joined == _placedCount;
                     }
-                }
-            }
-        
-            // Ensure all non-empty cells are visited
-            for (int y = 0; y < _rows; y++) {
-                for (int x = 0; x < _cols; x++) {
-                    const Point p{x, y};
-                    if (!isEmpty(p) && !visited[flatten(p)]) {
-                        return false;
+                    if (!isInBounds(next) || isEmpty(next) ||
+                        !Connections::ConnectsTo(at(next), d.inverse())) {
+                        break;
                     }
+                    joined++;
+                    const auto& conns = Connections::GetConnections(at(next));
+                    d = conns.front() == d.inverse() ? conns.back() : conns.front();
+                    pt = next;
                 }
             }
-
-            return true;
+            return joined == _placedCount;
         }
 
         bool constraintsSatisfied() const {
             for (int r = 0; r < _rows; r++) {
-                if (_placedInRow[r] != _rowConstraints[r]) {
+                if (rowCounts()[r] != rowConstraints()[r]) {
                     return false;
                 }
             }
 
             for(int c = 0; c < _cols; c++) {
-                if (_placedInCol[c] != _colConstraints[c]) {
+                if (colCounts()[c] != colConstraints()[c]) {
                     return false;
                 }
             }
@@ -305,6 +361,7 @@ namespace TrainTracks {
         }
 
         bool isComplete() const {
+            PROFILE_ZONE("verify");
             return isSingleConnectedPath() && constraintsSatisfied();
         }
 
@@ -312,15 +369,15 @@ namespace TrainTracks {
             // Rows
             for (int r = 0; r < _rows; r++)
             {
-                const auto placed = _placedInRow[r];
-                if (placed > _rowConstraints[r])
+                const auto placed = rowCounts()[r];
+                if (placed > rowConstraints()[r])
                     return false;
             }
             // Columns
             for (int c = 0; c < _cols; c++)
             {
-                const auto placed = _placedInCol[c];
-                if (placed > _colConstraints[c])
+                const auto placed = colCounts()[c];
+                if (placed > colConstraints()[c])
                     return false;
             }
             return true;
@@ -339,6 +396,22 @@ namespace TrainTracks {
             return s;
         }
 
+        // The grid as it stands, every piece on it given as fixed
+        Puzzle toPuzzle() const {
+            Puzzle p;
+            p.gridWidth = _cols;
+            p.gridHeight = _rows;
+            p.data.rowConstraints.assign(rowConstraints(), rowConstraints() + _rows);
+            p.data.colConstraints.assign(colConstraints(), colConstraints() + _cols);
+            p.data.startingGrid.reserve(cells());
+            for (int y = 0; y < _rows; y++) {
+                for (int x = 0; x < _cols; x++) {
+                    p.data.startingGrid.push_back(at(x, y));
+                }
+            }
+            return p;
+        }
+
         friend std::ostream& operator<<(std::ostream& os, const Grid& grid);
 
         void displayConstraints(bool v) {
@@ -349,37 +422,82 @@ namespace TrainTracks {
             _bold = v;
         }
 
+        // Row-major cell index
         int64_t flatten(const Point& p) const {
-            return p.y * _rows + p.x;
+            return p.project(_cols);
         }
 
         int fixedCount() const {
             return _fixedCount;
         }
     private:
+        static constexpr int MaxLine = std::numeric_limits<uint16_t>::max();
+        static constexpr uint8_t PieceMask = 0x0F;
+        static constexpr uint8_t FixedBit = 0x10;
+
+        const uint16_t* rowConstraints() const {
+            return _storage.data();
+        }
+
+        uint16_t* rowConstraints() {
+            return _storage.data();
+        }
+
+        const uint16_t* colConstraints() const {
+            return _storage.data() + _rows;
+        }
+
+        uint16_t* colConstraints() {
+            return _storage.data() + _rows;
+        }
+
+        const uint16_t* rowCounts() const {
+            return _storage.data() + _rows + _cols;
+        }
+
+        uint16_t* rowCounts() {
+            return _storage.data() + _rows + _cols;
+        }
+
+        const uint16_t* colCounts() const {
+            return _storage.data() + 2 * _rows + _cols;
+        }
+
+        uint16_t* colCounts() {
+            return _storage.data() + 2 * _rows + _cols;
+        }
+
+        const uint8_t* cellBytes() const {
+            return reinterpret_cast<const uint8_t*>(_storage.data() + 2 * (_rows + _cols));
+        }
+
+        uint8_t* cellBytes() {
+            return reinterpret_cast<uint8_t*>(_storage.data() + 2 * (_rows + _cols));
+        }
 
         struct EdgeConstrains {
             int idx; // the row or column index
             bool isRow; // true if row, false if column
             Point iterator; // iterator to the next row/col
-            std::vector<int>& constraints;
-            std::vector<int>& placed;
+            const uint16_t* constraints;
+            const uint16_t* placed;
         };
 
         struct SingleRowConstraints {
             bool isRow;
             int max;
             Point iterator;
-            std::vector<int>& constraints;
-            std::vector<int>& placed;
+            const uint16_t* constraints;
+            const uint16_t* placed;
         };
         void placeObviousPieces() {
+            PROFILE_ZONE("placeObviousPieces");
 
             std::array<EdgeConstrains, 4> edgeConstraints { {
-                  { 0, true, Point{1, 0}, _rowConstraints, _placedInRow },
-                  { _bottom, true, Point{1, 0}, _rowConstraints, _placedInRow },
-                  { 0, false, Point{0, 1},  _colConstraints, _placedInCol },
-                  {_right, false, Point{0, 1}, _colConstraints, _placedInCol }
+                  { 0, true, Point{1, 0}, rowConstraints(), rowCounts() },
+                  { _bottom, true, Point{1, 0}, rowConstraints(), rowCounts() },
+                  { 0, false, Point{0, 1},  colConstraints(), colCounts() },
+                  {_right, false, Point{0, 1}, colConstraints(), colCounts() }
                 }
             };
 
@@ -411,13 +529,8 @@ namespace TrainTracks {
                             break;
                         }
 
-                        // Find a piece we can place, canPlace will help us
-                        for (const auto p : ValidPieces) {
-                            if (canPlace(placeAt, p)) {
-                                place(placeAt, p);
-                                break;
-                            }
-                        }
+                        // Only if one piece can continue the track there
+                        placeForced(placeAt, pos);
                         break;
                     }
 
@@ -426,8 +539,8 @@ namespace TrainTracks {
             }
 
             std::array<SingleRowConstraints, 2> singleRowConstraints { {
-                  { true, _rows, Point{0, 1}, _rowConstraints, _placedInRow },
-                  { false, _cols, Point{1, 0}, _colConstraints, _placedInCol }
+                  { true, _rows, Point{0, 1}, rowConstraints(), rowCounts() },
+                  { false, _cols, Point{1, 0}, colConstraints(), colCounts() }
                 }
             };
 
@@ -473,16 +586,35 @@ namespace TrainTracks {
                                         break;
                                     }
 
+                                    // The run is certain when the adjacent row/col is the edge, this
+                                    // piece is where the track leaves the grid and our row/col can
+                                    // only hold one piece: once the track turns towards us it can
+                                    // never come back. Otherwise each piece must be the only one
+                                    // which can continue the track, and we stop as soon as the path
+                                    // could take another shape.
+                                    const int adjIdx = src.isRow ? adj.y : adj.x;
+                                    const bool certain = (adjIdx == 0 || adjIdx == (src.isRow ? _bottom : _right)) &&
+                                        getOffCountForPieceAt(pt) == 1 &&
+                                        src.constraints[i] == 1 && src.placed[i] == 0;
+                                    const auto placeNext = [this, certain](const Point& t, const Point& from, Piece piece) {
+                                        if (!certain) {
+                                            return placeForced(t, from, piece);
+                                        }
+                                        if (!canPlace(t, piece)) {
+                                            return false;
+                                        }
+                                        place(t, piece);
+                                        return true;
+                                    };
+
                                     // Now, we step in the direction of the piece, toPlace - 1 places
                                     // and place the horizontal/vertical piece
-                                    for (int j = 1; j < toPlace; j++) {
+                                    bool placed = true;
+                                    for (int j = 1; placed && j < toPlace; j++) {
                                         const Point t{pt + dir * j};
                                         const Piece toPlace = src.isRow ? Piece::Horizontal : Piece::Vertical;
                                         DEBUG_LOG(j, t, toPlace, at(t));
-                                        if (!canPlace(t, toPlace)) {
-                                            break;
-                                        }
-                                        place(t, toPlace);
+                                        placed = placeNext(t, t - dir, toPlace);
                                     }
                                     // Now, place the corner
                                     // we need to know if it is a south or north corner
@@ -492,13 +624,9 @@ namespace TrainTracks {
                                     const auto corner = Connections::GetPiece(exit, entry);
                                     DEBUG_LOG(entry, exit, placeAt, corner);
 
-                                    if(canPlace(placeAt, corner)) {
-                                        place(placeAt, corner);
+                                    if (placed && placeNext(placeAt, placeAt + exit, corner)) {
                                         // Now, place the piece
-                                        placeAt = placeAt + entry;
-                                        if (canPlace(placeAt, src.isRow ? Piece::Vertical : Piece::Horizontal)) {
-                                            place(placeAt, src.isRow ? Piece::Vertical : Piece::Horizontal);
-                                        }
+                                        placeNext(placeAt + entry, placeAt, src.isRow ? Piece::Vertical : Piece::Horizontal);
                                     }
 
                                     break;
@@ -511,6 +639,31 @@ namespace TrainTracks {
             }
         }
 
+        // Places a piece at pt continuing the track from the neighbouring
+        // piece at `from`, but only when exactly one piece fits there (and
+        // it is `expected`, if given). Returns whether it placed anything.
+        bool placeForced(const Point& pt, const Point& from, Piece expected = Piece::Empty) {
+            const auto back = from - pt;
+            if (!isInBounds(from) || !Connections::ConnectsTo(at(from), back.inverse())) {
+                return false;
+            }
+
+            Piece only = Piece::Empty;
+            int count = 0;
+            for (const auto p : ValidPieces) {
+                if (Connections::ConnectsTo(p, back) && canPlace(pt, p)) {
+                    only = p;
+                    count++;
+                }
+            }
+            DEBUG_LOG(pt, from, count, only, expected);
+            if (count != 1 || (expected != Piece::Empty && only != expected)) {
+                return false;
+            }
+            place(pt, only);
+            return true;
+        }
+
         void extractEntryAndExit() {
             std::array<Point, 4>corners = { Point{0, 0}, Point{0, _bottom },
                 Point{_right, 0}, Point{_right, _bottom}};
@@ -591,38 +744,33 @@ namespace TrainTracks {
             return false;
         }
 
-        const int _rows;
-        const int _cols;
-        const int _bottom;
-        const int _right;
-        int _fixedCount;
-        int _totalCount;
-        int _placedCount;
-        bool _displayConstraints;
-        bool _bold;
+        int _rows = 0;
+        int _cols = 0;
+        int _bottom = 0;
+        int _right = 0;
+        int _fixedCount = 0;
+        int _totalCount = 0;
+        int _placedCount = 0;
+        bool _displayConstraints = false;
+        bool _bold = true;
 
         Point _entry;
         Point _exit;
         
-        std::vector<Piece> _grid;
-
-        std::vector<int> _rowConstraints;
-        std::vector<int> _colConstraints;
-
-        std::vector<int> _placedInRow;
-        std::vector<int> _placedInCol;
+        // See the class comment for the layout
+        std::vector<uint16_t> _storage;
     };
 
     inline std::ostream& operator<<(std::ostream& os, const Grid& grid) {
         if (grid._displayConstraints) {
             os << "  ";
             for (int x = 0; x < grid._cols; x++) {
-                os << grid._colConstraints[x] << " ";
+                os << grid.colConstraint(x) << " ";
             }
             os << std::endl;
         }
         for (int y = 0; y < grid._rows; y++) {
-            if (grid._displayConstraints) { os << grid._rowConstraints[y] << " "; }
+            if (grid._displayConstraints) { os << grid.rowConstraint(y) << " "; }
 
             for (int x = 0; x < grid._cols; x++) {
                 Point pt{x, y};
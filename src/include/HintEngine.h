@@ -0,0 +1,238 @@
+#pragma once
+
+#include "Presolver.h"
+#include "Solver.h"
+
+#include <chrono>
+
+namespace TrainTracks {
+
+    // The deduction which forced a hint, cheapest first
+    enum class HintRule {
+        // Line counts with the edge rules: a row or column whose open cells
+        // must all be track (or all empty)
+        Saturation,
+        // Stubs must agree with the neighbouring cells, on top of the above
+        Stubs,
+        // Every other state of the cell contradicts the rules above
+        Lookahead,
+    };
+
+    inline const char* HintRuleName(HintRule r) {
+        switch (r) {
+            case HintRule::Saturation: return "Saturation";
+            case HintRule::Stubs: return "Stubs";
+            case HintRule::Lookahead: return "Lookahead";
+        }
+        return "?";
+    }
+
+    enum class HintStatus {
+        Found,
+        // Nothing is forced that the rules can see
+        None,
+        // The pieces on the grid can't be part of any solution
+        Contradiction,
+        // The budget ran out first
+        TimedOut,
+    };
+
+    inline const char* HintStatusName(HintStatus s) {
+        switch (s) {
+            case HintStatus::Found: return "Found";
+            case HintStatus::None: return "None";
+            case HintStatus::Contradiction: return "Contradiction";
+            case HintStatus::TimedOut: return "TimedOut";
+        }
+        return "?";
+    }
+
+    struct HintOptions {
+        // Time allowed for a hint, checked between lines and between probes
+        std::chrono::nanoseconds budget = std::chrono::milliseconds(5);
+        // Try each state of each open cell if the cheaper rules find nothing
+        bool lookahead = true;
+    };
+
+    struct Hint {
+        HintStatus status = HintStatus::None;
+        Point cell;
+        Piece piece = Piece::Empty;
+        HintRule rule = HintRule::Saturation;
+        // Cell states tried by lookahead
+        uint64_t probes = 0;
+        std::chrono::nanoseconds elapsed{0};
+
+        bool found() const {
+            return status == HintStatus::Found;
+        }
+    };
+
+    // Finds the next piece a partly filled grid forces, for a player asking
+    // for a hint. The pieces already on the grid are taken as given and the
+    // Presolver's rules are run a tier at a time, stopping at the first tier
+    // that forces a piece on an empty cell; the hint is the first such cell
+    // in row-major order. Nothing here searches, so the time taken is
+    // bounded by the rules and the budget, and the grid isn't changed.
+    class HintEngine
+        : private Presolver {
+    public:
+        HintEngine(Grid& grid, const HintOptions& options = HintOptions())
+            : Presolver(grid)
+            , _config(options)
+        { }
+
+        Hint Next() {
+            PROFILE_ZONE("hint");
+            const auto start = SolveClock::now();
+            _deadline = start + _config.budget;
+
+            Hint hint;
+            hint.status = Deduce(hint);
+            hint.elapsed = SolveClock::now() - start;
+            return hint;
+        }
+
+    private:
+        enum class Outcome {
+            Settled,
+            Contradiction,
+            OutOfTime,
+        };
+
+        HintStatus Deduce(Hint& hint) {
+            Init();
+            const std::array<std::pair<HintRule, bool>, 2> tiers{ {
+                { HintRule::Saturation, false },
+                { HintRule::Stubs, true },
+            } };
+            for (const auto& [rule, stubs] : tiers) {
+                const auto outcome = Saturate(stubs);
+                if (outcome != Outcome::Settled) {
+                    return Status(outcome);
+                }
+                if (Forced(hint)) {
+                    hint.rule = rule;
+                    return HintStatus::Found;
+                }
+            }
+            if (!_config.lookahead) {
+                return HintStatus::None;
+            }
+
+            // Rule out each state of each open cell which contradicts the
+            // rules once assumed, then settle what that narrowed. Cells
+            // already known to hold track are tried first, they are where
+            // the track must go next and the likeliest to be forced.
+            for (const bool track : { true, false }) {
+                for (int y = 0; y < _grid.height(); y++) {
+                    for (int x = 0; x < _grid.width(); x++) {
+                        const Point pt{x, y};
+                        const auto d = _domains.at(pt);
+                        if (_grid.isFilled(pt) || IsSingleton(d) || ((d & EmptyDomain) == 0) != track) {
+                            continue;
+                        }
+                        const auto status = Probe(pt, hint);
+                        if (status != HintStatus::None) {
+                            return status;
+                        }
+                    }
+                }
+            }
+            return HintStatus::None;
+        }
+
+        // Assumes each state of the cell in turn, dropping those which
+        // contradict the rules, and settles the rest. None if that forced
+        // nothing.
+        HintStatus Probe(const Point& pt, Hint& hint) {
+            const auto d = _domains.at(pt);
+            const auto saved = _domains;
+            Domain keep = 0;
+            for (Domain bit = 1; bit <= d; bit <<= 1) {
+                if ((d & bit) == 0) {
+                    continue;
+                }
+                hint.probes++;
+                _domains.at(pt) = bit;
+                const auto outcome = Saturate(true);
+                _domains = saved;
+                if (outcome == Outcome::OutOfTime) {
+                    return HintStatus::TimedOut;
+                }
+                if (outcome == Outcome::Settled) {
+                    keep |= bit;
+                }
+            }
+            if (keep == d) {
+                return HintStatus::None;
+            }
+
+            _domains.at(pt) = keep;
+            const auto outcome = keep == 0 ? Outcome::Contradiction : Saturate(true);
+            if (outcome != Outcome::Settled) {
+                return Status(outcome);
+            }
+            if (Forced(hint)) {
+                hint.rule = HintRule::Lookahead;
+                return HintStatus::Found;
+            }
+            return HintStatus::None;
+        }
+
+        // Presolver::Propagate, with the stub rules optional and a deadline
+        Outcome Saturate(bool stubs) {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                if (SolveClock::now() >= _deadline) {
+                    return Outcome::OutOfTime;
+                }
+                for (int r = 0; r < _grid.height(); r++) {
+                    if (!ReduceLine({0, r}, Point::right(), _grid.width(), _grid.rowConstraint(r), changed)) {
+                        return Outcome::Contradiction;
+                    }
+                }
+                for (int c = 0; c < _grid.width(); c++) {
+                    if (!ReduceLine({c, 0}, Point::down(), _grid.height(), _grid.colConstraint(c), changed)) {
+                        return Outcome::Contradiction;
+                    }
+                }
+                if (!stubs) {
+                    continue;
+                }
+                for (int y = 0; y < _grid.height(); y++) {
+                    for (int x = 0; x < _grid.width(); x++) {
+                        if (!ReduceStubs({x, y}, changed)) {
+                            return Outcome::Contradiction;
+                        }
+                    }
+                }
+            }
+            return Outcome::Settled;
+        }
+
+        // The first empty cell narrowed to a single piece
+        bool Forced(Hint& hint) const {
+            for (int y = 0; y < _grid.height(); y++) {
+                for (int x = 0; x < _grid.width(); x++) {
+                    const Point pt{x, y};
+                    const auto p = _domains.known(pt);
+                    if (p != Piece::Empty && _grid.isEmpty(pt)) {
+                        hint.cell = pt;
+                        hint.piece = p;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        static HintStatus Status(Outcome outcome) {
+            return outcome == Outcome::OutOfTime ? HintStatus::TimedOut : HintStatus::Contradiction;
+        }
+
+        const HintOptions _config;
+        SolveClock::time_point _deadline;
+    };
+}
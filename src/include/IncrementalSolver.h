@@ -0,0 +1,306 @@
+#pragma once
+
+#include "Domains.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Solver.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace TrainTracks
+{
+
+    enum class ResolveMethod {
+        // The last solution still satisfies the edited puzzle
+        Kept,
+        // Re-solved around the edits with the rest of the solution held
+        Repaired,
+        // Searched the whole grid
+        Searched,
+    };
+
+    inline const char* ResolveMethodName(ResolveMethod m) {
+        switch (m) {
+            case ResolveMethod::Kept: return "Kept";
+            case ResolveMethod::Repaired: return "Repaired";
+            case ResolveMethod::Searched: return "Searched";
+        }
+        return "?";
+    }
+
+    struct IncrementalOptions {
+        // Cells around an edit freed for the first repair, each failed
+        // repair doubles it until the window covers the grid
+        int radius = 2;
+        // Steps allowed per repair before giving up on it
+        uint64_t repairSteps = 20000;
+    };
+
+    struct IncrementalResult : SolveResult {
+        ResolveMethod method = ResolveMethod::Searched;
+        // Repairs tried, including any that failed
+        int repairs = 0;
+    };
+
+    // Keeps a puzzle and its last solution for editors which change a fixed
+    // piece or a constraint at a time and re-solve after each change. Edits
+    // mark the cells they touch (a whole row or column for a constraint) and
+    // Resolve() then:
+    //  - keeps the last solution if it still fits every fixed piece and
+    //    constraint, which costs one pass over the grid,
+    //  - otherwise repairs it: every cell further than the radius from an
+    //    edit keeps the piece (or emptiness) it had and only the cells near
+    //    the edits are searched, with a step budget, widening the window
+    //    while that fails,
+    //  - and searches the whole grid once the window would cover it.
+    // The solver, and so its scratch arena, is kept between solves.
+    class IncrementalSolver {
+    public:
+        IncrementalSolver(const Puzzle& puzzle, SolverFactory factory = nullptr,
+                const IncrementalOptions& options = IncrementalOptions())
+            : _config(options)
+            , _puzzle(puzzle)
+            , _solver(factory ? factory() : std::make_unique<PathSolver>())
+            , _dirty(puzzle.data.startingGrid.size(), false)
+        {
+            if (options.radius < 1) {
+                throw std::runtime_error("Repair radius must be positive");
+            }
+        }
+
+        const Puzzle& puzzle() const {
+            return _puzzle;
+        }
+
+        // Row-major cells of the last solution found, empty if there is
+        // none. Edits since then may have made it out of date.
+        const std::vector<Piece>& solution() const {
+            return _solution;
+        }
+
+        // Fixes p at pt, or frees the cell if p is Empty
+        void Fix(const Point& pt, Piece p) {
+            if (pt.x < 0 || pt.y < 0 || pt.x >= _puzzle.gridWidth || pt.y >= _puzzle.gridHeight) {
+                throw std::runtime_error("Fixed piece outside the grid");
+            }
+            auto& cell = _puzzle.data.startingGrid[pt.project(_puzzle.gridWidth)];
+            if (cell != p) {
+                cell = p;
+                _dirty[pt.project(_puzzle.gridWidth)] = true;
+            }
+        }
+
+        // Constraint edits only take effect together, at the next Resolve,
+        // so a row and column can be changed to keep the totals equal
+        void RowConstraint(int row, int count) {
+            if (_puzzle.data.rowConstraints.at(row) != count) {
+                _puzzle.data.rowConstraints[row] = count;
+                for (int x = 0; x < _puzzle.gridWidth; x++) {
+                    _dirty[Point{x, row}.project(_puzzle.gridWidth)] = true;
+                }
+            }
+        }
+
+        void ColConstraint(int col, int count) {
+            if (_puzzle.data.colConstraints.at(col) != count) {
+                _puzzle.data.colConstraints[col] = count;
+                for (int y = 0; y < _puzzle.gridHeight; y++) {
+                    _dirty[Point{col, y}.project(_puzzle.gridWidth)] = true;
+                }
+            }
+        }
+
+        // Replaces the puzzle with an edited copy, marking whatever differs.
+        // A puzzle of another size starts over.
+        void Edit(const Puzzle& edited) {
+            if (edited.gridWidth != _puzzle.gridWidth || edited.gridHeight != _puzzle.gridHeight) {
+                _puzzle = edited;
+                _solution.clear();
+                _dirty.assign(edited.data.startingGrid.size(), true);
+                return;
+            }
+            for (int y = 0; y < _puzzle.gridHeight; y++) {
+                for (int x = 0; x < _puzzle.gridWidth; x++) {
+                    Fix(Point{x, y}, edited.data.startingGrid[Point{x, y}.project(_puzzle.gridWidth)]);
+                }
+                RowConstraint(y, edited.data.rowConstraints[y]);
+            }
+            for (int x = 0; x < _puzzle.gridWidth; x++) {
+                ColConstraint(x, edited.data.colConstraints[x]);
+            }
+        }
+
+        // Solves the puzzle as edited since the last call. Throws, leaving
+        // the edits pending, if they make the puzzle invalid.
+        IncrementalResult Resolve(const SolveOptions& options = SolveOptions()) {
+            const auto start = SolveClock::now();
+            // Checks the edited puzzle is well formed before anything else
+            const Grid edited(_puzzle);
+
+            IncrementalResult result;
+            if (!_solution.empty() && Holds()) {
+                result.status = SolveStatus::Solved;
+                result.method = ResolveMethod::Kept;
+                _dirty.assign(_dirty.size(), false);
+                Finish(result, start);
+                return result;
+            }
+
+            SolveOptions limits = options;
+            if (options.timeout.count() > 0 && start + options.timeout < limits.deadline) {
+                limits.deadline = start + options.timeout;
+            }
+            limits.timeout = std::chrono::nanoseconds(0);
+            uint64_t budget = options.maxSteps;
+
+            if (!_solution.empty()) {
+                for (int radius = _config.radius; ; radius *= 2) {
+                    CellDomains domains(_puzzle.gridWidth, _puzzle.gridHeight);
+                    Puzzle held = _puzzle;
+                    if (!Window(radius, held, domains)) {
+                        break;
+                    }
+
+                    SolveOptions repair = limits;
+                    repair.maxSteps = budget == 0 ? _config.repairSteps : std::min(budget, _config.repairSteps);
+                    result.repairs++;
+                    SolveResult attempt;
+                    try {
+                        Grid grid(held);
+                        _solver->Domains(&domains);
+                        attempt = _solver->Solve(grid, repair);
+                        _solver->Domains(nullptr);
+                        if (attempt.solved()) {
+                            Keep(grid);
+                        }
+                    } catch (const std::runtime_error&) {
+                        // The held cells contradict the edits, say by adding
+                        // a third way off the grid
+                        _solver->Domains(nullptr);
+                    }
+                    result.steps += attempt.steps;
+                    result.peakBytes = std::max(result.peakBytes, attempt.peakBytes);
+                    if (budget != 0) {
+                        budget -= std::min(budget, attempt.steps);
+                    }
+
+                    if (attempt.solved()) {
+                        result.status = SolveStatus::Solved;
+                        result.method = ResolveMethod::Repaired;
+                        Finish(result, start);
+                        return result;
+                    }
+                    if (attempt.status == SolveStatus::Cancelled || SolveClock::now() >= limits.deadline ||
+                            (options.maxSteps != 0 && budget == 0)) {
+                        result.status = attempt.status == SolveStatus::Cancelled ?
+                            SolveStatus::Cancelled : SolveStatus::TimedOut;
+                        Finish(result, start);
+                        return result;
+                    }
+                }
+            }
+
+            Grid grid(_puzzle);
+            limits.maxSteps = budget;
+            const auto search = _solver->Solve(grid, limits);
+            result.status = search.status;
+            result.method = ResolveMethod::Searched;
+            result.steps += search.steps;
+            result.peakBytes = std::max(result.peakBytes, search.peakBytes);
+            if (search.solved()) {
+                Keep(grid);
+            } else if (search.status == SolveStatus::Unsolvable) {
+                _solution.clear();
+                _dirty.assign(_dirty.size(), false);
+            }
+            Finish(result, start);
+            return result;
+        }
+
+    private:
+        // Whether the last solution fits the edited fixed pieces and
+        // constraints. It was one path between two ways off the grid, which
+        // the edits can't change.
+        bool Holds() const {
+            const auto width = _puzzle.gridWidth;
+            std::vector<int> rows(_puzzle.gridHeight, 0);
+            std::vector<int> cols(width, 0);
+            for (size_t i = 0; i < _solution.size(); i++) {
+                const auto fixed = _puzzle.data.startingGrid[i];
+                if (fixed != Piece::Empty && fixed != _solution[i]) {
+                    return false;
+                }
+                if (_solution[i] != Piece::Empty) {
+                    rows[i / width]++;
+                    cols[i % width]++;
+                }
+            }
+            return rows == _puzzle.data.rowConstraints && cols == _puzzle.data.colConstraints;
+        }
+
+        // Holds every cell further than radius from an edit to what the last
+        // solution had there, as a fixed piece or by allowing only Empty.
+        // Returns false if the window covers the whole grid.
+        bool Window(int radius, Puzzle& held, CellDomains& domains) const {
+            const auto width = _puzzle.gridWidth;
+            const auto height = _puzzle.gridHeight;
+            std::vector<bool> free(_dirty.size(), false);
+            bool all = true;
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    if (!_dirty[Point{x, y}.project(width)]) {
+                        continue;
+                    }
+                    for (int ny = std::max(0, y - radius); ny <= std::min(height - 1, y + radius); ny++) {
+                        for (int nx = std::max(0, x - radius); nx <= std::min(width - 1, x + radius); nx++) {
+                            free[Point{nx, ny}.project(width)] = true;
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < free.size(); i++) {
+                if (free[i]) {
+                    continue;
+                }
+                all = false;
+                const Point pt{ static_cast<int>(i % width), static_cast<int>(i / width) };
+                if (_solution[i] == Piece::Empty) {
+                    domains.at(pt) = EmptyDomain;
+                } else {
+                    held.data.startingGrid[i] = _solution[i];
+                    domains.at(pt) = DomainBit(_solution[i]);
+                }
+            }
+            return !all;
+        }
+
+        void Keep(const Grid& grid) {
+            _solution.resize(grid.cells());
+            for (int y = 0; y < grid.height(); y++) {
+                for (int x = 0; x < grid.width(); x++) {
+                    _solution[Point{x, y}.project(grid.width())] = grid.at(x, y);
+                }
+            }
+            _dirty.assign(_dirty.size(), false);
+        }
+
+        void Finish(IncrementalResult& result, SolveClock::time_point start) const {
+            result.elapsed = SolveClock::now() - start;
+            if (result.solved()) {
+                result.solution = _solution;
+            }
+        }
+
+        const IncrementalOptions _config;
+        Puzzle _puzzle;
+        std::unique_ptr<Solver> _solver;
+        // The cells edited since the last solution
+        std::vector<bool> _dirty;
+        std::vector<Piece> _solution;
+    };
+} // namespace TrainTracks
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "Grid.h"
+#include "Solver.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TrainTracks {
+
+    struct LiveRendererOptions {
+        // Frames drawn per second by the render thread, 0 for no thread (call
+        // Tick() to draw)
+        int fps = 20;
+        // Solver steps between checks for a pending frame
+        uint64_t interval = 256;
+        // Terminal row and column of the grid's top left cell, 1-based
+        int top = 1;
+        int left = 1;
+        // Clear the screen before the first frame
+        bool clear = true;
+    };
+
+    // Draws a solve as it runs without slowing it down. The solver thread
+    // only copies the grid when the render thread has asked for a frame, and
+    // the render thread draws only the cells which changed since the last
+    // frame, with cursor positioning, in one write.
+    //
+    // The grid is handed over without locks: the render thread asks for a
+    // frame (Wanted), the next Report() copies the grid and marks it Ready,
+    // and the render thread draws it and asks again. Each side only touches
+    // the snapshot in its own state.
+    class LiveRenderer
+        : public ProgressReporter {
+
+    public:
+        LiveRenderer(const Grid& grid, std::ostream& out = std::cout,
+            const LiveRendererOptions& options = LiveRendererOptions())
+            : ProgressReporter(options.interval)
+            , _grid(grid)
+            , _out(out)
+            , _options(options)
+            , _state(Wanted)
+            , _steps(0)
+            , _snapshot(grid.cells(), Piece::Empty)
+            , _shown(grid.cells(), Unknown)
+            , _frames(0)
+            , _lastBytes(0)
+            , _lastSteps(0)
+            , _lastFrame(std::chrono::steady_clock::now())
+            , _stop(false)
+        {
+            _buffer.reserve(grid.cells() * 8 + 128);
+            if (options.fps > 0) {
+                _thread = std::thread([this] { Run(); });
+            }
+        }
+
+        ~LiveRenderer() {
+            Stop();
+        }
+
+        // Called by the solver. Costs one atomic load unless a frame is due.
+        void Report(uint64_t steps, const Point& pos) override {
+            if (_state.load(std::memory_order_acquire) != Wanted) {
+                return;
+            }
+            Capture(steps, pos);
+            _state.store(Ready, std::memory_order_release);
+        }
+
+        // Draws the latest snapshot if there is a new one, and asks for the
+        // next. Returns whether it drew anything.
+        bool Tick() {
+            if (_state.load(std::memory_order_acquire) != Ready) {
+                return false;
+            }
+            Draw();
+            _state.store(Wanted, std::memory_order_release);
+            return true;
+        }
+
+        // Stops the render thread and draws the grid as it is now, so only
+        // call this once the solver has stopped. Leaves the cursor below the
+        // grid.
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_stop) {
+                    return;
+                }
+                _stop = true;
+            }
+            _wake.notify_all();
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+            Capture(_steps, _pos);
+            Draw();
+            _out << '\n';
+            _out.flush();
+        }
+
+        uint64_t Frames() const {
+            return _frames;
+        }
+
+        // Bytes written by the last frame
+        size_t LastFrameBytes() const {
+            return _lastBytes;
+        }
+
+    private:
+        enum State { Wanted, Ready };
+        static constexpr Piece Unknown = static_cast<Piece>(0xFF);
+
+        void Run() {
+            const auto period = std::chrono::microseconds(1000000 / _options.fps);
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stop) {
+                _wake.wait_for(lock, period, [this] { return _stop; });
+                if (!_stop) {
+                    Tick();
+                }
+            }
+        }
+
+        void Capture(uint64_t steps, const Point& pos) {
+            for (int y = 0; y < _grid.height(); y++) {
+                for (int x = 0; x < _grid.width(); x++) {
+                    _snapshot[static_cast<size_t>(y) * _grid.width() + x] = _grid.at(x, y);
+                }
+            }
+            _steps = steps;
+            _pos = pos;
+        }
+
+        void Draw() {
+            _buffer.clear();
+            if (_frames == 0 && _options.clear) {
+                _buffer.append("\033[2J");
+            }
+
+            const auto width = _grid.width();
+            for (int y = 0; y < _grid.height(); y++) {
+                // One cursor move per run of changed cells
+                bool positioned = false;
+                for (int x = 0; x < width; x++) {
+                    const auto idx = static_cast<size_t>(y) * width + x;
+                    const auto piece = _snapshot[idx];
+                    if (piece == _shown[idx]) {
+                        positioned = false;
+                        continue;
+                    }
+                    if (!positioned) {
+                        MoveTo(_options.top + y, _options.left + x);
+                        positioned = true;
+                    }
+                    const Point pt{x, y};
+                    const bool end = pt == _grid.entry() || pt == _grid.exit();
+                    if (end) { _buffer.append("\033[1m"); }
+                    _buffer.append(PieceSymbol(piece));
+                    if (end) { _buffer.append("\033[0m"); }
+                    _shown[idx] = piece;
+                }
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            const auto seconds = std::chrono::duration<double>(now - _lastFrame).count();
+            const auto rate = seconds > 0 ? (_steps - _lastSteps) / seconds : 0.0;
+            _lastFrame = now;
+            _lastSteps = _steps;
+
+            MoveTo(_options.top + _grid.height() + 1, _options.left);
+            _buffer.append("\033[KSteps: ").append(std::to_string(_steps));
+            _buffer.append("  Current: {").append(std::to_string(_pos.x)).append(1, ',');
+            _buffer.append(std::to_string(_pos.y)).append("}  ");
+            _buffer.append(std::to_string(static_cast<uint64_t>(rate))).append(" steps/s");
+
+            _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _out.flush();
+            _lastBytes = _buffer.size();
+            _frames++;
+        }
+
+        void MoveTo(int row, int col) {
+            _buffer.append("\033[").append(std::to_string(row)).append(1, ';');
+            _buffer.append(std::to_string(col)).append(1, 'H');
+        }
+
+        const Grid& _grid;
+        std::ostream& _out;
+        const LiveRendererOptions _options;
+
+        std::atomic<int> _state;
+        // Written by Capture() while Wanted, read by Draw() while Ready
+        uint64_t _steps;
+        Point _pos;
+        std::vector<Piece> _snapshot;
+
+        // Render thread only
+        std::vector<Piece> _shown;
+        std::string _buffer;
+        uint64_t _frames;
+        size_t _lastBytes;
+        uint64_t _lastSteps;
+        std::chrono::steady_clock::time_point _lastFrame;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _stop;
+        std::thread _thread;
+    };
+}
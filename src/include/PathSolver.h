@@ -2,40 +2,278 @@
 
 #include "Solver.h"
 #include <algorithm>
+#include <array>
 #include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include "Debug.h"
 
 namespace TrainTracks
 {
-    
+
+    struct PathSolverOptions {
+        // Build the path from the exit back to the entry instead
+        bool fromExit = false;
+        // Order candidate pieces are tried in at each cell
+        std::array<Piece, 6> order{ Piece::CornerNW, Piece::CornerSW,
+            Piece::CornerSE, Piece::CornerNE, Piece::Vertical, Piece::Horizontal };
+        // Non-zero shuffles the candidates at every cell, seeded with this
+        uint64_t seed = 0;
+        // Prune heads cut off from a fixed piece or short of room, see Cut()
+        bool cuts = true;
+        // Go straight back to the latest decision a dead end depends on,
+        // see DeadEnd()
+        bool backjumps = true;
+        // Log2 of the most failed states remembered per solve, 0 to remember
+        // none. Cuts catch most of what these would, so they're off unless
+        // asked for.
+        int nogoodBits = 0;
+    };
+
+    struct PathSolverStats {
+        // Heads pruned by Cut()
+        uint64_t cuts = 0;
+        // Dead ends that sent the search back past the cell before them
+        uint64_t backjumps = 0;
+        // Failed states recorded, and revisits of one pruned by them
+        uint64_t nogoods = 0;
+        uint64_t nogoodHits = 0;
+    };
+
+    // A subtree of the search left for later, see PathSolver::Split: the
+    // pieces on the path from the start up to the head still to search
+    struct PathPrefix {
+        std::vector<std::pair<Point, Piece>> path;
+        // Steps the split had taken when it reached the head
+        uint64_t steps = 0;
+    };
+
+    // The search stack at one moment, see PathSolver::Checkpoints. Each
+    // level is a cell on the path from the start, the pieces to try there
+    // in the order they're tried and which of them is being tried; at the
+    // deepest level that piece is about to be tried.
+    struct PathCheckpoint {
+        struct Level {
+            Point cell;
+            uint8_t count = 0;
+            uint8_t choice = 0;
+            std::array<Piece, 6> candidates{};
+        };
+
+        // The options and grid the search started with
+        bool fromExit = false;
+        uint64_t seed = 0;
+        std::array<Piece, 6> order{};
+        uint64_t fingerprint = 0;
+        // Shuffle state at the deepest level, and steps taken since the
+        // first run started
+        uint64_t random = 0;
+        uint64_t steps = 0;
+        std::vector<Level> levels;
+        // Track per row and column with the deepest level's piece off
+        std::vector<uint16_t> rowCounts;
+        std::vector<uint16_t> colCounts;
+    };
+
+    using CheckpointSink = std::function<void(const PathCheckpoint&)>;
+
+    // Searches for the path cell by cell from the entry. Two things stop it
+    // exploring branches which are already lost:
+    //  - Cuts: the cells the path can still use (off it, and filled or in a
+    //    row and column with room left) no longer connect the head to every
+    //    fixed piece, or hold too few cells to fill some row or column.
+    //    That only gets worse as the path grows, so the branch is dropped
+    //    as soon as the decision causing it is made rather than searched
+    //    out one frame at a time.
+    //  - Backjumps: most dead ends depend on where the head is, so on the
+    //    decision just before them. A fixed piece whose track has to run
+    //    through a cell which can no longer take any doesn't: that follows
+    //    from the path's cells in the rows, columns and neighbours around
+    //    it. Cuts miss it, since they don't look at which way a fixed piece
+    //    points, so it's found at a dead end further on and the search goes
+    //    straight back to the latest decision it depends on.
+    //  - Nogoods: a failed branch depends only on which cells are on the
+    //    path, where its head is and which way it came in, so those are
+    //    hashed and the same state reached in a different order is skipped.
+    //    The table is lossy and keys are 64 bit Zobrist hashes.
     class PathSolver
         : public Solver {
 
     public:
-        PathSolver()
+        PathSolver(const PathSolverOptions& options = PathSolverOptions())
             : Solver()
+            , _config(options)
+            , _random(options.seed)
         { }
 
-        bool Solve(Grid& grid) {
-            const auto fps = grid.fixedPoints();
-            std::for_each(fps.cbegin(), fps.cend(), [&](const Point& fp) {
-                _fixedPoints.emplace(fp);
-            });
+        using Solver::Solve;
+
+        // Searches only as far as depth cells along the path, adding the
+        // head of each branch still open there to frontier in the order the
+        // search would have tried them. Between them the prefixes cover
+        // what's left of the search, so the puzzle is unsolvable if every
+        // one of them is. Solved if the path was completed before depth.
+        SolveResult Split(Grid& grid, int depth, std::vector<PathPrefix>& frontier,
+            const SolveOptions& options = SolveOptions()) {
+            if (depth < 1) {
+                throw std::runtime_error("Split depth must be at least 1");
+            }
+            _frontier = &frontier;
+            _frontierDepth = depth;
+            _frontierStart = Steps();
+            try {
+                const auto result = Solve(grid, options);
+                _frontier = nullptr;
+                return result;
+            } catch (...) {
+                _frontier = nullptr;
+                throw;
+            }
+        }
+
+        // Hands the search stack to sink every interval while solving, and
+        // once more if the solve is interrupted, so a long search can be
+        // carried on later with Resume. The clock is only read every few
+        // thousand steps and a checkpoint copies just the stack, so this
+        // costs next to nothing between them. nullptr to stop.
+        void Checkpoints(CheckpointSink sink, std::chrono::nanoseconds interval) {
+            _sink = std::move(sink);
+            _checkpointEvery = interval;
+        }
+
+        // Carries on the search a checkpoint was taken from, on the same
+        // puzzle with the same options, trying everything in the order it
+        // would have. Nogoods aren't saved, so it may repeat work they would
+        // have skipped. Throws if the checkpoint doesn't fit.
+        SolveResult Resume(Grid& grid, const PathCheckpoint& checkpoint, const SolveOptions& options = SolveOptions()) {
+            _restart = &checkpoint;
+            _replayFailed = false;
+            try {
+                const auto result = Solve(grid, options);
+                _restart = nullptr;
+                _replay = nullptr;
+                if (_replayFailed) {
+                    throw std::runtime_error("Checkpoint doesn't match the search");
+                }
+                return result;
+            } catch (...) {
+                _restart = nullptr;
+                _replay = nullptr;
+                throw;
+            }
+        }
+
+        // Searches the subtree below a prefix from Split on the same
+        // puzzle, with the same fromExit setting
+        SolveResult Resume(Grid& grid, const PathPrefix& prefix, const SolveOptions& options = SolveOptions()) {
+            _resume = &prefix;
+            try {
+                const auto result = Solve(grid, options);
+                _resume = nullptr;
+                return result;
+            } catch (...) {
+                _resume = nullptr;
+                throw;
+            }
+        }
+
+        bool Solve(Grid& grid) override {
+            const auto cells = static_cast<int>(grid.cells());
+            _arena.Reset();
+            _width = grid.width();
+            _depth = _arena.Allocate<int>(cells, -1);
+            _fixed = _arena.Allocate<bool>(cells, false);
+            _fixedCount = 0;
+            for (int idx = 0; idx < cells; idx++) {
+                if (!grid.isEmpty(toPoint(idx))) {
+                    _fixed[idx] = true;
+                    _fixedCount++;
+                }
+            }
+            // Each empty cell a fixed piece's track runs into
+            _stubs = _arena.Allocate<int>(static_cast<size_t>(_fixedCount) * 4);
+            _stubCount = 0;
+            for (int idx = 0; idx < cells; idx++) {
+                if (!_fixed[idx]) { continue; }
+                for (const auto& d : Connections::GetConnections(grid.at(toPoint(idx)))) {
+                    const auto s = toPoint(idx) + d;
+                    if (grid.isInBounds(s) && grid.isEmpty(s)) {
+                        _stubs[_stubCount++] = idx;
+                        _stubs[_stubCount++] = toIndex(s);
+                    }
+                }
+            }
+            _trail = _arena.Allocate<Point>(cells + 1);
+            _mark = _arena.Allocate<uint32_t>(cells, 0);
+            _epoch = 0;
+            _stack = _arena.Allocate<int>(cells);
+            _rowRoom = _arena.Allocate<int>(grid.height());
+            _colRoom = _arena.Allocate<int>(grid.width());
+            _candidates = _arena.Allocate<Piece>(static_cast<size_t>(cells + 1) * 6);
+            _candidateCount = _arena.Allocate<uint8_t>(cells + 1);
+            _choice = _arena.Allocate<uint8_t>(cells + 1);
+            _stats = PathSolverStats();
+
+            // Sized to the grid so small puzzles don't pay for a big table
+            _nogoodMask = 0;
+            _nogoods = nullptr;
+            _hash = 0;
+            if (_config.nogoodBits > 0) {
+                size_t size = 1024;
+                while (size < static_cast<size_t>(cells) * 1024 && size < (size_t(1) << _config.nogoodBits)) {
+                    size <<= 1;
+                }
+                _nogoodMask = size - 1;
+                _nogoods = _arena.Allocate<uint64_t>(size, 0);
+                _zobrist = _arena.Allocate<uint64_t>(cells);
+                uint64_t state = 0;
+                for (int idx = 0; idx < cells; idx++) {
+                    _zobrist[idx] = Mix(state);
+                }
+            }
 
-            const auto& entry = grid.entry();
-            std::vector<bool> visited(grid.width() * grid.height(), false);
+            const auto& entry = _config.fromExit ? grid.exit() : grid.entry();
+            _goal = _config.fromExit ? grid.entry() : grid.exit();
+            _random = _config.seed;
             int visited_count = 0;
             int hit = 0;
 
-            DEBUG_LOG(entry, grid.at(entry), grid.exit(), grid.target(), grid.placed());
+            DEBUG_LOG(entry, grid.at(entry), _goal, grid.target(), grid.placed());
             
-            return TryBuild(grid, entry, getEntryIncoming(grid), visited, visited_count, hit);
+            _checkpointDue = false;
+            _interruptSaved = false;
+            _stepOffset = -Steps();
+            _fingerprint = _sink || _restart ? Fingerprint(grid) : 0;
+            _nextCheckpoint = SolveClock::now() + _checkpointEvery;
+            if (_restart) {
+                CheckCheckpoint(grid, entry, *_restart);
+                _random = _restart->random;
+                _stepOffset += _restart->steps;
+                _replay = _restart;
+                _replayDepth = 0;
+            }
+
+            if (_resume) {
+                return ResumeFrom(grid, entry, *_resume);
+            }
+            return TryBuild(grid, entry, getIncoming(grid, entry), visited_count, hit) == Completed;
+        }
+
+        // Search statistics for the last solve
+        const PathSolverStats& Stats() const {
+            return _stats;
         }
 
     protected:
         Point getEntryIncoming(const Grid& grid) const {
-            const auto entry = grid.entry();
+            return getIncoming(grid, grid.entry());
+        }
+
+        // The direction the track comes onto the grid at an entry or exit
+        Point getIncoming(const Grid& grid, const Point& entry) const {
             for (const auto& d : Connections::GetConnections(grid.at(entry))) {
                 const auto n = entry + d;
                 if (!grid.isInBounds(n)) {
@@ -45,93 +283,628 @@ namespace TrainTracks
             }
             throw std::runtime_error("Invalid entry, no incoming direction!");
         }
-        bool TryBuild(Grid& grid, const Point& pos, const Point& incoming, std::vector<bool>& visited, int& visited_count, int hit) {
+        // What TryBuild returns once the path is complete. Otherwise it
+        // returns the depth of the latest decision its failure depends on,
+        // and every frame deeper than that gives up without trying the rest
+        // of its pieces.
+        static constexpr int Completed = std::numeric_limits<int>::max();
+
+        int TryBuild(Grid& grid, const Point& pos, const Point& incoming, int& visited_count, int hit) {
+            const int depth = visited_count;
             Step(pos);
-            const auto idx = grid.flatten(pos);
+            if (Interrupted()) {
+                return depth - 1;
+            }
+            if (_sink && (Steps() & CheckpointPoll) == 0 && SolveClock::now() >= _nextCheckpoint) {
+                _checkpointDue = true;
+            }
 
             // Bounds
             if (!grid.isInBounds(pos)) {
                 DEBUG_LOG(pos, !grid.isInBounds(pos));
-                return false;
+                return DeadEnd(grid, depth);
             }
+            const auto idx = toIndex(pos);
 
             // revist check
-            if (visited[idx]) {
-                DEBUG_LOG(pos, visited[idx]);
-                return false;
+            if (_depth[idx] >= 0) {
+                DEBUG_LOG(pos, _depth[idx]);
+                return DeadEnd(grid, depth);
             }
 
             // Can't exceed total count
             if (visited_count > grid.target()) {
                 DEBUG_LOG(visited_count, grid.target());
-                return false;
+                return DeadEnd(grid, depth);
             }
 
             // Check existing piece
             const auto existing = grid.at(pos);
             // if its a fixed piece, does it match the incoming?
-            std::list<Piece> candidates;
+            Piece* const candidates = _candidates + static_cast<size_t>(visited_count) * 6;
+            int count = 0;
             bool isFixed = false;
             if (existing != Piece::Empty) {
                 if (!Connections::ConnectsTo(existing, incoming.inverse())) {
                     DEBUG_LOG(existing, !Connections::ConnectsTo(existing, incoming.inverse()));
-                    return false;
+                    return DeadEnd(grid, depth);
                 }
 
                 // if we reached the exit, check for completion
-                if (pos == grid.exit()) {
-                    DEBUG_LOG(hit, _fixedPoints.size());
-                    return grid.isComplete();
+                if (pos == _goal) {
+                    DEBUG_LOG(hit, _fixedCount);
+                    return grid.isComplete() ? Completed : DeadEnd(grid, depth);
                 }
 
-                candidates.push_back(existing);
+                candidates[count++] = existing;
+
+                isFixed = _fixed[idx];
+            }
 
-                isFixed = _fixedPoints.find(pos) != _fixedPoints.end();
-                hit += isFixed;
+            _trail[depth] = pos;
+            const auto key = _nogoods ? Key(idx, incoming) : 0;
+            if (_nogoods && _nogoods[key & _nogoodMask] == key) {
+                _stats.nogoodHits++;
+                Pruned(pos);
+                return DeadEnd(grid, depth);
             }
-            visited[idx] = true;
+            if (_config.cuts && MayCut(grid, depth) && Cut(grid, depth, hit)) {
+                _stats.cuts++;
+                Pruned(pos);
+                Remember(key);
+                return DeadEnd(grid, depth);
+            }
+
+            if (_frontier && depth == _frontierDepth) {
+                PathPrefix prefix;
+                prefix.path.reserve(depth);
+                for (int i = 0; i < depth; i++) {
+                    prefix.path.emplace_back(_trail[i], grid.at(_trail[i]));
+                }
+                prefix.steps = Steps() - _frontierStart;
+                _frontier->push_back(std::move(prefix));
+                return depth - 1;
+            }
+
+            hit += isFixed;
+            _depth[idx] = depth;
+            _hash ^= _nogoods ? _zobrist[idx] : 0;
             visited_count++;
 
-            if (candidates.empty()) {
-                std::for_each(ValidPieces.crbegin(), ValidPieces.crend(), [&grid, &candidates, &pos](const Piece& p){
-                    if (grid.canPlace(pos, p)) {
+            int first = 0;
+            if (_replay && static_cast<size_t>(depth) == _replayDepth) {
+                // Pick up where the checkpoint left off
+                const auto& level = _replay->levels[depth];
+                std::copy(level.candidates.begin(), level.candidates.begin() + level.count, candidates);
+                count = level.count;
+                first = level.choice;
+                if (++_replayDepth == _replay->levels.size()) {
+                    _replay = nullptr;
+                    _replayFailed = !SameCounts(grid, *_restart);
+                }
+            } else if (count == 0) {
+                std::for_each(_config.order.cbegin(), _config.order.cend(), [this, &grid, &candidates, &count, &pos](const Piece& p){
+                    if (Allowed(pos, p) && grid.canPlace(pos, p)) {
                         DEBUG_LOG(pos, p, grid.canPlace(pos, p));
-                        candidates.push_back(p);
+                        candidates[count++] = p;
                     }
                 });
+                if (_config.seed != 0) {
+                    for (int i = count - 1; i > 0; i--) {
+                        std::swap(candidates[i], candidates[Next() % (i + 1)]);
+                    }
+                }
             }
 
-            for (const auto piece : candidates) {
+            // Where to go back to once this cell is off the path: the
+            // decision before it, unless a dead end below didn't depend on
+            // anything since an earlier one
+            int back = depth - 1;
+            _candidateCount[depth] = static_cast<uint8_t>(count);
+            for (int i = first; i < count && !_replayFailed; i++) {
+                _choice[depth] = static_cast<uint8_t>(i);
+                const auto random = _random;
+                if (_checkpointDue) {
+                    Save(grid, depth, random);
+                }
+                const auto piece = candidates[i];
                 bool placed = false;
                 if (existing == Piece::Empty) {
                     grid.place(pos, piece);
                     placed = true;
                 }
                 DEBUG_LOG(pos, placed, grid.at(pos));
+                Tried(pos, piece);
                 // Find each outgoing direction, there should only be one, but we could add other pieces
                 // later!
+                int below = -1;
                 for (const auto& d : Connections::GetConnections(piece)) {
                     if (d == incoming.inverse()) {
                         continue;
                     }
                     const auto next = pos + d;
-                    if (TryBuild(grid, next, d, visited, visited_count, hit)) {
-                        return true;
+                    below = std::max(below, TryBuild(grid, next, d, visited_count, hit));
+                    if (below == Completed) {
+                        return Completed;
                     }
                 }
+                Failed(pos, piece);
 
                 if (placed) {
                     grid.remove(pos);
                 }
+                // The replay must go all the way down the checkpoint's path
+                if (_replay && _replayDepth == static_cast<size_t>(depth) + 1 && !Interrupted()) {
+                    _replayFailed = true;
+                    _replay = nullptr;
+                }
+                if (Interrupted()) {
+                    // Save from the deepest level, with this piece to try again
+                    if (_sink && !_interruptSaved && !_replayFailed) {
+                        _interruptSaved = true;
+                        Save(grid, depth, random);
+                    }
+                    break;
+                }
+                // What failed below didn't depend on this piece, so the
+                // rest would fail the same way
+                if (below < depth) {
+                    back = below;
+                    break;
+                }
             }
-            DEBUG_LOG(pos, candidates.size(), visited_count, hit);
-            visited[idx] = false;
+            DEBUG_LOG(pos, count, visited_count, hit);
+            _depth[idx] = -1;
+            _hash ^= _nogoods ? _zobrist[idx] : 0;
             visited_count--;
             hit -= isFixed;
 
+            if (!Interrupted()) {
+                Remember(key);
+            }
+            if (count == 0) {
+                return DeadEnd(grid, depth);
+            }
+            return back;
+        }
+
+        // Lays the prefix's pieces on the grid and carries on from its head,
+        // taking them off again unless that solves it
+        bool ResumeFrom(Grid& grid, const Point& entry, const PathPrefix& prefix) {
+            const int depth = static_cast<int>(prefix.path.size());
+            auto pos = entry;
+            auto incoming = getIncoming(grid, entry);
+            int hit = 0;
+            int laid = 0;
+            bool open = true;
+            for (; laid < depth; laid++) {
+                const auto [pt, piece] = prefix.path[laid];
+                if (pt != pos || !grid.isInBounds(pt) || _depth[toIndex(pt)] >= 0 ||
+                    !Connections::ConnectsTo(piece, incoming.inverse())) {
+                    Unwind(grid, laid);
+                    throw std::runtime_error("Path prefix isn't a path from the start");
+                }
+                const auto idx = toIndex(pt);
+                if (grid.isEmpty(pt) ? !grid.canPlace(pt, piece) : grid.at(pt) != piece) {
+                    // Ruled out by pieces this grid has that the split's didn't
+                    open = false;
+                    break;
+                }
+                if (grid.isEmpty(pt)) {
+                    grid.place(pt, piece);
+                }
+                _trail[laid] = pt;
+                _depth[idx] = laid;
+                _hash ^= _nogoods ? _zobrist[idx] : 0;
+                hit += _fixed[idx];
+                for (const auto& d : Connections::GetConnections(piece)) {
+                    if (d != incoming.inverse()) {
+                        pos = pt + d;
+                        incoming = d;
+                        break;
+                    }
+                }
+            }
+            if (open && TryBuild(grid, pos, incoming, laid, hit) == Completed) {
+                return true;
+            }
+            Unwind(grid, laid);
             return false;
         }
 
-        PointSet _fixedPoints;
+        // Takes the first count cells off the path, and the pieces the
+        // search placed on them off the grid
+        void Unwind(Grid& grid, int count) {
+            for (int i = count - 1; i >= 0; i--) {
+                const auto idx = toIndex(_trail[i]);
+                if (!_fixed[idx]) {
+                    grid.remove(_trail[i]);
+                }
+                _depth[idx] = -1;
+                _hash ^= _nogoods ? _zobrist[idx] : 0;
+            }
+        }
+
+        // Copies the stack as it stands at the top of the loop at depth,
+        // about to try its current candidate, and hands it to the sink
+        void Save(const Grid& grid, int depth, uint64_t random) {
+            _checkpointDue = false;
+            auto& c = _checkpoint;
+            c.fromExit = _config.fromExit;
+            c.seed = _config.seed;
+            c.order = _config.order;
+            c.fingerprint = _fingerprint;
+            c.random = random;
+            c.steps = Steps() + _stepOffset;
+            c.levels.resize(depth + 1);
+            for (int k = 0; k <= depth; k++) {
+                auto& level = c.levels[k];
+                level.cell = _trail[k];
+                level.count = _candidateCount[k];
+                level.choice = _choice[k];
+                std::copy(_candidates + k * 6, _candidates + k * 6 + level.count, level.candidates.begin());
+            }
+            c.rowCounts.resize(grid.height());
+            c.colCounts.resize(grid.width());
+            for (int y = 0; y < grid.height(); y++) {
+                c.rowCounts[y] = static_cast<uint16_t>(grid.trackInRowCount(y));
+            }
+            for (int x = 0; x < grid.width(); x++) {
+                c.colCounts[x] = static_cast<uint16_t>(grid.trackInColCount(x));
+            }
+            _sink(c);
+            _nextCheckpoint = SolveClock::now() + _checkpointEvery;
+        }
+
+        // Whether a checkpoint can be resumed on this grid: the same
+        // options and starting grid, and a path from the start through its
+        // levels
+        void CheckCheckpoint(const Grid& grid, const Point& entry, const PathCheckpoint& c) const {
+            if (c.fromExit != _config.fromExit || c.seed != _config.seed || c.order != _config.order ||
+                c.fingerprint != _fingerprint) {
+                throw std::runtime_error("Checkpoint is for a different puzzle or solver options");
+            }
+            if (c.levels.empty() || c.rowCounts.size() != static_cast<size_t>(grid.height()) ||
+                c.colCounts.size() != static_cast<size_t>(grid.width())) {
+                throw std::runtime_error("Corrupt checkpoint");
+            }
+            auto pos = entry;
+            auto incoming = getIncoming(grid, entry);
+            for (size_t k = 0; k < c.levels.size(); k++) {
+                const auto& level = c.levels[k];
+                if (level.cell != pos || level.count < 1 || level.count > 6 || level.choice >= level.count) {
+                    throw std::runtime_error("Corrupt checkpoint");
+                }
+                if (k + 1 == c.levels.size()) {
+                    break;
+                }
+                const auto piece = level.candidates[level.choice];
+                if (!Connections::ConnectsTo(piece, incoming.inverse())) {
+                    throw std::runtime_error("Corrupt checkpoint");
+                }
+                for (const auto& d : Connections::GetConnections(piece)) {
+                    if (d != incoming.inverse()) {
+                        pos = pos + d;
+                        incoming = d;
+                        break;
+                    }
+                }
+            }
+        }
+
+        static bool SameCounts(const Grid& grid, const PathCheckpoint& c) {
+            for (int y = 0; y < grid.height(); y++) {
+                if (grid.trackInRowCount(y) != c.rowCounts[y]) {
+                    return false;
+                }
+            }
+            for (int x = 0; x < grid.width(); x++) {
+                if (grid.trackInColCount(x) != c.colCounts[x]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Ties a checkpoint to the grid the search started from
+        static uint64_t Fingerprint(const Grid& grid) {
+            uint64_t state = static_cast<uint64_t>(grid.width()) << 32 | static_cast<uint32_t>(grid.height());
+            uint64_t h = Mix(state);
+            const auto add = [&h, &state](uint64_t v) {
+                state ^= v;
+                h ^= Mix(state);
+            };
+            for (int y = 0; y < grid.height(); y++) {
+                add(static_cast<uint64_t>(grid.rowConstraint(y)));
+            }
+            for (int x = 0; x < grid.width(); x++) {
+                add(static_cast<uint64_t>(grid.colConstraint(x)));
+            }
+            for (int y = 0; y < grid.height(); y++) {
+                for (int x = 0; x < grid.width(); x++) {
+                    add(static_cast<uint64_t>(grid.at(x, y)));
+                }
+            }
+            return h;
+        }
+
+        // Taking the last cell on the path out of the cells it can still use
+        // only changes what Cut() finds if it filled a row or column, or it
+        // touches something the path can't use besides the cell before it
+        // (so might split the cells around it in two). Otherwise the last
+        // head's Cut() still holds.
+        bool MayCut(const Grid& grid, int depth) const {
+            if (depth < 2) {
+                return true;
+            }
+            const auto last = _trail[depth - 1];
+            if (!_fixed[toIndex(last)] &&
+                (grid.trackInRowCount(last.y) >= grid.rowConstraint(last.y) ||
+                    grid.trackInColCount(last.x) >= grid.colConstraint(last.x))) {
+                return true;
+            }
+            for (const auto& d : Ring) {
+                const auto n = last + d;
+                if (n == _trail[depth - 2]) { continue; }
+                if (!grid.isInBounds(n)) { return true; }
+                const auto nidx = toIndex(n);
+                if (_depth[nidx] >= 0) { return true; }
+                if (!_fixed[nidx] && (grid.trackInRowCount(n.y) >= grid.rowConstraint(n.y) ||
+                        grid.trackInColCount(n.x) >= grid.colConstraint(n.x))) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Whether the head at depth can no longer complete the path: some
+        // fixed piece not yet on it (the goal included) is unreachable
+        // through the cells it can still use, or those cells are too few
+        // for what some row or column still needs.
+        bool Cut(const Grid& grid, int depth, int fixedVisited) {
+            std::fill(_rowRoom, _rowRoom + grid.height(), 0);
+            std::fill(_colRoom, _colRoom + grid.width(), 0);
+            if (++_epoch == 0) {
+                std::fill(_mark, _mark + grid.cells(), 0u);
+                _epoch = 1;
+            }
+
+            const auto head = toIndex(_trail[depth]);
+            int top = 0;
+            int reached = 0;
+            _stack[top++] = head;
+            _mark[head] = _epoch;
+            while (top > 0) {
+                const auto idx = _stack[--top];
+                const auto pt = toPoint(idx);
+                if (_fixed[idx]) {
+                    reached++;
+                } else {
+                    _rowRoom[pt.y]++;
+                    _colRoom[pt.x]++;
+                }
+                for (const auto& d : Directions) {
+                    const auto n = pt + d;
+                    if (!grid.isInBounds(n)) { continue; }
+                    const auto nidx = toIndex(n);
+                    if (_mark[nidx] == _epoch || _depth[nidx] >= 0) { continue; }
+                    if (!_fixed[nidx] && (grid.trackInRowCount(n.y) >= grid.rowConstraint(n.y) ||
+                            grid.trackInColCount(n.x) >= grid.colConstraint(n.x))) {
+                        continue;
+                    }
+                    _mark[nidx] = _epoch;
+                    _stack[top++] = nidx;
+                }
+            }
+            if (reached < _fixedCount - fixedVisited) {
+                return true;
+            }
+
+            for (int y = 0; y < grid.height(); y++) {
+                if (_rowRoom[y] < grid.rowConstraint(y) - grid.trackInRowCount(y)) {
+                    return true;
+                }
+            }
+            for (int x = 0; x < grid.width(); x++) {
+                if (_colRoom[x] < grid.colConstraint(x) - grid.trackInColCount(x)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The depth of the latest decision a dead end at depth depends on.
+        // That's the one before it, which chose where the head is, unless
+        // the cells on the path rule the puzzle out by themselves.
+        int DeadEnd(const Grid& grid, int depth) {
+            int back = depth - 1;
+            if (!_config.backjumps || back < 1) {
+                return back;
+            }
+            back = DeadStub(grid, back);
+            if (back < depth - 1) {
+                _stats.backjumps++;
+            }
+            return back;
+        }
+
+        // The decision which put the cell at depth on the path
+        static int Decided(int depth) {
+            return depth > 0 ? depth - 1 : -1;
+        }
+
+        // The latest decision behind a full row or column, the one putting
+        // the deepest of the path's own cells in it, or Completed if it
+        // isn't full
+        int RowFull(const Grid& grid, int y) const {
+            if (grid.trackInRowCount(y) < grid.rowConstraint(y)) {
+                return Completed;
+            }
+            int deepest = -1;
+            for (int x = 0; x < grid.width(); x++) {
+                const auto idx = toIndex(Point{ x, y });
+                deepest = _fixed[idx] ? deepest : std::max(deepest, _depth[idx]);
+            }
+            return Decided(deepest);
+        }
+
+        int ColFull(const Grid& grid, int x) const {
+            if (grid.trackInColCount(x) < grid.colConstraint(x)) {
+                return Completed;
+            }
+            int deepest = -1;
+            for (int y = 0; y < grid.height(); y++) {
+                const auto idx = toIndex(Point{ x, y });
+                deepest = _fixed[idx] ? deepest : std::max(deepest, _depth[idx]);
+            }
+            return Decided(deepest);
+        }
+
+        // The earliest decision before limit which left a fixed piece's
+        // track running into a cell that can't take any, or limit. A cell
+        // can't when its row or column is full, or when every way on from
+        // it is off the grid, into a full row or column or into track
+        // which doesn't connect back.
+        int DeadStub(const Grid& grid, int limit) const {
+            for (int i = 0; i < _stubCount && limit >= 0; i += 2) {
+                const auto from = toPoint(_stubs[i]);
+                const auto cell = toPoint(_stubs[i + 1]);
+                if (!grid.isEmpty(cell)) {
+                    continue;
+                }
+                int dead = std::min(RowFull(grid, cell.y), ColFull(grid, cell.x));
+                if (dead == Completed) {
+                    dead = -1;
+                    for (const auto& d : Directions) {
+                        const auto n = cell + d;
+                        if (n == from || !grid.isInBounds(n)) {
+                            continue;
+                        }
+                        const auto nidx = toIndex(n);
+                        if (grid.isEmpty(n)) {
+                            dead = std::max(dead, std::min(RowFull(grid, n.y), ColFull(grid, n.x)));
+                        } else if (Connections::ConnectsTo(grid.at(n), d.inverse())) {
+                            dead = Completed;
+                        } else if (!_fixed[nidx]) {
+                            // Its piece, chosen at its own depth, turns away
+                            dead = std::max(dead, _depth[nidx]);
+                        }
+                        if (dead == Completed) {
+                            break;
+                        }
+                    }
+                }
+                limit = std::min(limit, dead);
+            }
+            return limit;
+        }
+
+        void Remember(uint64_t key) {
+            if (_nogoods) {
+                _nogoods[key & _nogoodMask] = key;
+                _stats.nogoods++;
+            }
+        }
+
+        // The search state at a head: cells on the path, where the head is
+        // and the direction it came in from
+        uint64_t Key(int idx, const Point& incoming) const {
+            uint64_t state = _hash ^ (static_cast<uint64_t>(idx) * 9 + (incoming.x + 1) * 3 + (incoming.y + 1));
+            const auto key = Mix(state);
+            return key == 0 ? 1 : key;
+        }
+
+        // splitmix64
+        static uint64_t Mix(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        Point toPoint(int idx) const {
+            return Point{ idx % _width, idx / _width };
+        }
+
+        int toIndex(const Point& pt) const {
+            return static_cast<int>(pt.project(_width));
+        }
+
+        // xorshift64, cheap enough to call at every cell
+        uint64_t Next() {
+            _random ^= _random << 13;
+            _random ^= _random >> 7;
+            _random ^= _random << 17;
+            return _random;
+        }
+
+        // Steps between reading the clock for checkpoints, less one
+        static constexpr uint64_t CheckpointPoll = 4095;
+
+        static constexpr std::array<Point, 4> Directions{ Point{0, 1}, Point{1, 0}, Point{0, -1}, Point{-1, 0} };
+        static constexpr std::array<Point, 8> Ring{ Point{-1, -1}, Point{0, -1}, Point{1, -1}, Point{1, 0},
+            Point{1, 1}, Point{0, 1}, Point{-1, 1}, Point{-1, 0} };
+
+        const PathSolverOptions _config;
+        uint64_t _random;
+        Point _goal;
+        int _width = 0;
+        int _fixedCount = 0;
+        PathSolverStats _stats;
+
+        // Arena backed, one entry per cell. _depth is the depth a cell
+        // joined the path at, -1 while it isn't on it, and _trail is the
+        // head at each depth.
+        int* _depth = nullptr;
+        bool* _fixed = nullptr;
+        Point* _trail = nullptr;
+
+        // Cut() scratch: flood fill marks and stack, and the cells each
+        // row and column could still take
+        uint32_t* _mark = nullptr;
+        uint32_t _epoch = 0;
+        int* _stack = nullptr;
+        int* _rowRoom = nullptr;
+        int* _colRoom = nullptr;
+
+        // Arena backed, pairs of a fixed piece and the empty cell its track
+        // runs into
+        int* _stubs = nullptr;
+        int _stubCount = 0;
+
+        uint64_t* _nogoods = nullptr;
+        size_t _nogoodMask = 0;
+        uint64_t* _zobrist = nullptr;
+        uint64_t _hash = 0;
+
+        // Set for the length of a Split or Resume
+        std::vector<PathPrefix>* _frontier = nullptr;
+        int _frontierDepth = 0;
+        uint64_t _frontierStart = 0;
+        const PathPrefix* _resume = nullptr;
+
+        // Arena backed, per depth: the candidates in the order they're
+        // tried, how many and which is being tried. The stack a checkpoint
+        // saves.
+        Piece* _candidates = nullptr;
+        uint8_t* _candidateCount = nullptr;
+        uint8_t* _choice = nullptr;
+
+        CheckpointSink _sink;
+        std::chrono::nanoseconds _checkpointEvery{0};
+        SolveClock::time_point _nextCheckpoint;
+        bool _checkpointDue = false;
+        bool _interruptSaved = false;
+        // Added to Steps() for a checkpoint's running total
+        uint64_t _stepOffset = 0;
+        uint64_t _fingerprint = 0;
+        PathCheckpoint _checkpoint;
+
+        // Set for the length of a Resume from a checkpoint, _replay until
+        // the search is back down to its deepest level
+        const PathCheckpoint* _restart = nullptr;
+        const PathCheckpoint* _replay = nullptr;
+        size_t _replayDepth = 0;
+        bool _replayFailed = false;
     };
 } // namespace TrainTracks
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace TrainTracks {
+
+    enum class PerfEvent {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+    };
+
+    constexpr size_t PerfEventCount = 5;
+
+    inline const char* PerfEventName(PerfEvent e) {
+        switch (e) {
+            case PerfEvent::Cycles: return "cycles";
+            case PerfEvent::Instructions: return "instructions";
+            case PerfEvent::L1DMisses: return "l1d_misses";
+            case PerfEvent::LLCMisses: return "llc_misses";
+            case PerfEvent::BranchMisses: return "branch_misses";
+        }
+        return "?";
+    }
+
+    // Counts from one or more measured regions. Counters the machine
+    // couldn't open are left out rather than reported as zero.
+    struct PerfSample {
+        std::array<uint64_t, PerfEventCount> values{};
+        std::array<bool, PerfEventCount> valid{};
+
+        bool has(PerfEvent e) const {
+            return valid[static_cast<size_t>(e)];
+        }
+
+        uint64_t operator[](PerfEvent e) const {
+            return values[static_cast<size_t>(e)];
+        }
+
+        bool any() const {
+            for (const auto v : valid) {
+                if (v) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Instructions per cycle, 0 without both counters
+        double ipc() const {
+            return has(PerfEvent::Cycles) && has(PerfEvent::Instructions) && values[0] > 0 ?
+                static_cast<double>(values[1]) / values[0] : 0.0;
+        }
+
+        PerfSample& operator+=(const PerfSample& o) {
+            for (size_t i = 0; i < PerfEventCount; i++) {
+                if (o.valid[i]) {
+                    values[i] += o.values[i];
+                    valid[i] = true;
+                }
+            }
+            return *this;
+        }
+    };
+
+    // Hardware counters for the calling thread and any threads it starts,
+    // user space only, through perf_event_open. Each counter is opened on its own so one the CPU or
+    // hypervisor doesn't offer doesn't take the rest with it; if none open
+    // (not Linux, perf_event_paranoid, containers) Available() is false and
+    // every sample comes back empty.
+    class PerfCounters {
+    public:
+        PerfCounters() {
+            _fds.fill(-1);
+#ifdef __linux__
+            const std::array<std::pair<uint32_t, uint64_t>, PerfEventCount> events{ {
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            } };
+            for (size_t i = 0; i < PerfEventCount; i++) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[i].first;
+                attr.config = events[i].second;
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                // Threads started while counting (PortfolioSolver's) add to ours as they exit
+                attr.inherit = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                const auto fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+                if (fd < 0) {
+                    if (_error.empty()) {
+                        _error = std::string(PerfEventName(static_cast<PerfEvent>(i))) + ": " + std::strerror(errno);
+                    }
+                    continue;
+                }
+                _fds[i] = static_cast<int>(fd);
+            }
+#else
+            _error = "Hardware counters need Linux";
+#endif
+        }
+
+        ~PerfCounters() {
+#ifdef __linux__
+            for (const auto fd : _fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        bool Available() const {
+            for (const auto fd : _fds) {
+                if (fd >= 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool Available(PerfEvent e) const {
+            return _fds[static_cast<size_t>(e)] >= 0;
+        }
+
+        // Why the first counter that failed to open did, empty if all opened
+        const std::string& Error() const {
+            return _error;
+        }
+
+        // Zeroes and starts every counter
+        void Start() {
+#ifdef __linux__
+            for (const auto fd : _fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        // Stops the counters and reads what they saw since Start(), scaled
+        // up if the kernel had to share the hardware between counters
+        PerfSample Stop() {
+            PerfSample sample;
+#ifdef __linux__
+            for (const auto fd : _fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                }
+            }
+            for (size_t i = 0; i < PerfEventCount; i++) {
+                if (_fds[i] < 0) {
+                    continue;
+                }
+                uint64_t data[3];
+                if (read(_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+                    continue;
+                }
+                const auto enabled = data[1];
+                const auto running = data[2];
+                sample.values[i] = running == 0 ? 0 : (running >= enabled ? data[0] :
+                    static_cast<uint64_t>(static_cast<double>(data[0]) * enabled / running));
+                sample.valid[i] = true;
+            }
+#endif
+            return sample;
+        }
+
+    private:
+        std::array<int, PerfEventCount> _fds;
+        std::string _error;
+    };
+}
@@ -1,13 +1,15 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <string_view>
 #include <iostream>
 
 namespace TrainTracks {
 
-    enum class Piece {
+    // A byte, so grids and puzzles hold one per cell
+    enum class Piece : uint8_t {
         Empty = 0,
 
         Horizontal = 3,
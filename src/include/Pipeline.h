@@ -0,0 +1,302 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Solver.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TrainTracks {
+
+    struct PipelineOptions {
+        // Threads for each stage
+        size_t parsers = 1;
+        size_t presolvers = 1;
+        size_t searchers = std::max(1u, std::thread::hardware_concurrency());
+        size_t serialisers = 1;
+        // Records waiting between one stage and the next
+        size_t queueCapacity = 64;
+        // Records read but not yet written, which bounds memory however long
+        // the input; ordered output holds finished records back within it
+        size_t window = 256;
+        // Write results in input order, otherwise as they complete
+        bool ordered = true;
+        // Applied to every search; the timeout starts when the search does
+        SolveOptions solve;
+    };
+
+    struct PipelineStats {
+        uint64_t records = 0;
+        // Records which couldn't be parsed or presolved
+        uint64_t errors = 0;
+        // Searched records by SolveStatus
+        uint64_t counts[4] = {};
+        uint64_t steps = 0;
+        // Most finished records held back waiting for an earlier one
+        size_t maxHeld = 0;
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    // One input line on its way through the stages. Each stage fills in its
+    // part and drops what later stages don't need.
+    struct PipelineRecord {
+        // Position among the records read, from 0
+        uint64_t index = 0;
+        // The request's "id", or its line number if it has none
+        std::string id;
+        // The request line, then the formatted output
+        std::string text;
+        std::optional<Puzzle> puzzle;
+        std::optional<Grid> grid;
+        SolveResult result;
+        // Set by the stage which failed, later stages pass the record on
+        std::string error;
+        SolveClock::time_point read;
+    };
+
+    // Turns a finished record into the text written for it
+    using PipelineFormatter = std::function<std::string(const PipelineRecord&)>;
+
+    // Solves a stream of Puzzle::fromJson lines, one per line, writing a line
+    // of output for each. The work runs as four stages joined by bounded
+    // queues, each with its own threads: parse the JSON, presolve (building
+    // the Grid runs placeObviousPieces), search, and serialise and write.
+    // The calling thread reads the input, so reading and writing overlap
+    // with the search, and no more than the window's worth of records are
+    // in flight at once.
+    class Pipeline {
+    public:
+        enum Stage {
+            Parse,
+            Presolve,
+            Search,
+            Serialise,
+            Stages,
+        };
+
+        Pipeline(PipelineFormatter format, const PipelineOptions& options = PipelineOptions(),
+            SolverFactory factory = [] { return std::make_unique<PathSolver>(); })
+            : _format(std::move(format))
+            , _options(options)
+            , _factory(std::move(factory))
+            , _out(nullptr)
+            , _next(0)
+            , _inFlight(0)
+        {
+            if (!_format) {
+                throw std::runtime_error("Pipeline needs a formatter");
+            }
+            if (_options.parsers == 0 || _options.presolvers == 0 || _options.searchers == 0 ||
+                _options.serialisers == 0) {
+                throw std::runtime_error("Pipeline stages need at least one thread");
+            }
+            if (_options.queueCapacity == 0 || _options.window == 0) {
+                throw std::runtime_error("Pipeline queue capacity and window must be non-zero");
+            }
+        }
+
+        Pipeline(const Pipeline&) = delete;
+        Pipeline& operator=(const Pipeline&) = delete;
+
+        // Reads until the end of the input, and returns once everything read
+        // has been written. Blank lines are skipped.
+        PipelineStats Run(std::istream& in, std::ostream& out) {
+            const auto start = SolveClock::now();
+            _out = &out;
+            _stats = PipelineStats();
+            _held.clear();
+            _next = 0;
+            _inFlight = 0;
+            const std::array<size_t, Stages> threads{ {
+                _options.parsers, _options.presolvers, _options.searchers, _options.serialisers
+            } };
+            for (size_t s = 0; s < Stages; s++) {
+                _queues[s] = std::make_unique<BoundedQueue<PipelineRecord>>(_options.queueCapacity);
+                _running[s] = threads[s];
+            }
+
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < _options.parsers; i++) {
+                workers.emplace_back([this] { Drain(Parse, [](PipelineRecord& r) { ParseRecord(r); }); });
+            }
+            for (size_t i = 0; i < _options.presolvers; i++) {
+                workers.emplace_back([this] { Drain(Presolve, [](PipelineRecord& r) { PresolveRecord(r); }); });
+            }
+            for (size_t i = 0; i < _options.searchers; i++) {
+                workers.emplace_back([this] {
+                    auto solver = _factory();
+                    Drain(Search, [this, &solver](PipelineRecord& r) { SearchRecord(*solver, r); });
+                });
+            }
+            for (size_t i = 0; i < _options.serialisers; i++) {
+                workers.emplace_back([this] { Drain(Serialise, [this](PipelineRecord& r) { Write(r); }); });
+            }
+
+            Read(in);
+            for (auto& w : workers) {
+                w.join();
+            }
+            out.flush();
+            _out = nullptr;
+            _stats.elapsed = SolveClock::now() - start;
+            return _stats;
+        }
+
+    private:
+        void Read(std::istream& in) {
+            std::string line;
+            uint64_t number = 0;
+            uint64_t index = 0;
+            while (std::getline(in, line)) {
+                number++;
+                if (trim(line).empty()) {
+                    continue;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _slots.wait(lock, [this] { return _inFlight < _options.window; });
+                    _inFlight++;
+                }
+                PipelineRecord r;
+                r.index = index++;
+                r.id = std::to_string(number);
+                r.text = std::move(line);
+                r.read = SolveClock::now();
+                _queues[Parse]->Push(std::move(r));
+            }
+            _queues[Parse]->Close();
+        }
+
+        // Runs a stage's work on each record in its queue, passing them on,
+        // and closes the next queue once the stage's last thread is done
+        template <typename Work>
+        void Drain(Stage stage, Work work) {
+            PipelineRecord r;
+            while (_queues[stage]->Pop(r)) {
+                work(r);
+                if (stage + 1 < Stages) {
+                    _queues[stage + 1]->Push(std::move(r));
+                }
+            }
+            if (--_running[stage] == 0 && stage + 1 < Stages) {
+                _queues[stage + 1]->Close();
+            }
+        }
+
+        static void ParseRecord(PipelineRecord& r) {
+            PROFILE_ZONE("parse");
+            const auto id = json_value(r.text, "id");
+            if (!id.empty()) {
+                r.id = std::string(id);
+            }
+            try {
+                r.puzzle.emplace(Puzzle::fromJson(r.text));
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            r.text.clear();
+            r.text.shrink_to_fit();
+        }
+
+        static void PresolveRecord(PipelineRecord& r) {
+            if (!r.puzzle) {
+                return;
+            }
+            try {
+                r.grid.emplace(*r.puzzle);
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            r.puzzle.reset();
+        }
+
+        void SearchRecord(Solver& solver, PipelineRecord& r) {
+            if (!r.grid) {
+                return;
+            }
+            PROFILE_ZONE("solve");
+            const auto waited = SolveClock::now() - r.read;
+            try {
+                r.result = solver.Solve(*r.grid, _options.solve);
+                r.result.waited = waited;
+                if (r.result.solved()) {
+                    const auto& grid = *r.grid;
+                    r.result.solution.reserve(grid.cells());
+                    for (int y = 0; y < grid.height(); y++) {
+                        for (int x = 0; x < grid.width(); x++) {
+                            r.result.solution.push_back(grid.at(x, y));
+                        }
+                    }
+                }
+            } catch (const std::exception& e) {
+                r.error = e.what();
+            }
+            r.grid.reset();
+        }
+
+        void Write(PipelineRecord& r) {
+            auto text = _format(r);
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats.records++;
+            if (!r.error.empty()) {
+                _stats.errors++;
+            } else {
+                _stats.counts[static_cast<int>(r.result.status)]++;
+                _stats.steps += r.result.steps;
+            }
+
+            size_t written = 0;
+            if (_options.ordered) {
+                _held.emplace(r.index, std::move(text));
+                while (!_held.empty() && _held.begin()->first == _next) {
+                    *_out << _held.begin()->second;
+                    _held.erase(_held.begin());
+                    _next++;
+                    written++;
+                }
+                _stats.maxHeld = std::max(_stats.maxHeld, _held.size());
+            } else {
+                *_out << text;
+                written = 1;
+            }
+            // Let the output stream out, unless more is about to follow
+            if (written > 0 && _queues[Serialise]->Size() == 0) {
+                _out->flush();
+            }
+            _inFlight -= written;
+            _slots.notify_one();
+        }
+
+        const PipelineFormatter _format;
+        const PipelineOptions _options;
+        SolverFactory _factory;
+        std::array<std::unique_ptr<BoundedQueue<PipelineRecord>>, Stages> _queues;
+        std::array<std::atomic<size_t>, Stages> _running;
+
+        // Guards the output, the stats and the window
+        std::mutex _mutex;
+        std::condition_variable _slots;
+        std::ostream* _out;
+        std::map<uint64_t, std::string> _held;
+        uint64_t _next;
+        size_t _inFlight;
+        PipelineStats _stats;
+    };
+}
@@ -88,7 +88,7 @@ namespace TrainTracks {
         }
 
         inline int64_t project(int32_t w) const noexcept {
-            return y * w + x;
+            return static_cast<int64_t>(y) * w + x;
         }
 
         constexpr inline Point inverse() const noexcept {
@@ -0,0 +1,220 @@
+#pragma once
+
+#include "PathSolver.h"
+#include "SegmentSolver.h"
+#include "Solver.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TrainTracks
+{
+
+    struct PortfolioEntry {
+        std::string name;
+        SolverFactory factory;
+    };
+
+    struct PortfolioEntryStats {
+        std::string name;
+        // Solves this entry took part in, and how many it settled first
+        uint64_t runs = 0;
+        uint64_t wins = 0;
+        uint64_t steps = 0;
+
+        double winRate() const {
+            return runs == 0 ? 0.0 : static_cast<double>(wins) / runs;
+        }
+    };
+
+    // Races several solver configurations against each other. The first
+    // entry searches the caller's grid, so a reporter or recorder given to
+    // the portfolio follows it, and the rest each search their own copy. The first to
+    // either solve the puzzle or prove it unsolvable settles it and the rest
+    // are cancelled. A step budget is shared out between the entries, and
+    // Steps() counts the work done by every entry, not just the winner's.
+    class PortfolioSolver
+        : public Solver {
+
+    public:
+        explicit PortfolioSolver(std::vector<PortfolioEntry> entries = Defaults())
+            : Solver()
+            , _cancel(false)
+            , _lastWinner(-1)
+        {
+            if (entries.empty()) {
+                throw std::runtime_error("PortfolioSolver needs at least one entry");
+            }
+            for (auto& e : entries) {
+                Member m;
+                m.stats.name = e.name;
+                m.solver = e.factory();
+                _members.push_back(std::move(m));
+            }
+        }
+
+        // A forward and a backward PathSolver, a shuffled one and a SegmentSolver
+        static std::vector<PortfolioEntry> Defaults() {
+            PathSolverOptions fromExit;
+            fromExit.fromExit = true;
+            PathSolverOptions shuffled;
+            shuffled.seed = 0x9E3779B97F4A7C15ull;
+
+            return {
+                { "path", [] { return std::make_unique<PathSolver>(); } },
+                { "path-exit", [fromExit] { return std::make_unique<PathSolver>(fromExit); } },
+                { "path-shuffled", [shuffled] { return std::make_unique<PathSolver>(shuffled); } },
+                { "segment", [] { return std::make_unique<SegmentSolver>(); } },
+            };
+        }
+
+        using Solver::Solve;
+
+        bool Solve(Grid& grid) override {
+            const auto n = _members.size();
+            _cancel = false;
+
+            SolveOptions options;
+            options.deadline = _options.deadline;
+            options.cancel = &_cancel;
+            const uint64_t budget = _options.maxSteps;
+
+            // The others search copies, kept between solves
+            for (size_t i = 1; i < n; i++) {
+                if (i - 1 < _grids.size()) {
+                    _grids[i - 1].copyFrom(grid);
+                } else {
+                    _grids.push_back(grid);
+                }
+            }
+            std::vector<SolveResult> results(n);
+
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t finished = 0;
+            int winner = -1;
+
+            _members.front().solver->Reporter(_reporter);
+            _members.front().solver->Recorder(_recorder);
+            std::vector<std::thread> threads;
+            threads.reserve(n);
+            for (size_t i = 0; i < n; i++) {
+                // With fewer steps than entries some get none, and are out
+                // of time before they start
+                const uint64_t share = budget / n + (i < budget % n);
+                if (budget != 0 && share == 0) {
+                    results[i].status = SolveStatus::TimedOut;
+                    finished++;
+                    continue;
+                }
+                threads.emplace_back([&, i, share] {
+                    auto& solver = *_members[i].solver;
+                    solver.Domains(_domains);
+                    SolveOptions limits = options;
+                    limits.maxSteps = share;
+                    auto result = solver.Solve(i == 0 ? grid : _grids[i - 1], limits);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    const bool settled = result.status == SolveStatus::Solved ||
+                        result.status == SolveStatus::Unsolvable;
+                    if (settled && winner < 0) {
+                        winner = static_cast<int>(i);
+                        _cancel = true;
+                    }
+                    results[i] = std::move(result);
+                    finished++;
+                    done.notify_all();
+                });
+            }
+
+            // Pass on cancellation from our caller while the entries run
+            bool cancelled = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                const auto over = [&] { return winner >= 0 || finished == n; };
+                while (!over()) {
+                    if (_options.cancel == nullptr && _options.shutdown == nullptr) {
+                        done.wait(lock, over);
+                    } else if (!done.wait_for(lock, std::chrono::milliseconds(1), over) &&
+                        _options.cancelled()) {
+                        cancelled = true;
+                        _cancel = true;
+                    }
+                }
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+            _members.front().solver->Reporter(nullptr);
+            _members.front().solver->Recorder(nullptr);
+
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                for (size_t i = 0; i < n; i++) {
+                    _members[i].stats.runs++;
+                    _members[i].stats.steps += results[i].steps;
+                    _steps += results[i].steps;
+                    // The entries run at once, so their scratch adds up
+                    _innerBytes += results[i].peakBytes;
+                }
+                if (winner >= 0) {
+                    _members[winner].stats.wins++;
+                }
+                _lastWinner = winner;
+            }
+
+            if (winner < 0) {
+                Interrupt(cancelled ? SolveStatus::Cancelled : SolveStatus::TimedOut);
+                return false;
+            }
+            if (!results[winner].solved()) {
+                return false;
+            }
+            if (winner == 0) {
+                return true;
+            }
+
+            const auto& solved = _grids[winner - 1];
+            for (int y = 0; y < grid.height(); y++) {
+                for (int x = 0; x < grid.width(); x++) {
+                    const Point pt{x, y};
+                    if (grid.isEmpty(pt) && solved.isFilled(pt)) {
+                        grid.place(pt, solved.at(pt));
+                    }
+                }
+            }
+            return true;
+        }
+
+        std::vector<PortfolioEntryStats> Stats() const {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            std::vector<PortfolioEntryStats> stats;
+            for (const auto& m : _members) {
+                stats.push_back(m.stats);
+            }
+            return stats;
+        }
+
+        // The entry which settled the last solve, -1 if none did
+        int LastWinner() const {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            return _lastWinner;
+        }
+
+    private:
+        struct Member {
+            PortfolioEntryStats stats;
+            std::unique_ptr<Solver> solver;
+        };
+
+        std::vector<Member> _members;
+        std::vector<Grid> _grids;
+        std::atomic<bool> _cancel;
+
+        mutable std::mutex _statsMutex;
+        int _lastWinner;
+    };
+} // namespace TrainTracks
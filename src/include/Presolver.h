@@ -0,0 +1,183 @@
+#pragma once
+
+#include "Grid.h"
+#include "Domains.h"
+#include "Connections.h"
+#include "Debug.h"
+#include "Profiler.h"
+
+#include <array>
+
+namespace TrainTracks {
+
+    // Treats every row and column constraint like a nonogram clue. Each cell
+    // starts with every state the edge rules allow, and domains are narrowed
+    // line by line (track counts) and cell by cell (stubs must agree with
+    // the neighbouring cell) until nothing changes.
+    class Presolver {
+    public:
+        Presolver(Grid& grid)
+            : _grid(grid)
+            , _domains(grid.width(), grid.height())
+        { }
+
+        // Returns false if the puzzle has no solution
+        bool Propagate() {
+            PROFILE_ZONE("presolve");
+            Init();
+
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (int r = 0; r < _grid.height(); r++) {
+                    if (!ReduceLine({0, r}, Point::right(), _grid.width(), _grid.rowConstraint(r), changed)) {
+                        DEBUG_LOG(r);
+                        return false;
+                    }
+                }
+                for (int c = 0; c < _grid.width(); c++) {
+                    if (!ReduceLine({c, 0}, Point::down(), _grid.height(), _grid.colConstraint(c), changed)) {
+                        DEBUG_LOG(c);
+                        return false;
+                    }
+                }
+                for (int y = 0; y < _grid.height(); y++) {
+                    for (int x = 0; x < _grid.width(); x++) {
+                        if (!ReduceStubs({x, y}, changed)) {
+                            DEBUG_LOG(x, y);
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Places every cell narrowed down to a single piece, returning how
+        // many were placed
+        int Commit() {
+            int count = 0;
+            for (int y = 0; y < _grid.height(); y++) {
+                for (int x = 0; x < _grid.width(); x++) {
+                    const Point pt{x, y};
+                    const auto p = _domains.known(pt);
+                    if (p != Piece::Empty && _grid.isEmpty(pt)) {
+                        _grid.place(pt, p);
+                        count++;
+                    }
+                }
+            }
+            return count;
+        }
+
+        const CellDomains& domains() const {
+            return _domains;
+        }
+
+    protected:
+        void Init() {
+            for (int y = 0; y < _grid.height(); y++) {
+                for (int x = 0; x < _grid.width(); x++) {
+                    const Point pt{x, y};
+                    auto& d = _domains.at(pt);
+                    if (_grid.isFilled(pt)) {
+                        d = DomainBit(_grid.at(pt));
+                        continue;
+                    }
+
+                    d = FullDomain;
+                    if (_grid.rowConstraint(y) == 0 || _grid.colConstraint(x) == 0) {
+                        d = EmptyDomain;
+                        continue;
+                    }
+                    // Only the entry and exit may leave the grid
+                    for (int i = 0; i < 4; i++) {
+                        if (!_grid.isInBounds(pt + Directions[i])) {
+                            d &= ~ConnectMask(i);
+                        }
+                    }
+                }
+            }
+        }
+
+        bool ReduceLine(Point pt, const Point& step, int length, int target, bool& changed) {
+            int must = 0;
+            int may = 0;
+            Point it = pt;
+            for (int i = 0; i < length; i++, it += step) {
+                const auto d = _domains.at(it);
+                must += (d & EmptyDomain) == 0;
+                may += (d & TrackDomain) != 0;
+            }
+
+            if (must > target || may < target) {
+                return false;
+            }
+            if (must != target && may != target) {
+                return true;
+            }
+
+            // Either the line is full, so every open cell is empty, or every
+            // cell that could hold track has to
+            const Domain keep = must == target ? EmptyDomain : TrackDomain;
+            it = pt;
+            for (int i = 0; i < length; i++, it += step) {
+                auto& d = _domains.at(it);
+                if ((d & EmptyDomain) && (d & TrackDomain)) {
+                    d &= keep;
+                    changed = true;
+                }
+            }
+            return true;
+        }
+
+        bool ReduceStubs(const Point& pt, bool& changed) {
+            if (_grid.isFilled(pt)) {
+                return true;
+            }
+
+            auto& d = _domains.at(pt);
+            const auto before = d;
+            for (int i = 0; i < 4; i++) {
+                const auto n = pt + Directions[i];
+                const Domain nd = _grid.isInBounds(n) ? _domains.at(n) : EmptyDomain;
+                const auto back = ConnectMask((i + 2) % 4);
+
+                // Connecting towards n needs a neighbour state which connects
+                // back, and not connecting needs one which doesn't
+                if ((nd & back) == 0) {
+                    d &= ~ConnectMask(i);
+                }
+                if ((nd & ~back & FullDomain) == 0) {
+                    d &= ConnectMask(i);
+                }
+            }
+
+            if (d != before) {
+                changed = true;
+            }
+            return d != 0;
+        }
+
+        static Domain ConnectMask(int dir) {
+            static const std::array<Domain, 4> masks = [] {
+                std::array<Domain, 4> m{};
+                for (int i = 0; i < 4; i++) {
+                    for (const auto p : ValidPieces) {
+                        if (Connections::ConnectsTo(p, Directions[i])) {
+                            m[i] |= DomainBit(p);
+                        }
+                    }
+                }
+                return m;
+            }();
+            return masks[dir];
+        }
+
+        // Opposite directions are two apart
+        static constexpr std::array<Point, 4> Directions{ Point{0, 1}, Point{1, 0}, Point{0, -1}, Point{-1, 0} };
+
+        Grid& _grid;
+        CellDomains _domains;
+    };
+}
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+// Times the rest of the enclosing scope as a zone called `name`, nested
+// under whichever zone the thread is already in. Costs one relaxed atomic
+// load while profiling is off.
+#define PROFILE_ZONE(name) ::TrainTracks::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+namespace TrainTracks {
+
+    struct ProfileZoneStats {
+        // Zone names from the outermost, joined with '/'
+        std::string path;
+        std::string name;
+        int depth = 0;
+        uint64_t count = 0;
+        // Nanoseconds
+        uint64_t total = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        // To within an eighth of a power of two
+        uint64_t p99 = 0;
+
+        double avg() const {
+            return count == 0 ? 0.0 : static_cast<double>(total) / count;
+        }
+    };
+
+    // Collects PROFILE_ZONE timings from every thread. Each thread keeps its
+    // own zone tree and events behind its own lock, so threads never wait on
+    // each other; Stats() merges the trees by zone path.
+    class Profiler {
+    public:
+        // Events kept per thread for the Chrome trace, zones past this are
+        // still counted in Stats()
+        static constexpr size_t MaxEvents = 1 << 20;
+
+        static bool Enabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        static void Enable(bool enabled = true) {
+            _enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        // Forgets everything recorded so far. Zones still open when this is
+        // called are recorded when they close.
+        static void Reset() {
+            auto& p = Instance();
+            std::lock_guard<std::mutex> lock(p._mutex);
+            for (auto& t : p._threads) {
+                std::lock_guard<std::mutex> threadLock(t->mutex);
+                for (auto& n : t->nodes) {
+                    n.Clear();
+                }
+                t->events.clear();
+                t->dropped = 0;
+            }
+        }
+
+        // Every zone seen, outermost first with nested zones after their
+        // parent
+        static std::vector<ProfileZoneStats> Stats() {
+            std::map<std::vector<std::string>, Node> merged;
+            auto& p = Instance();
+            {
+                std::lock_guard<std::mutex> lock(p._mutex);
+                for (auto& t : p._threads) {
+                    std::lock_guard<std::mutex> threadLock(t->mutex);
+                    for (size_t i = 1; i < t->nodes.size(); i++) {
+                        const auto& n = t->nodes[i];
+                        if (n.count > 0) {
+                            merged[t->Path(i)].Merge(n);
+                        }
+                    }
+                }
+            }
+
+            std::vector<ProfileZoneStats> stats;
+            for (const auto& [path, n] : merged) {
+                ProfileZoneStats s;
+                for (const auto& name : path) {
+                    s.path.append(s.path.empty() ? "" : "/").append(name);
+                }
+                s.name = path.back();
+                s.depth = static_cast<int>(path.size()) - 1;
+                s.count = n.count;
+                s.total = n.total;
+                s.min = n.min;
+                s.max = n.max;
+                s.p99 = n.Percentile(0.99);
+                stats.push_back(std::move(s));
+            }
+            return stats;
+        }
+
+        // A table of Stats(), times in microseconds
+        static void Print(std::ostream& os) {
+            const auto us = [](double ns) { return ns / 1000.0; };
+            os << std::left << std::setw(32) << "Zone" << std::right << std::setw(10) << "count"
+               << std::setw(14) << "total ms" << std::setw(12) << "min us" << std::setw(12) << "avg us"
+               << std::setw(12) << "max us" << std::setw(12) << "p99 us" << "\n";
+            os << std::fixed << std::setprecision(1);
+            for (const auto& s : Stats()) {
+                os << std::left << std::setw(32) << (std::string(s.depth * 2, ' ') + s.name) << std::right
+                   << std::setw(10) << s.count << std::setw(14) << s.total / 1e6
+                   << std::setw(12) << us(s.min) << std::setw(12) << us(s.avg()) << std::setw(12) << us(s.max)
+                   << std::setw(12) << us(s.p99) << "\n";
+            }
+            os << std::defaultfloat;
+            const auto dropped = Dropped();
+            if (dropped > 0) {
+                os << dropped << " zones left out of the trace\n";
+            }
+        }
+
+        // Every zone kept as a Chrome trace_event "complete" event, one row
+        // per thread. Opens in chrome://tracing or ui.perfetto.dev.
+        static void WriteChromeTrace(std::ostream& os) {
+            auto& p = Instance();
+            std::lock_guard<std::mutex> lock(p._mutex);
+            os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+            bool first = true;
+            char ts[64];
+            for (auto& t : p._threads) {
+                std::lock_guard<std::mutex> threadLock(t->mutex);
+                for (const auto& e : t->events) {
+                    const auto& n = t->nodes[e.node];
+                    // Microseconds from when profiling started, to the nanosecond
+                    std::snprintf(ts, sizeof(ts), "\"ts\":%.3f,\"dur\":%.3f",
+                        static_cast<double>(e.start - p._epoch) / 1000.0, static_cast<double>(e.duration) / 1000.0);
+                    os << (first ? "\n" : ",\n") << "{\"name\":\"" << n.name << "\",\"cat\":\"zone\",\"ph\":\"X\","
+                       << ts << ",\"pid\":1,\"tid\":" << t->id << "}";
+                    first = false;
+                }
+            }
+            os << "\n]}\n";
+        }
+
+        // Zones recorded in Stats() but left out of the trace
+        static uint64_t Dropped() {
+            auto& p = Instance();
+            std::lock_guard<std::mutex> lock(p._mutex);
+            uint64_t dropped = 0;
+            for (auto& t : p._threads) {
+                std::lock_guard<std::mutex> threadLock(t->mutex);
+                dropped += t->dropped;
+            }
+            return dropped;
+        }
+
+    private:
+        friend class ProfileZone;
+
+        // Log-linear buckets: exact below 16ns, then eight per power of two
+        static constexpr int Buckets = 16 + 60 * 8;
+
+        static int Bucket(uint64_t ns) {
+            if (ns < 16) {
+                return static_cast<int>(ns);
+            }
+            const int e = 63 - __builtin_clzll(ns);
+            return std::min(Buckets - 1, 16 + (e - 4) * 8 + static_cast<int>((ns >> (e - 3)) & 7));
+        }
+
+        // The largest duration that falls in bucket b
+        static uint64_t BucketTop(int b) {
+            if (b < 16) {
+                return static_cast<uint64_t>(b);
+            }
+            const int e = (b - 16) / 8 + 4;
+            const uint64_t sub = static_cast<uint64_t>((b - 16) % 8);
+            return ((8 + sub + 1) << (e - 3)) - 1;
+        }
+
+        struct Node {
+            const char* name = "";
+            int parent = 0;
+            uint64_t count = 0;
+            uint64_t total = 0;
+            uint64_t min = 0;
+            uint64_t max = 0;
+            std::unique_ptr<std::array<uint32_t, Buckets>> histogram;
+
+            void Add(uint64_t ns) {
+                if (!histogram) {
+                    histogram = std::make_unique<std::array<uint32_t, Buckets>>();
+                    histogram->fill(0);
+                }
+                min = count == 0 ? ns : std::min(min, ns);
+                max = std::max(max, ns);
+                count++;
+                total += ns;
+                (*histogram)[Bucket(ns)]++;
+            }
+
+            void Merge(const Node& o) {
+                if (o.count == 0) {
+                    return;
+                }
+                if (!histogram) {
+                    histogram = std::make_unique<std::array<uint32_t, Buckets>>();
+                    histogram->fill(0);
+                }
+                min = count == 0 ? o.min : std::min(min, o.min);
+                max = std::max(max, o.max);
+                count += o.count;
+                total += o.total;
+                for (int b = 0; b < Buckets; b++) {
+                    (*histogram)[b] += (*o.histogram)[b];
+                }
+            }
+
+            void Clear() {
+                count = total = min = max = 0;
+                if (histogram) {
+                    histogram->fill(0);
+                }
+            }
+
+            uint64_t Percentile(double q) const {
+                if (count == 0) {
+                    return 0;
+                }
+                const auto rank = static_cast<uint64_t>(q * count + 0.999999);
+                uint64_t seen = 0;
+                for (int b = 0; b < Buckets; b++) {
+                    seen += (*histogram)[b];
+                    if (seen >= rank) {
+                        return std::min(max, std::max(min, BucketTop(b)));
+                    }
+                }
+                return max;
+            }
+        };
+
+        struct Event {
+            int node;
+            uint64_t start;
+            uint64_t duration;
+        };
+
+        struct ThreadData {
+            std::mutex mutex;
+            uint32_t id = 0;
+            // Node 0 is the root, above every outermost zone
+            std::vector<Node> nodes = std::vector<Node>(1);
+            std::vector<Event> events;
+            uint64_t dropped = 0;
+            // Owner thread only
+            int current = 0;
+
+            int Child(const char* name) {
+                for (size_t i = 1; i < nodes.size(); i++) {
+                    if (nodes[i].parent == current &&
+                        (nodes[i].name == name || std::strcmp(nodes[i].name, name) == 0)) {
+                        return static_cast<int>(i);
+                    }
+                }
+                Node n;
+                n.name = name;
+                n.parent = current;
+                nodes.push_back(std::move(n));
+                return static_cast<int>(nodes.size() - 1);
+            }
+
+            std::vector<std::string> Path(size_t i) const {
+                std::vector<std::string> path;
+                for (auto n = static_cast<int>(i); n != 0; n = nodes[n].parent) {
+                    path.insert(path.begin(), nodes[n].name);
+                }
+                return path;
+            }
+        };
+
+        Profiler()
+            : _epoch(Now())
+        { }
+
+        static Profiler& Instance() {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        static uint64_t Now() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // Threads keep their data after they exit so it can still be reported
+        ThreadData& Thread() {
+            static thread_local ThreadData* data = nullptr;
+            if (!data) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _threads.push_back(std::make_unique<ThreadData>());
+                data = _threads.back().get();
+                data->id = static_cast<uint32_t>(_threads.size());
+            }
+            return *data;
+        }
+
+        static inline std::atomic<bool> _enabled{false};
+
+        const uint64_t _epoch;
+        std::mutex _mutex;
+        std::vector<std::unique_ptr<ThreadData>> _threads;
+    };
+
+    class ProfileZone {
+    public:
+        explicit ProfileZone(const char* name)
+            : _thread(nullptr)
+        {
+            if (!Profiler::Enabled()) {
+                return;
+            }
+            _thread = &Profiler::Instance().Thread();
+            {
+                std::lock_guard<std::mutex> lock(_thread->mutex);
+                _node = _thread->Child(name);
+            }
+            _parent = _thread->current;
+            _thread->current = _node;
+            _start = Profiler::Now();
+        }
+
+        ~ProfileZone() {
+            if (!_thread) {
+                return;
+            }
+            const auto duration = Profiler::Now() - _start;
+            std::lock_guard<std::mutex> lock(_thread->mutex);
+            _thread->nodes[_node].Add(duration);
+            if (_thread->events.size() < Profiler::MaxEvents) {
+                _thread->events.push_back({ _node, _start, duration });
+            } else {
+                _thread->dropped++;
+            }
+            _thread->current = _parent;
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        Profiler::ThreadData* _thread;
+        int _node = 0;
+        int _parent = 0;
+        uint64_t _start = 0;
+    };
+}
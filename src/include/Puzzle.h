@@ -2,10 +2,12 @@
 
 #include <vector>
 #include <fstream>
+#include <istream>
 
 #include "Utils.h"
 #include "Piece.h"
 #include "Point.h"
+#include "Profiler.h"
 
 namespace TrainTracks
 {
@@ -37,16 +39,24 @@ namespace TrainTracks
         Data data;
 
         static Puzzle loadFromFile(std::string path) {
+            std::ifstream ifs;
+            ifs.open(path);
+            if (!ifs) {
+                throw std::runtime_error("Unable to open " + path);
+            }
+            return load(ifs);
+        }
+
+        // Reads the ROWS/COLS/FIXED text format
+        static Puzzle load(std::istream& is) {
+            PROFILE_ZONE("load");
             Puzzle puzzle;
 
             std::vector<std::pair<Point, Piece>> fixedPieces;
 
-            std::ifstream ifs;
-            ifs.open(path);
-
             bool fixed = false;
             std::string l;
-            while (getline(ifs, l)) {
+            while (getline(is, l)) {
                 std::string_view line{l.data(), l.size()};
                 if (startsWith(line, "#")) { continue; }
 
@@ -91,17 +101,95 @@ namespace TrainTracks
                 throw std::runtime_error("Invalid puzzle format. Missing ROWS or COLS.");
             }
 
-            puzzle.gridWidth = puzzle.data.rowConstraints.size();
-            puzzle.gridHeight = puzzle.data.colConstraints.size();
-            puzzle.data.startingGrid.resize(puzzle.gridWidth * puzzle.gridHeight);
+            // One constraint per column across, one per row down
+            puzzle.gridWidth = puzzle.data.colConstraints.size();
+            puzzle.gridHeight = puzzle.data.rowConstraints.size();
+            puzzle.data.startingGrid.resize(static_cast<size_t>(puzzle.gridWidth) * puzzle.gridHeight);
             
             for (const auto &fp : fixedPieces) {
-                puzzle.data.startingGrid[fp.first.project(puzzle.gridWidth)] = fp.second;
+                const auto& pt = fp.first;
+                if (pt.x < 0 || pt.y < 0 || pt.x >= puzzle.gridWidth || pt.y >= puzzle.gridHeight) {
+                    throw std::runtime_error("Invalid puzzle format. Fixed piece outside the grid.");
+                }
+                puzzle.data.startingGrid[pt.project(puzzle.gridWidth)] = fp.second;
+            }
+
+            return puzzle;
+        }
+
+        // Single-line JSON record, as read and written by the runner:
+        //   {"rows":[...],"cols":[...],"startingGrid":[...]}
+        // startingGrid is row-major Piece values (0=Empty, 3=Horizontal,
+        // 4=Vertical, 5=CornerNE, 6=CornerSE, 7=CornerSW, 8=CornerNW) and may
+        // be left out for an empty grid. Other keys are ignored.
+        static Puzzle fromJson(const std::string_view json) {
+            PROFILE_ZONE("load");
+            Puzzle puzzle;
+
+            const auto rows = json_value(json, "rows");
+            const auto cols = json_value(json, "cols");
+            if (!startsWith(rows, "[") || !startsWith(cols, "[")) {
+                throw std::runtime_error("Invalid puzzle format. Missing rows or cols.");
+            }
+            parse_as_integers(std::string(rows.substr(1)), ',', [&puzzle](int i) {
+                puzzle.data.rowConstraints.push_back(i);
+            });
+            parse_as_integers(std::string(cols.substr(1)), ',', [&puzzle](int i) {
+                puzzle.data.colConstraints.push_back(i);
+            });
+            if (puzzle.data.rowConstraints.empty() ||
+                puzzle.data.colConstraints.empty()) {
+                throw std::runtime_error("Invalid puzzle format. Missing rows or cols.");
+            }
+
+            puzzle.gridWidth = puzzle.data.colConstraints.size();
+            puzzle.gridHeight = puzzle.data.rowConstraints.size();
+            const size_t cells = static_cast<size_t>(puzzle.gridWidth) * puzzle.gridHeight;
+
+            const auto grid = json_value(json, "startingGrid");
+            if (startsWith(grid, "[")) {
+                std::vector<int> values;
+                parse_as_integers(std::string(grid.substr(1)), ',', [&values](int i) {
+                    values.push_back(i);
+                });
+                for (const auto i : values) {
+                    if (i != 0 && (i < static_cast<int>(Piece::Horizontal) || i > static_cast<int>(Piece::CornerNW))) {
+                        throw std::runtime_error("Invalid piece type");
+                    }
+                    puzzle.data.startingGrid.push_back(static_cast<Piece>(i));
+                }
+            }
+            if (puzzle.data.startingGrid.empty()) {
+                puzzle.data.startingGrid.resize(cells, Piece::Empty);
+            }
+            if (puzzle.data.startingGrid.size() != cells) {
+                throw std::runtime_error("Invalid puzzle format. startingGrid doesn't match rows and cols.");
             }
 
             return puzzle;
         }
 
+        std::string toJson() const {
+            std::string out;
+            const auto appendInts = [&out](const auto& values) {
+                out.append(1, '[');
+                for (size_t i = 0; i < values.size(); i++) {
+                    if (i) { out.append(1, ','); }
+                    out.append(std::to_string(static_cast<int>(values[i])));
+                }
+                out.append(1, ']');
+            };
+
+            out.append("{\"rows\":");
+            appendInts(data.rowConstraints);
+            out.append(",\"cols\":");
+            appendInts(data.colConstraints);
+            out.append(",\"startingGrid\":");
+            appendInts(data.startingGrid);
+            out.append(1, '}');
+            return out;
+        }
+
         std::string toString() {
             std::string out;
 
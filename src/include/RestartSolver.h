@@ -0,0 +1,168 @@
+#pragma once
+
+#include "PathSolver.h"
+#include "Solver.h"
+
+#include <cmath>
+#include <vector>
+
+namespace TrainTracks
+{
+
+    enum class RestartSchedule {
+        // scale * 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, ...
+        Luby,
+        // scale * 1, growth, growth^2, ...
+        Geometric,
+    };
+
+    struct RestartOptions {
+        // Seeds every attempt's candidate shuffle, the same seed gives the
+        // same run
+        uint64_t seed = 1;
+        RestartSchedule schedule = RestartSchedule::Luby;
+        // Steps in one unit of the schedule
+        uint64_t scale = 4096;
+        // Multiplier between attempts for the geometric schedule
+        double growth = 1.5;
+        // Candidate order and direction for each attempt, the seed is
+        // replaced per attempt
+        PathSolverOptions path;
+    };
+
+    struct RestartStats {
+        uint64_t attempts = 0;
+        // Cutoff of the final attempt and the largest given to any attempt
+        uint64_t lastCutoff = 0;
+        uint64_t maxCutoff = 0;
+        // Seed of the final attempt, reusing it on its own replays that attempt
+        uint64_t lastSeed = 0;
+        // Steps each attempt took
+        std::vector<uint64_t> attemptSteps;
+
+        uint64_t restarts() const {
+            return attempts == 0 ? 0 : attempts - 1;
+        }
+    };
+
+    // Runs a PathSolver with shuffled candidates up to a step cutoff, then
+    // starts over with a new shuffle and the next cutoff in the schedule.
+    // Cutoffs keep growing so the search stays complete: an attempt which
+    // finishes within its cutoff without a solution proves there is none.
+    class RestartSolver
+        : public Solver {
+
+    public:
+        RestartSolver(const RestartOptions& options = RestartOptions())
+            : Solver()
+            , _config(options)
+        {
+            if (options.scale == 0) {
+                throw std::runtime_error("Restart scale must be positive");
+            }
+            if (options.schedule == RestartSchedule::Geometric && options.growth < 1.0) {
+                throw std::runtime_error("Restart growth must be at least 1");
+            }
+        }
+
+        using Solver::Solve;
+
+        bool Solve(Grid& grid) override {
+            _stats = RestartStats();
+            const uint64_t budget = _options.maxSteps;
+            uint64_t used = 0;
+            uint64_t seed = _config.seed;
+
+            for (uint64_t attempt = 1; ; attempt++) {
+                PathSolverOptions path = _config.path;
+                path.seed = NextSeed(seed);
+                PathSolver solver(path);
+                solver.Domains(_domains);
+                solver.Reporter(_reporter);
+                solver.Recorder(_recorder);
+
+                SolveOptions options;
+                options.deadline = _options.deadline;
+                options.cancel = _options.cancel;
+                options.shutdown = _options.shutdown;
+                options.maxSteps = Cutoff(attempt);
+                const bool lastAttempt = budget != 0 && budget - used <= options.maxSteps;
+                if (lastAttempt) {
+                    options.maxSteps = budget - used;
+                }
+
+                const auto result = solver.Solve(grid, options);
+                used += result.steps;
+                _steps += result.steps;
+                _stats.attempts = attempt;
+                _stats.lastCutoff = options.maxSteps;
+                _stats.maxCutoff = std::max(_stats.maxCutoff, options.maxSteps);
+                _stats.lastSeed = path.seed;
+                _stats.attemptSteps.push_back(result.steps);
+                _innerBytes = std::max(_innerBytes, result.peakBytes);
+
+                switch (result.status) {
+                    case SolveStatus::Solved:
+                        return true;
+                    case SolveStatus::Unsolvable:
+                        return false;
+                    case SolveStatus::Cancelled:
+                        Interrupt(SolveStatus::Cancelled);
+                        return false;
+                    case SolveStatus::TimedOut:
+                        if (lastAttempt || SolveClock::now() >= _options.deadline) {
+                            Interrupt(SolveStatus::TimedOut);
+                            return false;
+                        }
+                        break;
+                }
+            }
+        }
+
+        // Statistics for the last solve
+        const RestartStats& Stats() const {
+            return _stats;
+        }
+
+        // The step cutoff for a 1-based attempt
+        uint64_t Cutoff(uint64_t attempt) const {
+            if (_config.schedule == RestartSchedule::Luby) {
+                return Saturate(static_cast<double>(_config.scale) * Luby(attempt));
+            }
+            return Saturate(_config.scale * std::pow(_config.growth, static_cast<double>(attempt - 1)));
+        }
+
+        // 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ... for i from 1
+        static uint64_t Luby(uint64_t i) {
+            for (;;) {
+                int k = 1;
+                while (k < 63 && ((1ull << k) - 1) < i) {
+                    k++;
+                }
+                if (i == (1ull << k) - 1) {
+                    return 1ull << (k - 1);
+                }
+                i -= (1ull << (k - 1)) - 1;
+            }
+        }
+
+    private:
+        static uint64_t Saturate(double steps) {
+            constexpr double Max = static_cast<double>(std::numeric_limits<uint64_t>::max() / 2);
+            return steps >= Max ? static_cast<uint64_t>(Max) : static_cast<uint64_t>(steps);
+        }
+
+        // splitmix64, so neighbouring seeds give unrelated shuffles. Never
+        // returns 0, which would turn shuffling off.
+        static uint64_t NextSeed(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            return z == 0 ? 1 : z;
+        }
+
+        const RestartOptions _config;
+        RestartStats _stats;
+    };
+} // namespace TrainTracks
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "Grid.h"
+#include "Solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace TrainTracks {
+
+    // Writes a solver's decisions to a stream, four bytes each: the event in
+    // the top two bits, the piece in the next four and the cell below. The
+    // search depth isn't stored, SearchReplay rebuilds it from the nesting
+    // of Try and Fail. Steps off the grid aren't recorded. The end of a
+    // solve is a Visit to EndCell with the SolveStatus in place of the piece.
+    class SearchLog
+        : public SearchRecorder {
+
+    public:
+        enum class Event : uint32_t {
+            Visit = 0,
+            Try = 1,
+            Fail = 2,
+            Prune = 3,
+        };
+
+        static constexpr char Magic[8] = { 'T', 'T', 'S', 'E', 'A', 'R', 'C', 'H' };
+        static constexpr uint32_t CellBits = 26;
+        // Never a cell, the grid has fewer
+        static constexpr uint32_t EndCell = (1u << CellBits) - 1;
+
+        SearchLog(std::ostream& out, const Grid& grid)
+            : _out(out)
+            , _width(grid.width())
+            , _height(grid.height())
+            , _events(0)
+        {
+            if (grid.cells() >= (1u << CellBits)) {
+                throw std::runtime_error("Grid too large to record");
+            }
+            _buffer.reserve(BufferEvents);
+            const int32_t header[] = { _width, _height, grid.entry().x, grid.entry().y, grid.exit().x, grid.exit().y };
+            _out.write(Magic, sizeof(Magic));
+            _out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            for (int y = 0; y < _height; y++) {
+                for (int x = 0; x < _width; x++) {
+                    const auto p = static_cast<uint8_t>(grid.at(x, y));
+                    _out.put(static_cast<char>(p));
+                }
+            }
+        }
+
+        ~SearchLog() {
+            Flush();
+        }
+
+        void Visit(const Point& pos) override {
+            if (pos.x >= 0 && pos.y >= 0 && pos.x < _width && pos.y < _height) {
+                Put(Event::Visit, pos, Piece::Empty);
+            }
+        }
+
+        void Try(const Point& pos, Piece p) override {
+            Put(Event::Try, pos, p);
+        }
+
+        void Fail(const Point& pos, Piece p) override {
+            Put(Event::Fail, pos, p);
+        }
+
+        void Prune(const Point& pos) override {
+            Put(Event::Prune, pos, Piece::Empty);
+        }
+
+        void End(SolveStatus status) override {
+            Put((static_cast<uint32_t>(Event::Visit) << 30) | (static_cast<uint32_t>(status) << CellBits) | EndCell);
+        }
+
+        void Flush() {
+            if (!_buffer.empty()) {
+                _out.write(reinterpret_cast<const char*>(_buffer.data()),
+                    static_cast<std::streamsize>(_buffer.size() * sizeof(uint32_t)));
+                _buffer.clear();
+            }
+            _out.flush();
+        }
+
+        uint64_t Events() const {
+            return _events;
+        }
+
+    private:
+        static constexpr size_t BufferEvents = 1 << 14;
+
+        void Put(Event e, const Point& pos, Piece p) {
+            Put((static_cast<uint32_t>(e) << 30) | (static_cast<uint32_t>(p) << CellBits) |
+                static_cast<uint32_t>(pos.project(_width)));
+        }
+
+        void Put(uint32_t event) {
+            _buffer.push_back(event);
+            _events++;
+            if (_buffer.size() == BufferEvents) {
+                Flush();
+            }
+        }
+
+        std::ostream& _out;
+        const int _width;
+        const int _height;
+        std::vector<uint32_t> _buffer;
+        uint64_t _events;
+    };
+
+    // A failed piece and everything searched below it
+    struct FailedSubtree {
+        Point pos;
+        Piece piece = Piece::Empty;
+        // Pieces placed above it, 0 for the first
+        int depth = 0;
+        // Levels explored below it
+        int height = 0;
+        uint64_t visits = 0;
+    };
+
+    // Rebuilds a recorded search: per cell counts, and the failed subtrees
+    // which cost the most visits.
+    class SearchReplay {
+    public:
+        // Reads a SearchLog, keeping the `top` largest failed subtrees
+        explicit SearchReplay(std::istream& in, size_t top = 10)
+            : _visits(0)
+            , _tries(0)
+            , _fails(0)
+            , _prunes(0)
+            , _maxDepth(0)
+        {
+            char magic[sizeof(SearchLog::Magic)];
+            int32_t header[6];
+            if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, SearchLog::Magic, sizeof(magic)) != 0 ||
+                !in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+                header[0] <= 0 || header[1] <= 0) {
+                throw std::runtime_error("Not a search log");
+            }
+            _width = header[0];
+            _height = header[1];
+            const auto cells = static_cast<size_t>(_width) * _height;
+            _start.resize(cells);
+            for (auto& p : _start) {
+                p = static_cast<Piece>(in.get());
+            }
+            if (!in) {
+                throw std::runtime_error("Truncated search log");
+            }
+            _cellVisits.assign(cells, 0);
+            _cellFails.assign(cells, 0);
+            _cellPrunes.assign(cells, 0);
+            _final.assign(_start.begin(), _start.end());
+
+            struct Frame {
+                uint32_t cell;
+                Piece piece;
+                uint64_t visits;
+                int deepest;
+            };
+            std::vector<Frame> stack;
+            // Smallest kept subtree on top, so it is the one to go
+            const auto larger = [](const FailedSubtree& l, const FailedSubtree& r) { return l.visits > r.visits; };
+            std::priority_queue<FailedSubtree, std::vector<FailedSubtree>, decltype(larger)> kept(larger);
+
+            uint32_t buffer[4096];
+            while (in) {
+                in.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+                const auto n = static_cast<size_t>(in.gcount()) / sizeof(uint32_t);
+                for (size_t i = 0; i < n; i++) {
+                    const auto e = buffer[i] >> 30;
+                    const auto piece = static_cast<Piece>((buffer[i] >> SearchLog::CellBits) & 0xF);
+                    const auto cell = buffer[i] & ((1u << SearchLog::CellBits) - 1);
+                    if (cell == SearchLog::EndCell && static_cast<SearchLog::Event>(e) == SearchLog::Event::Visit) {
+                        const auto status = (buffer[i] >> SearchLog::CellBits) & 0xF;
+                        if (status > static_cast<uint32_t>(SolveStatus::Cancelled)) {
+                            throw std::runtime_error("Corrupt search log");
+                        }
+                        _status = static_cast<SolveStatus>(status);
+                        continue;
+                    }
+                    if (cell >= cells) {
+                        throw std::runtime_error("Corrupt search log");
+                    }
+                    switch (static_cast<SearchLog::Event>(e)) {
+                        case SearchLog::Event::Visit:
+                            _visits++;
+                            _cellVisits[cell]++;
+                            break;
+                        case SearchLog::Event::Try:
+                            _tries++;
+                            stack.push_back({ cell, piece, _visits, static_cast<int>(stack.size()) + 1 });
+                            _maxDepth = std::max(_maxDepth, static_cast<int>(stack.size()));
+                            _final[cell] = piece;
+                            break;
+                        case SearchLog::Event::Fail: {
+                            if (stack.empty() || stack.back().cell != cell) {
+                                throw std::runtime_error("Unbalanced search log");
+                            }
+                            _fails++;
+                            _cellFails[cell]++;
+                            const auto frame = stack.back();
+                            stack.pop_back();
+                            const int depth = static_cast<int>(stack.size());
+                            if (!stack.empty()) {
+                                stack.back().deepest = std::max(stack.back().deepest, frame.deepest);
+                            }
+                            _final[cell] = _start[cell];
+
+                            FailedSubtree f;
+                            f.pos = Point{static_cast<int>(cell % _width), static_cast<int>(cell / _width)};
+                            f.piece = frame.piece;
+                            f.depth = depth;
+                            f.height = frame.deepest - depth - 1;
+                            f.visits = _visits - frame.visits;
+                            if (kept.size() < top) {
+                                kept.push(f);
+                            } else if (top > 0 && f.visits > kept.top().visits) {
+                                kept.pop();
+                                kept.push(f);
+                            }
+                            break;
+                        }
+                        case SearchLog::Event::Prune:
+                            _prunes++;
+                            _cellPrunes[cell]++;
+                            break;
+                    }
+                }
+            }
+
+            while (!kept.empty()) {
+                _failed.push_back(kept.top());
+                kept.pop();
+            }
+            std::reverse(_failed.begin(), _failed.end());
+        }
+
+        int width() const { return _width; }
+        int height() const { return _height; }
+
+        uint64_t Visits() const { return _visits; }
+        uint64_t Tries() const { return _tries; }
+        uint64_t Fails() const { return _fails; }
+        uint64_t Prunes() const { return _prunes; }
+        int MaxDepth() const { return _maxDepth; }
+        // How the recorded solve ended, unset if the recording stops short
+        std::optional<SolveStatus> Status() const { return _status; }
+        bool Solved() const { return _status == SolveStatus::Solved; }
+
+        uint64_t Visits(const Point& pt) const { return _cellVisits[pt.project(_width)]; }
+        uint64_t Backtracks(const Point& pt) const { return _cellFails[pt.project(_width)]; }
+        uint64_t Prunes(const Point& pt) const { return _cellPrunes[pt.project(_width)]; }
+
+        // Largest first
+        const std::vector<FailedSubtree>& LargestFailures() const {
+            return _failed;
+        }
+
+        // Totals, a heatmap each of visits, backtracks and prunes, and the
+        // largest failed subtrees
+        void Print(std::ostream& os) const {
+            os << "Visits: " << _visits << ", tries: " << _tries << ", backtracks: " << _fails
+               << ", prunes: " << _prunes << ", max depth: " << _maxDepth
+               << (Solved() ? ", solved" : ", not solved");
+            if (_status && !Solved()) {
+                os << " (" << *_status << ")";
+            }
+            os << "\n\n";
+            PrintHeatmap(os, "Visits", _cellVisits);
+            PrintHeatmap(os, "Backtracks", _cellFails);
+            PrintHeatmap(os, "Prunes", _cellPrunes);
+
+            if (!_failed.empty()) {
+                os << "Largest failed subtrees:\n";
+                os << "  " << std::setw(10) << "visits" << std::setw(7) << "depth" << std::setw(8) << "height"
+                   << "  cell     piece\n";
+                for (const auto& f : _failed) {
+                    std::ostringstream cell;
+                    cell << f.pos;
+                    os << "  " << std::setw(10) << f.visits << std::setw(7) << f.depth << std::setw(8) << f.height
+                       << "  " << std::left << std::setw(9) << cell.str() << std::right << PieceSymbol(f.piece) << "\n";
+                }
+            }
+        }
+
+    private:
+        // Each cell drawn with a shade from ' ' (none) to '@' (the busiest),
+        // scaled logarithmically since counts span orders of magnitude.
+        // Cells the recording ended with a piece in show the piece.
+        void PrintHeatmap(std::ostream& os, const char* title, const std::vector<uint64_t>& counts) const {
+            static const char Ramp[] = " .:-=+*#%@";
+            constexpr int Shades = sizeof(Ramp) - 2;
+
+            const auto most = std::max_element(counts.begin(), counts.end());
+            const auto max = most == counts.end() ? 0 : *most;
+            os << title << " (max " << max;
+            if (max > 0) {
+                const auto cell = static_cast<int>(most - counts.begin());
+                os << " at " << Point{cell % _width, cell / _width};
+            }
+            os << ")\n";
+
+            const auto scale = max > 1 ? std::log(static_cast<double>(max)) : 1.0;
+            for (int y = 0; y < _height; y++) {
+                os << "  ";
+                for (int x = 0; x < _width; x++) {
+                    const auto c = counts[static_cast<size_t>(y) * _width + x];
+                    int shade = 0;
+                    if (c > 0) {
+                        shade = 1 + static_cast<int>(std::log(static_cast<double>(c)) / scale * (Shades - 1) + 0.5);
+                    }
+                    os << Ramp[shade] << Ramp[shade];
+                }
+                os << "   ";
+                for (int x = 0; x < _width; x++) {
+                    os << PieceSymbol(_final[static_cast<size_t>(y) * _width + x]);
+                }
+                os << "\n";
+            }
+            os << "\n";
+        }
+
+        int _width = 0;
+        int _height = 0;
+        std::vector<Piece> _start;
+        std::vector<Piece> _final;
+        std::vector<uint64_t> _cellVisits;
+        std::vector<uint64_t> _cellFails;
+        std::vector<uint64_t> _cellPrunes;
+        std::vector<FailedSubtree> _failed;
+        uint64_t _visits;
+        uint64_t _tries;
+        uint64_t _fails;
+        uint64_t _prunes;
+        int _maxDepth;
+        std::optional<SolveStatus> _status;
+    };
+}
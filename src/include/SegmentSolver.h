@@ -0,0 +1,315 @@
+#pragma once
+
+#include "Solver.h"
+#include <array>
+
+#include "Debug.h"
+
+namespace TrainTracks
+{
+
+    // Treats every piece already on the grid (fixed, or placed by
+    // placeObviousPieces) as part of a pre-built path fragment. Adjacent
+    // pieces which connect to each other are merged into segments with two
+    // open ends, and the search only grows segments from those ends, picking
+    // the end with the fewest legal pieces first, until the entry and exit are
+    // joined through every segment.
+    class SegmentSolver
+        : public Solver {
+
+    public:
+        SegmentSolver()
+            : Solver()
+        { }
+
+        using Solver::Solve;
+
+        bool Solve(Grid& grid) override {
+            if (!BuildSegments(grid)) {
+                return false;
+            }
+
+            DEBUG_LOG(grid.entry(), grid.exit(), _endCount);
+
+            return Join(grid);
+        }
+
+    protected:
+        // Walks every filled cell, pairing up the two ends of each chain of
+        // mutually connected pieces. Returns false if the fixed pieces can
+        // never be part of a single path (mismatched stubs or a closed loop).
+        bool BuildSegments(const Grid& grid) {
+            _width = grid.width();
+            const auto cells = static_cast<int>(grid.cells());
+
+            _arena.Reset();
+            _partner = _arena.Allocate<int>(cells, -1);
+            _endSlot = _arena.Allocate<int>(cells, -1);
+            _ends = _arena.Allocate<int>(cells);
+            _endCount = 0;
+
+            auto* links = _arena.Allocate<int>(cells, 0);
+            for (int idx = 0; idx < cells; idx++) {
+                const auto pt = toPoint(idx);
+                const auto p = grid.at(pt);
+                if (p == Piece::Empty) { continue; }
+
+                for (const auto& d : Connections::GetConnections(p)) {
+                    const auto n = pt + d;
+                    if (!grid.isInBounds(n) || grid.isEmpty(n)) { continue; }
+                    if (!Connections::ConnectsTo(grid.at(n), d.inverse())) {
+                        DEBUG_LOG(pt, n, p, grid.at(n));
+                        return false;
+                    }
+                    links[idx]++;
+                }
+            }
+
+            auto* seen = _arena.Allocate<bool>(cells, false);
+            for (int idx = 0; idx < cells; idx++) {
+                if (grid.at(toPoint(idx)) == Piece::Empty || links[idx] == 2 || seen[idx]) {
+                    continue;
+                }
+
+                // Follow the chain to its other end
+                int prev = -1;
+                int cur = idx;
+                seen[cur] = true;
+                for (;;) {
+                    const auto pt = toPoint(cur);
+                    int next = -1;
+                    for (const auto& d : Connections::GetConnections(grid.at(pt))) {
+                        const auto n = pt + d;
+                        if (!grid.isInBounds(n) || grid.isEmpty(n)) { continue; }
+                        const auto nidx = toIndex(n);
+                        if (nidx != prev) {
+                            next = nidx;
+                            break;
+                        }
+                    }
+                    if (next < 0) { break; }
+                    prev = cur;
+                    cur = next;
+                    seen[cur] = true;
+                }
+
+                _partner[idx] = cur;
+                _partner[cur] = idx;
+                addEnd(idx);
+                if (cur != idx) {
+                    addEnd(cur);
+                }
+            }
+
+            // Anything left unvisited is a closed loop of fixed pieces
+            for (int idx = 0; idx < cells; idx++) {
+                if (grid.at(toPoint(idx)) != Piece::Empty && !seen[idx]) {
+                    DEBUG_LOG(toPoint(idx));
+                    return false;
+                }
+            }
+
+            _entryIdx = toIndex(grid.entry());
+            _exitIdx = toIndex(grid.exit());
+            return true;
+        }
+
+        bool Join(Grid& grid) {
+            if (_partner[_entryIdx] == _exitIdx) {
+                // Entry and exit are joined, every other segment must be too
+                return _endCount == 2 && grid.isComplete();
+            }
+
+            // Pick the open end with the fewest legal pieces
+            int bestEnd = -1;
+            Point bestDir;
+            int bestCount = static_cast<int>(ValidPieces.size()) + 1;
+            std::array<Piece, 6> candidates;
+
+            for (int i = 0; i < _endCount; i++) {
+                const auto e = _ends[i];
+                const auto pt = toPoint(e);
+                for (const auto& d : Connections::GetConnections(grid.at(pt))) {
+                    const auto n = pt + d;
+                    if (!grid.isInBounds(n) || !grid.isEmpty(n)) { continue; }
+
+                    int count = 0;
+                    for (const auto p : ValidPieces) {
+                        if (Connections::ConnectsTo(p, d.inverse()) && Allowed(n, p) && grid.canPlace(n, p)) {
+                            count++;
+                        }
+                    }
+
+                    if (count == 0) {
+                        // This end can never be closed off
+                        DEBUG_LOG(pt, d);
+                        Pruned(n);
+                        return false;
+                    }
+                    if (count < bestCount) {
+                        bestCount = count;
+                        bestEnd = e;
+                        bestDir = d;
+                    }
+                }
+            }
+
+            if (bestEnd < 0) {
+                return false;
+            }
+
+            const auto from = toPoint(bestEnd);
+            const auto pos = from + bestDir;
+            int count = 0;
+            for (const auto p : ValidPieces) {
+                if (Connections::ConnectsTo(p, bestDir.inverse()) && Allowed(pos, p) && grid.canPlace(pos, p)) {
+                    candidates[count++] = p;
+                }
+            }
+
+            for (int i = 0; i < count; i++) {
+                Step(pos);
+                if (Interrupted()) {
+                    break;
+                }
+                Undo undo;
+                if (!Extend(grid, bestEnd, pos, candidates[i], undo)) {
+                    Pruned(pos);
+                    continue;
+                }
+                Tried(pos, candidates[i]);
+                if (Join(grid)) {
+                    return true;
+                }
+                Failed(pos, candidates[i]);
+                Retract(grid, pos, undo);
+                if (Interrupted()) {
+                    break;
+                }
+            }
+
+            return false;
+        }
+
+        struct Undo {
+            std::array<std::pair<int, int>, 5> partners;
+            int partnerCount = 0;
+            std::array<int, 2> removed{ -1, -1 };
+            int added = -1;
+        };
+
+        // Places piece p at pos, joined to the segment end `from`. The far
+        // side of p either opens a new end or closes onto another segment.
+        bool Extend(Grid& grid, int from, const Point& pos, Piece p, Undo& undo) {
+            const auto idx = toIndex(pos);
+            const auto other = _partner[from];
+            const auto back = toPoint(from) - pos;
+
+            Point out;
+            for (const auto& d : Connections::GetConnections(p)) {
+                if (d != back) {
+                    out = d;
+                }
+            }
+
+            const auto next = pos + out;
+            if (grid.isInBounds(next) && grid.isFilled(next)) {
+                // canPlace guarantees next connects back to us, so it is an end
+                const auto nidx = toIndex(next);
+                if (nidx == other) {
+                    // Closing our own segment into a loop
+                    return false;
+                }
+                const auto far = _partner[nidx];
+
+                grid.place(pos, p);
+                save(undo, from);
+                save(undo, other);
+                save(undo, nidx);
+                save(undo, far);
+                if (from != other) {
+                    removeEnd(from, undo);
+                    _partner[from] = -1;
+                }
+                if (nidx != far) {
+                    removeEnd(nidx, undo);
+                    _partner[nidx] = -1;
+                }
+                _partner[other] = far;
+                _partner[far] = other;
+            } else {
+                grid.place(pos, p);
+                save(undo, from);
+                save(undo, other);
+                save(undo, idx);
+                if (from != other) {
+                    removeEnd(from, undo);
+                    _partner[from] = -1;
+                }
+                addEnd(idx);
+                undo.added = idx;
+                _partner[idx] = other;
+                _partner[other] = idx;
+            }
+
+            return true;
+        }
+
+        void Retract(Grid& grid, const Point& pos, const Undo& undo) {
+            grid.remove(pos);
+            if (undo.added >= 0) {
+                dropEnd(undo.added);
+            }
+            for (const auto r : undo.removed) {
+                if (r >= 0) {
+                    addEnd(r);
+                }
+            }
+            for (int i = undo.partnerCount - 1; i >= 0; i--) {
+                _partner[undo.partners[i].first] = undo.partners[i].second;
+            }
+        }
+
+        void save(Undo& undo, int idx) {
+            undo.partners[undo.partnerCount++] = { idx, _partner[idx] };
+        }
+
+        void addEnd(int idx) {
+            _endSlot[idx] = _endCount;
+            _ends[_endCount++] = idx;
+        }
+
+        void dropEnd(int idx) {
+            const auto slot = _endSlot[idx];
+            const auto last = _ends[--_endCount];
+            _ends[slot] = last;
+            _endSlot[last] = slot;
+            _endSlot[idx] = -1;
+        }
+
+        void removeEnd(int idx, Undo& undo) {
+            dropEnd(idx);
+            undo.removed[undo.removed[0] < 0 ? 0 : 1] = idx;
+        }
+
+        Point toPoint(int idx) const {
+            return Point{ idx % _width, idx / _width };
+        }
+
+        int toIndex(const Point& pt) const {
+            return static_cast<int>(pt.project(_width));
+        }
+
+        int _width = 0;
+        int _entryIdx = -1;
+        int _exitIdx = -1;
+
+        // Arena backed, indexed by cell. For each segment end, the cell at
+        // the other end of its segment
+        int* _partner = nullptr;
+        // Open segment ends, and where each cell sits in that list
+        int* _ends = nullptr;
+        int* _endSlot = nullptr;
+        int _endCount = 0;
+    };
+} // namespace TrainTracks
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Utils.h"
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace TrainTracks {
+
+    // One part of a PathSolver search split up to run elsewhere: the grid
+    // the split searched and a prefix of the path, see PathSolver::Split.
+    // Shards are written one per line:
+    //   {"shard":3,"rows":[...],"cols":[...],"startingGrid":[...],
+    //    "from_exit":false,"depth":2,"steps":40,"path":[0,1,3,1,1,7]}
+    // startingGrid is the grid once presolved, so a shard is also a
+    // Puzzle::fromJson record, and path holds x,y,piece for each cell of
+    // the prefix from the start.
+    struct Shard {
+        uint64_t index = 0;
+        Puzzle puzzle;
+        bool fromExit = false;
+        PathPrefix prefix;
+
+        std::string toJson() const {
+            const auto record = puzzle.toJson();
+            std::string out = "{\"shard\":" + std::to_string(index) + ",";
+            out.append(record, 1, record.size() - 2);
+            out.append(",\"from_exit\":").append(fromExit ? "true" : "false");
+            out.append(",\"depth\":").append(std::to_string(prefix.path.size()));
+            out.append(",\"steps\":").append(std::to_string(prefix.steps));
+            out.append(",\"path\":[");
+            for (size_t i = 0; i < prefix.path.size(); i++) {
+                const auto& [pt, piece] = prefix.path[i];
+                if (i) { out.append(1, ','); }
+                out.append(std::to_string(pt.x)).append(1, ',').append(std::to_string(pt.y));
+                out.append(1, ',').append(std::to_string(static_cast<int>(piece)));
+            }
+            out.append("]}");
+            return out;
+        }
+
+        static Shard fromJson(const std::string_view json) {
+            Shard shard;
+            const auto index = json_value(json, "shard");
+            if (index.empty()) {
+                throw std::runtime_error("Invalid shard. Missing shard.");
+            }
+            shard.index = std::stoull(std::string(index));
+            shard.puzzle = Puzzle::fromJson(json);
+            shard.fromExit = json_value(json, "from_exit") == "true";
+            const auto steps = json_value(json, "steps");
+            shard.prefix.steps = steps.empty() ? 0 : std::stoull(std::string(steps));
+
+            const auto path = json_value(json, "path");
+            if (!startsWith(path, "[")) {
+                throw std::runtime_error("Invalid shard. Missing path.");
+            }
+            std::vector<int> values;
+            parse_as_integers(std::string(path.substr(1)), ',', [&values](int i) {
+                values.push_back(i);
+            });
+            if (values.size() % 3 != 0) {
+                throw std::runtime_error("Invalid shard. path isn't x,y,piece triples.");
+            }
+            for (size_t i = 0; i < values.size(); i += 3) {
+                const auto piece = values[i + 2];
+                if (piece < static_cast<int>(Piece::Horizontal) || piece > static_cast<int>(Piece::CornerNW)) {
+                    throw std::runtime_error("Invalid piece type");
+                }
+                shard.prefix.path.emplace_back(Point{values[i], values[i + 1]}, static_cast<Piece>(piece));
+            }
+            return shard;
+        }
+    };
+
+    struct ShardSplit {
+        // Solved (with the solution) if the split finished the path itself,
+        // Unsolvable with no shards if it ran out of branches first
+        SolveResult result;
+        std::vector<Shard> shards;
+    };
+
+    // Row-major cells of a solved grid, for SolveResult::solution
+    inline void TakeSolution(const Grid& grid, SolveResult& result) {
+        result.solution.reserve(grid.cells());
+        for (int y = 0; y < grid.height(); y++) {
+            for (int x = 0; x < grid.width(); x++) {
+                result.solution.push_back(grid.at(x, y));
+            }
+        }
+    }
+
+    // Searches the grid depth cells along the path and makes a shard of
+    // each branch still open there, numbered in search order
+    inline ShardSplit SplitIntoShards(Grid& grid, int depth, const PathSolverOptions& config = PathSolverOptions(),
+        const SolveOptions& options = SolveOptions()) {
+        ShardSplit split;
+        const auto puzzle = grid.toPuzzle();
+        PathSolver solver(config);
+        std::vector<PathPrefix> frontier;
+        split.result = solver.Split(grid, depth, frontier, options);
+        if (split.result.solved()) {
+            TakeSolution(grid, split.result);
+            return split;
+        }
+        if (split.result.status != SolveStatus::Unsolvable) {
+            return split;
+        }
+        split.shards.reserve(frontier.size());
+        for (auto& prefix : frontier) {
+            Shard shard;
+            shard.index = split.shards.size();
+            shard.puzzle = puzzle;
+            shard.fromExit = config.fromExit;
+            shard.prefix = std::move(prefix);
+            split.shards.push_back(std::move(shard));
+        }
+        return split;
+    }
+
+    // Searches what a shard left of the search, with the solution filled
+    // in if it solved
+    inline SolveResult SolveShard(const Shard& shard, const SolveOptions& options = SolveOptions()) {
+        PathSolverOptions config;
+        config.fromExit = shard.fromExit;
+        PathSolver solver(config);
+        Grid grid(shard.puzzle);
+        auto result = solver.Resume(grid, shard.prefix, options);
+        if (result.solved()) {
+            TakeSolution(grid, result);
+        }
+        return result;
+    }
+}
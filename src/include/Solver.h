@@ -1,7 +1,15 @@
 #pragma once
 
+#include "Arena.h"
 #include "Grid.h"
+#include "Domains.h"
+#include "Profiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
 #include <memory>
 
 namespace TrainTracks
@@ -23,33 +31,247 @@ namespace TrainTracks
         uint64_t interval;
     };
 
+    enum class SolveStatus;
+
+    // Receives each decision the search makes, see SearchLog for one which
+    // writes them to a file. Positions passed to Visit may be off the grid.
+    class SearchRecorder {
+    public:
+        virtual ~SearchRecorder() { }
+
+        // Every step, wherever the search looked
+        virtual void Visit(const Point& pos) = 0;
+        // Piece p at pos is being explored, one level deeper
+        virtual void Try(const Point& pos, Piece p) = 0;
+        // Everything below Try(pos, p) failed, back up a level
+        virtual void Fail(const Point& pos, Piece p) = 0;
+        // pos was ruled out by a cut or learned nogood before trying it
+        virtual void Prune(const Point& pos) = 0;
+        // A solve finished. Solvers which hand the search to others record
+        // one per inner solve before their own, so the last is the outcome.
+        virtual void End(SolveStatus) { }
+    };
+
+    enum class SolveStatus {
+        Solved,
+        Unsolvable,
+        TimedOut,
+        Cancelled,
+    };
+
+    inline const char* SolveStatusName(SolveStatus s) {
+        switch (s) {
+            case SolveStatus::Solved: return "Solved";
+            case SolveStatus::Unsolvable: return "Unsolvable";
+            case SolveStatus::TimedOut: return "TimedOut";
+            case SolveStatus::Cancelled: return "Cancelled";
+        }
+        return "?";
+    }
+
+    inline std::ostream& operator<<(std::ostream& os, SolveStatus s) {
+        return os << SolveStatusName(s);
+    }
+
+    using SolveClock = std::chrono::steady_clock;
+
+    struct SolveOptions {
+        // Wall clock time to give up at
+        SolveClock::time_point deadline = SolveClock::time_point::max();
+        // Time allowed once solving starts, 0 for no limit. Unlike the
+        // deadline this doesn't count time spent queued.
+        std::chrono::nanoseconds timeout{0};
+        // Maximum steps for this solve, 0 for no limit
+        uint64_t maxSteps = 0;
+        // Polled while solving, the solve stops once it is set
+        const std::atomic<bool>* cancel = nullptr;
+        // Polled like cancel, for whatever runs the solve on the caller's
+        // behalf (a SolverPool sets it when destroyed)
+        const std::atomic<bool>* shutdown = nullptr;
+
+        bool cancelled() const {
+            return (cancel && cancel->load(std::memory_order_relaxed)) ||
+                (shutdown && shutdown->load(std::memory_order_relaxed));
+        }
+    };
+
+    struct SolveResult {
+        SolveStatus status = SolveStatus::Unsolvable;
+        uint64_t steps = 0;
+        std::chrono::nanoseconds elapsed{0};
+        // Time spent queued before solving started, when run by a SolverPool
+        std::chrono::nanoseconds waited{0};
+        // Row-major cells of the solved grid, filled in by SolverPool
+        std::vector<Piece> solution;
+        // Scratch memory the solver took from its arena
+        size_t peakBytes = 0;
+
+        bool solved() const {
+            return status == SolveStatus::Solved;
+        }
+    };
+
+    class Solver;
+    using SolverFactory = std::function<std::unique_ptr<Solver>()>;
+
     class Solver {
     public:
+        virtual ~Solver() { }
+
         virtual bool Solve(Grid& grid) = 0;
 
+        // Runs Solve with a deadline, step budget and cancellation token. If
+        // the puzzle isn't solved the grid is left as it was found.
+        SolveResult Solve(Grid& grid, const SolveOptions& options) {
+            const auto start = SolveClock::now();
+            const auto startSteps = _steps;
+
+            _options = options;
+            if (options.timeout.count() > 0 && start + options.timeout < _options.deadline) {
+                _options.deadline = start + options.timeout;
+            }
+            _stepLimit = options.maxSteps == 0 ? NoLimit : _steps + options.maxSteps;
+            _interrupted = false;
+            _arena.Reset();
+            _innerBytes = 0;
+            CheckLimits();
+
+            bool solved = false;
+            {
+                PROFILE_ZONE("search");
+                solved = !_interrupted && Solve(grid);
+            }
+
+            SolveResult result;
+            result.status = solved ? SolveStatus::Solved :
+                (_interrupted ? _interruptReason : SolveStatus::Unsolvable);
+            result.steps = _steps - startSteps;
+            result.elapsed = SolveClock::now() - start;
+            result.peakBytes = std::max(_arena.Used(), _innerBytes);
+            if (_recorder) {
+                _recorder->End(result.status);
+            }
+
+            _options = SolveOptions();
+            _stepLimit = NoLimit;
+            _nextCheck = NoLimit;
+            _interrupted = false;
+            return result;
+        }
+
         void Reporter(ProgressReporter *reporter) {
             _reporter = reporter;
         }
 
+        // Records every step and decision, nullptr to stop recording
+        void Recorder(SearchRecorder *recorder) {
+            _recorder = recorder;
+        }
+
         uint64_t Steps() const {
             return _steps;
         }
 
+        // Restricts candidate pieces to those left by a presolve pass
+        void Domains(const CellDomains *domains) {
+            _domains = domains;
+        }
+
     protected:
         Solver()
             : _steps(0)
             , _reporter(nullptr)
+            , _recorder(nullptr)
+            , _domains(nullptr)
+            , _innerBytes(0)
+            , _stepLimit(NoLimit)
+            , _nextCheck(NoLimit)
+            , _interrupted(false)
+            , _interruptReason(SolveStatus::Unsolvable)
         { }
 
+        bool Allowed(const Point& pos, Piece p) const {
+            return _domains == nullptr || _domains->allows(pos, p);
+        }
+
         void Step(const Point& pos) {
             _steps++;
+            if (_steps >= _nextCheck) {
+                CheckLimits();
+            }
             if (_reporter) {
                 if (pos == Point(1, 2) || _steps % _reporter->interval == 0) {
                     _reporter->Report(_steps, pos);
                 }
             }
+            if (_recorder) {
+                _recorder->Visit(pos);
+            }
+        }
+
+        // Decisions for the recorder, solvers call these around each piece
+        // they explore so every Try is matched by a Fail unless it solved
+        void Tried(const Point& pos, Piece p) {
+            if (_recorder) {
+                _recorder->Try(pos, p);
+            }
+        }
+
+        void Failed(const Point& pos, Piece p) {
+            if (_recorder) {
+                _recorder->Fail(pos, p);
+            }
+        }
+
+        void Pruned(const Point& pos) {
+            if (_recorder) {
+                _recorder->Prune(pos);
+            }
+        }
+        // Solvers unwind as soon as this is set, undoing their placements
+        bool Interrupted() const {
+            return _interrupted;
+        }
+
+        // For solvers which don't Step themselves, such as those handing
+        // the search to others, to report why they stopped
+        void Interrupt(SolveStatus reason) {
+            _interrupted = true;
+            _interruptReason = reason;
         }
+
         ProgressReporter* _reporter;
+        SearchRecorder* _recorder;
         uint64_t _steps;
+        const CellDomains* _domains;
+        SolveOptions _options;
+        // Per-solve scratch, reset at the start of each Solve and sized
+        // before the search starts so the search itself never allocates
+        Arena _arena;
+        // Scratch taken by the solvers this one hands the search to, reported
+        // as peakBytes when it is more than our own
+        size_t _innerBytes;
+
+    private:
+        static constexpr uint64_t NoLimit = std::numeric_limits<uint64_t>::max();
+        // Steps between polling the clock and cancellation token
+        static constexpr uint64_t CheckInterval = 1024;
+
+        void CheckLimits() {
+            if (_steps >= _stepLimit) {
+                Interrupt(SolveStatus::TimedOut);
+            } else if (_options.cancelled()) {
+                Interrupt(SolveStatus::Cancelled);
+            } else if (_options.deadline != SolveClock::time_point::max() &&
+                SolveClock::now() >= _options.deadline) {
+                Interrupt(SolveStatus::TimedOut);
+            }
+            _nextCheck = std::min(_steps + CheckInterval, _stepLimit);
+        }
+
+        uint64_t _stepLimit;
+        uint64_t _nextCheck;
+        bool _interrupted;
+        SolveStatus _interruptReason;
     };
 } // namespace TrainTracks
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "BoundedQueue.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Solver.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace TrainTracks {
+
+    struct SolverPoolOptions {
+        // Worker threads, each with its own solver
+        size_t workers = std::max(1u, std::thread::hardware_concurrency());
+        // Puzzles waiting for a worker before Submit blocks
+        size_t queueCapacity = 64;
+        // Deadline applied to every task from the moment it is submitted,
+        // zero for none
+        std::chrono::milliseconds taskTimeout{0};
+    };
+
+    struct SolverPoolStats {
+        size_t queueDepth = 0;
+        size_t maxQueueDepth = 0;
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;
+        uint64_t completed = 0;
+        std::chrono::nanoseconds totalWait{0};
+        std::chrono::nanoseconds maxWait{0};
+        std::chrono::nanoseconds totalSolve{0};
+        std::chrono::nanoseconds maxSolve{0};
+    };
+
+    // A fixed set of workers solving submitted puzzles. Each puzzle gets a
+    // future for its SolveResult; when the queue is full Submit blocks and
+    // TrySubmit rejects. Destroying the pool cancels anything still running
+    // or queued, which then completes as Cancelled.
+    class SolverPool {
+    public:
+        SolverPool(const SolverPoolOptions& options = SolverPoolOptions(),
+            SolverFactory factory = [] { return std::make_unique<PathSolver>(); })
+            : _options(options)
+            , _factory(std::move(factory))
+            , _queue(options.queueCapacity)
+            , _cancel(false)
+        {
+            _workers.reserve(options.workers);
+            for (size_t i = 0; i < options.workers; i++) {
+                _workers.emplace_back([this] { Work(); });
+            }
+        }
+
+        SolverPool(const SolverPool&) = delete;
+        SolverPool& operator=(const SolverPool&) = delete;
+
+        ~SolverPool() {
+            _cancel = true;
+            _queue.Close();
+            for (auto& w : _workers) {
+                w.join();
+            }
+        }
+
+        // Blocks while the queue is full
+        std::future<SolveResult> Submit(const Puzzle& puzzle, const SolveOptions& options = SolveOptions()) {
+            auto task = MakeTask(puzzle, options);
+            auto future = task.promise.get_future();
+            if (!_queue.Push(std::move(task))) {
+                throw std::runtime_error("SolverPool is shut down");
+            }
+            Submitted();
+            return future;
+        }
+
+        // Returns nothing if the queue is full
+        std::optional<std::future<SolveResult>> TrySubmit(const Puzzle& puzzle, const SolveOptions& options = SolveOptions()) {
+            auto task = MakeTask(puzzle, options);
+            auto future = task.promise.get_future();
+            if (!_queue.TryPush(std::move(task))) {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                _stats.rejected++;
+                return std::nullopt;
+            }
+            Submitted();
+            return future;
+        }
+
+        SolverPoolStats Stats() const {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            auto stats = _stats;
+            stats.queueDepth = _queue.Size();
+            return stats;
+        }
+
+        size_t Workers() const {
+            return _workers.size();
+        }
+
+    private:
+        struct Task {
+            Puzzle puzzle;
+            SolveOptions options;
+            SolveClock::time_point queued;
+            std::promise<SolveResult> promise;
+        };
+
+        Task MakeTask(const Puzzle& puzzle, const SolveOptions& options) {
+            Task task;
+            task.puzzle = puzzle;
+            task.options = options;
+            task.queued = SolveClock::now();
+            if (_options.taskTimeout.count() > 0) {
+                task.options.deadline = std::min(task.options.deadline, task.queued + _options.taskTimeout);
+            }
+            // Watched alongside any token of the caller's
+            task.options.shutdown = &_cancel;
+            return task;
+        }
+
+        void Submitted() {
+            const auto depth = _queue.Size();
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            _stats.submitted++;
+            _stats.maxQueueDepth = std::max(_stats.maxQueueDepth, depth);
+        }
+
+        void Work() {
+            auto solver = _factory();
+            // Reset for each puzzle, so a worker allocates a grid only when
+            // it meets one bigger than any before
+            std::optional<Grid> grid;
+            Task task;
+            while (_queue.Pop(task)) {
+                const auto waited = SolveClock::now() - task.queued;
+                try {
+                    PROFILE_ZONE("solve");
+                    if (grid) {
+                        grid->reset(task.puzzle);
+                    } else {
+                        grid.emplace(task.puzzle);
+                    }
+                    auto result = solver->Solve(*grid, task.options);
+                    result.waited = waited;
+                    if (result.solved()) {
+                        result.solution.reserve(grid->cells());
+                        for (int y = 0; y < grid->height(); y++) {
+                            for (int x = 0; x < grid->width(); x++) {
+                                result.solution.push_back(grid->at(x, y));
+                            }
+                        }
+                    }
+                    Completed(waited, result.elapsed);
+                    task.promise.set_value(std::move(result));
+                } catch (...) {
+                    Completed(waited, std::chrono::nanoseconds(0));
+                    task.promise.set_exception(std::current_exception());
+                }
+            }
+        }
+
+        void Completed(std::chrono::nanoseconds waited, std::chrono::nanoseconds solved) {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            _stats.completed++;
+            _stats.totalWait += waited;
+            _stats.maxWait = std::max(_stats.maxWait, waited);
+            _stats.totalSolve += solved;
+            _stats.maxSolve = std::max(_stats.maxSolve, solved);
+        }
+
+        const SolverPoolOptions _options;
+        SolverFactory _factory;
+        BoundedQueue<Task> _queue;
+        std::atomic<bool> _cancel;
+        std::vector<std::thread> _workers;
+
+        mutable std::mutex _statsMutex;
+        SolverPoolStats _stats;
+    };
+}
@@ -0,0 +1,534 @@
+#pragma once
+
+#include "Piece.h"
+#include "Point.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// TRACE(a, b, ...) records the values of up to six integer, Point or Piece
+// expressions along with their source text and the enclosing function.
+// While tracing is stopped it costs one relaxed atomic load.
+#define TRACE(...) do {                                                          \
+    if (::TrainTracks::Trace::Enabled()) {                                       \
+        static ::TrainTracks::TraceSite traceSite{__func__, #__VA_ARGS__, {0}};  \
+        ::TrainTracks::Trace::Emit(traceSite, __VA_ARGS__);                      \
+    }                                                                            \
+} while (0)
+
+namespace TrainTracks {
+
+    enum class TraceType : uint8_t {
+        Int,
+        UInt,
+        Point,
+        Piece,
+    };
+
+    // One traced call, a cache line each
+    struct TraceRecord {
+        // Steady clock nanoseconds
+        uint64_t time;
+        uint32_t event;
+        uint16_t thread;
+        uint8_t argc;
+        uint8_t reserved;
+        int64_t args[6];
+    };
+    static_assert(sizeof(TraceRecord) == 64, "TraceRecord should fill one cache line");
+
+    // A TRACE call site, given an event id the first time it fires
+    struct TraceSite {
+        const char* func;
+        const char* args;
+        std::atomic<uint32_t> id;
+    };
+
+    struct TraceOptions {
+        // How often the background thread writes out what has been traced
+        std::chrono::milliseconds flushInterval{10};
+    };
+
+    struct TraceStats {
+        uint64_t records = 0;
+        // Records lost because a thread's ring was full
+        uint64_t dropped = 0;
+        uint64_t bytes = 0;
+    };
+
+    template<typename T>
+    constexpr TraceType TraceTypeOf() {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, Point>) {
+            return TraceType::Point;
+        } else if constexpr (std::is_same_v<U, Piece>) {
+            return TraceType::Piece;
+        } else {
+            static_assert(std::is_integral_v<U> || std::is_enum_v<U>, "TRACE takes integers, Points and Pieces");
+            if constexpr (std::is_enum_v<U>) {
+                return std::is_unsigned_v<std::underlying_type_t<U>> ? TraceType::UInt : TraceType::Int;
+            } else {
+                return std::is_unsigned_v<U> ? TraceType::UInt : TraceType::Int;
+            }
+        }
+    }
+
+    template<typename T>
+    int64_t TraceEncode(const T& v) {
+        if constexpr (std::is_same_v<std::decay_t<T>, Point>) {
+            return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(v.x)) << 32) |
+                static_cast<uint32_t>(v.y));
+        } else {
+            return static_cast<int64_t>(v);
+        }
+    }
+
+    // Per thread, lock-free trace buffers written out by a background thread.
+    //
+    // Each thread pushes records into its own single producer, single
+    // consumer ring, so tracing never takes a lock once a call site has been
+    // registered. When a ring is full new records are dropped and counted
+    // rather than making the solver wait. The file holds the call sites and
+    // the raw records; Decode turns it back into the lines LOG would print.
+    class Trace {
+    public:
+        static constexpr size_t RingRecords = 1 << 14;
+
+        static bool Enabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        // Starts tracing to a new file
+        static void Start(const std::string& path, const TraceOptions& options = TraceOptions()) {
+            Instance().Open(path, options);
+        }
+
+        // Stops tracing and writes out everything traced so far. Threads
+        // still tracing as this runs may lose their last few records.
+        static TraceStats Stop() {
+            return Instance().Close();
+        }
+
+        template<typename... Args>
+        static void Emit(TraceSite& site, const Args&... args) {
+            static_assert(sizeof...(Args) <= 6, "TRACE takes at most six values");
+            auto id = site.id.load(std::memory_order_acquire);
+            if (id == 0) {
+                id = Instance().Register(site, { TraceTypeOf<Args>()... });
+            }
+            auto* ring = Instance().ThreadRing();
+
+            TraceRecord r;
+            r.time = Now();
+            r.event = id;
+            r.thread = ring->thread;
+            r.argc = sizeof...(Args);
+            r.reserved = 0;
+            size_t i = 0;
+            ((r.args[i++] = TraceEncode(args)), ...);
+            for (; i < 6; i++) {
+                r.args[i] = 0;
+            }
+            ring->Push(r);
+        }
+
+        // Writes the lines of a trace file to out in time order. Returns the
+        // records found, those dropped while tracing and the record bytes.
+        static TraceStats Decode(std::istream& in, std::ostream& out) {
+            Header header;
+            if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+                std::memcmp(header.magic, Magic, sizeof(header.magic)) != 0) {
+                throw std::runtime_error("Not a trace file");
+            }
+
+            TraceStats stats;
+            std::vector<Event> events;
+            std::vector<TraceRecord> records;
+            char kind;
+            while (in.get(kind)) {
+                if (kind == 'E') {
+                    uint32_t id;
+                    Read(in, id);
+                    if (id == 0) {
+                        throw std::runtime_error("Corrupt trace file");
+                    }
+                    if (events.size() < id) {
+                        events.resize(id);
+                    }
+                    auto& e = events[id - 1];
+                    e.func = ReadString(in);
+                    uint8_t argc;
+                    Read(in, argc);
+                    if (argc > std::size(TraceRecord{}.args)) {
+                        throw std::runtime_error("Corrupt trace file");
+                    }
+                    e.names.resize(argc);
+                    e.types.resize(argc);
+                    for (uint8_t i = 0; i < argc; i++) {
+                        Read(in, e.types[i]);
+                        e.names[i] = ReadString(in);
+                    }
+                } else if (kind == 'R') {
+                    uint32_t count;
+                    Read(in, count);
+                    const auto first = records.size();
+                    records.resize(first + count);
+                    if (!in.read(reinterpret_cast<char*>(&records[first]), count * sizeof(TraceRecord))) {
+                        throw std::runtime_error("Truncated trace file");
+                    }
+                    stats.bytes += count * sizeof(TraceRecord);
+                } else if (kind == 'D') {
+                    Read(in, stats.dropped);
+                } else {
+                    throw std::runtime_error("Corrupt trace file");
+                }
+            }
+
+            std::stable_sort(records.begin(), records.end(), [](const auto& l, const auto& r) {
+                return l.time < r.time;
+            });
+            std::string line;
+            for (const auto& r : records) {
+                if (r.event == 0 || r.event > events.size()) {
+                    throw std::runtime_error("Trace record for unknown event");
+                }
+                Format(header, events[r.event - 1], r, line);
+                out << line << '\n';
+                stats.records++;
+            }
+            return stats;
+        }
+
+    private:
+        static constexpr char Magic[8] = { 'T', 'T', 'T', 'R', 'A', 'C', 'E', '1' };
+
+        struct Header {
+            char magic[8];
+            // Wall clock and steady clock nanoseconds when tracing started
+            int64_t wall;
+            uint64_t steady;
+        };
+
+        struct Event {
+            std::string func;
+            std::vector<std::string> names;
+            std::vector<TraceType> types;
+        };
+
+        struct Ring {
+            Ring()
+                : records(new TraceRecord[RingRecords])
+                , head(0)
+                , tail(0)
+                , dropped(0)
+                , owned(true)
+                , thread(0)
+            { }
+
+            // Producer side, only ever called by the owning thread
+            void Push(const TraceRecord& r) {
+                const auto h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) >= RingRecords) {
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+                records[h & (RingRecords - 1)] = r;
+                head.store(h + 1, std::memory_order_release);
+            }
+
+            std::unique_ptr<TraceRecord[]> records;
+            alignas(64) std::atomic<uint64_t> head;
+            alignas(64) std::atomic<uint64_t> tail;
+            std::atomic<uint64_t> dropped;
+            std::atomic<bool> owned;
+            uint16_t thread;
+        };
+
+        // Gives a thread's ring back when the thread exits
+        struct Owner {
+            Ring* ring = nullptr;
+
+            ~Owner() {
+                if (ring) {
+                    ring->owned.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        Trace()
+            : _file(nullptr)
+            , _written(0)
+            , _threads(0)
+            , _stop(false)
+        { }
+
+        ~Trace() {
+            if (_file) {
+                Close();
+            }
+        }
+
+        static Trace& Instance() {
+            static Trace trace;
+            return trace;
+        }
+
+        static uint64_t Now() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void Open(const std::string& path, const TraceOptions& options) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_file) {
+                throw std::runtime_error("Tracing already started");
+            }
+            _file = std::fopen(path.c_str(), "wb");
+            if (!_file) {
+                throw std::runtime_error("Unable to open " + path);
+            }
+
+            Header header;
+            std::memcpy(header.magic, Magic, sizeof(Magic));
+            header.wall = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            header.steady = Now();
+            std::fwrite(&header, sizeof(header), 1, _file);
+
+            _stats = TraceStats();
+            _stats.bytes = sizeof(header);
+            _written = 0;
+            for (auto& ring : _rings) {
+                // Left over from the last session
+                ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+                ring->dropped.store(0, std::memory_order_relaxed);
+            }
+            _stop = false;
+            _flusher = std::thread([this, interval = options.flushInterval] { Run(interval); });
+            _enabled.store(true, std::memory_order_release);
+        }
+
+        TraceStats Close() {
+            _enabled.store(false, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_file) {
+                    throw std::runtime_error("Tracing not started");
+                }
+                _stop = true;
+            }
+            _wake.notify_all();
+            _flusher.join();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            Flush();
+            for (const auto& ring : _rings) {
+                _stats.dropped += ring->dropped.load(std::memory_order_relaxed);
+            }
+            Put('D');
+            Put(_stats.dropped);
+            std::fclose(_file);
+            _file = nullptr;
+            return _stats;
+        }
+
+        void Run(std::chrono::milliseconds interval) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_stop) {
+                _wake.wait_for(lock, interval, [this] { return _stop; });
+                if (!_stop) {
+                    Flush();
+                }
+            }
+        }
+
+        uint32_t Register(TraceSite& site, std::initializer_list<TraceType> types) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto id = site.id.load(std::memory_order_relaxed);
+            if (id != 0) {
+                return id;
+            }
+            Event e;
+            e.func = site.func;
+            e.names = SplitArgs(site.args);
+            e.types = types;
+            _events.push_back(std::move(e));
+            id = static_cast<uint32_t>(_events.size());
+            site.id.store(id, std::memory_order_release);
+            return id;
+        }
+
+        Ring* ThreadRing() {
+            static thread_local Owner owner;
+            if (owner.ring) {
+                return owner.ring;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto& ring : _rings) {
+                if (!ring->owned.load(std::memory_order_acquire) &&
+                    ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_relaxed)) {
+                    owner.ring = ring.get();
+                    break;
+                }
+            }
+            if (!owner.ring) {
+                _rings.push_back(std::make_unique<Ring>());
+                owner.ring = _rings.back().get();
+            }
+            owner.ring->owned.store(true, std::memory_order_relaxed);
+            owner.ring->thread = static_cast<uint16_t>(++_threads);
+            return owner.ring;
+        }
+
+        // Writes out new call sites, then every record traced so far. Called
+        // with _mutex held, so no site can be registered in between and every
+        // record written has its site in the file.
+        void Flush() {
+            for (; _written < _events.size(); _written++) {
+                const auto& e = _events[_written];
+                Put('E');
+                Put(static_cast<uint32_t>(_written + 1));
+                PutString(e.func);
+                Put(static_cast<uint8_t>(e.types.size()));
+                for (size_t i = 0; i < e.types.size(); i++) {
+                    Put(e.types[i]);
+                    PutString(i < e.names.size() ? e.names[i] : std::string());
+                }
+            }
+
+            for (auto& ring : _rings) {
+                const auto t = ring->tail.load(std::memory_order_relaxed);
+                const auto h = ring->head.load(std::memory_order_acquire);
+                if (h == t) {
+                    continue;
+                }
+                const auto count = static_cast<uint32_t>(h - t);
+                Put('R');
+                Put(count);
+                // In at most two pieces, either side of the wrap
+                const auto start = t & (RingRecords - 1);
+                const auto first = std::min<uint64_t>(count, RingRecords - start);
+                std::fwrite(&ring->records[start], sizeof(TraceRecord), first, _file);
+                std::fwrite(&ring->records[0], sizeof(TraceRecord), count - first, _file);
+                ring->tail.store(h, std::memory_order_release);
+                _stats.records += count;
+                _stats.bytes += count * sizeof(TraceRecord);
+            }
+            std::fflush(_file);
+        }
+
+        template<typename T>
+        void Put(const T& v) {
+            std::fwrite(&v, sizeof(v), 1, _file);
+            _stats.bytes += sizeof(v);
+        }
+
+        void PutString(const std::string& s) {
+            Put(static_cast<uint16_t>(s.size()));
+            std::fwrite(s.data(), 1, s.size(), _file);
+            _stats.bytes += s.size();
+        }
+
+        template<typename T>
+        static void Read(std::istream& in, T& v) {
+            if (!in.read(reinterpret_cast<char*>(&v), sizeof(v))) {
+                throw std::runtime_error("Truncated trace file");
+            }
+        }
+
+        static std::string ReadString(std::istream& in) {
+            uint16_t size;
+            Read(in, size);
+            std::string s(size, '\0');
+            if (!in.read(s.data(), size)) {
+                throw std::runtime_error("Truncated trace file");
+            }
+            return s;
+        }
+
+        // "pt, grid.canPlace(pos, p)" -> "pt", "grid.canPlace(pos, p)"
+        static std::vector<std::string> SplitArgs(const std::string& args) {
+            std::vector<std::string> names;
+            std::string name;
+            int depth = 0;
+            for (const auto c : args) {
+                if (c == '(' || c == '[' || c == '{') {
+                    depth++;
+                } else if (c == ')' || c == ']' || c == '}') {
+                    depth--;
+                } else if (c == ',' && depth == 0) {
+                    names.push_back(name);
+                    name.clear();
+                    continue;
+                }
+                if (c != ' ' || !name.empty()) {
+                    name.append(1, c);
+                }
+            }
+            names.push_back(name);
+            return names;
+        }
+
+        // The same line LOG prints
+        static void Format(const Header& header, const Event& e, const TraceRecord& r, std::string& line) {
+            const auto wall = header.wall + static_cast<int64_t>(r.time - header.steady);
+            const time_t seconds = static_cast<time_t>(wall / 1000000000);
+            const long micros = static_cast<long>(wall % 1000000000 / 1000);
+            struct tm lt;
+            localtime_r(&seconds, &lt);
+            char stamp[64];
+            std::snprintf(stamp, sizeof(stamp), "%02d/%02d/%02d %02d:%02d:%02d.%06ld", lt.tm_mon + 1, lt.tm_mday,
+                lt.tm_year % 100, lt.tm_hour, lt.tm_min, lt.tm_sec, micros);
+
+            line.assign(stamp).append(1, ' ').append(e.func).append(" : ");
+            for (size_t i = 0; i < r.argc && i < e.types.size(); i++) {
+                line.append(e.names[i]).append(1, '=');
+                const auto v = r.args[i];
+                switch (e.types[i]) {
+                    case TraceType::Int:
+                        line.append(std::to_string(v));
+                        break;
+                    case TraceType::UInt:
+                        line.append(std::to_string(static_cast<uint64_t>(v)));
+                        break;
+                    case TraceType::Point:
+                        line.append(1, '{').append(std::to_string(static_cast<int32_t>(static_cast<uint64_t>(v) >> 32)));
+                        line.append(1, ',').append(std::to_string(static_cast<int32_t>(v))).append(1, '}');
+                        break;
+                    case TraceType::Piece:
+                        line.append(PieceSymbol(static_cast<Piece>(v)));
+                        break;
+                }
+                line.append(1, ' ');
+            }
+        }
+
+        static inline std::atomic<bool> _enabled{false};
+
+        std::mutex _mutex;
+        std::FILE* _file;
+        TraceStats _stats;
+        std::vector<Event> _events;
+        size_t _written;
+        std::vector<std::unique_ptr<Ring>> _rings;
+        uint16_t _threads;
+
+        std::condition_variable _wake;
+        bool _stop;
+        std::thread _flusher;
+    };
+}
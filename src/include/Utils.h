@@ -4,6 +4,7 @@
 #include <fstream>
 #include <functional>
 #include <iomanip>
+#include <iostream>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -36,6 +37,10 @@ namespace TrainTracks {
     inline bool startsWith(const std::string& s, const std::string_view p) {
         return startsWith(std::string_view{s.data(), s.size()}, p);
     }
+
+    inline bool endsWith(const std::string_view s, const std::string_view p) {
+        return s.size() >= p.size() && s.compare(s.size() - p.size(), p.size(), p) == 0;
+    }
     inline bool getline(std::istream& s, std::string& out, const std::string_view delims) {
         char c;
         out.resize(0);
@@ -123,6 +128,48 @@ namespace TrainTracks {
         }
     }
 
+    // Finds the raw value of a key in a flat, single-line JSON object: a
+    // number, a quoted string (quotes included) or an array of numbers.
+    // Enough for the records the runner exchanges, not a general parser.
+    inline std::string_view json_value(const std::string_view json, const std::string_view key) {
+        const std::string quoted = "\"" + std::string(key) + "\"";
+        auto pos = json.find(quoted);
+        while (pos != std::string_view::npos) {
+            pos += quoted.size();
+            while (pos < json.size() && json[pos] == ' ') { pos++; }
+            if (pos < json.size() && json[pos] == ':') { break; }
+            pos = json.find(quoted, pos);
+        }
+        if (pos == std::string_view::npos) {
+            return {};
+        }
+
+        pos++;
+        while (pos < json.size() && json[pos] == ' ') { pos++; }
+        if (pos >= json.size()) {
+            return {};
+        }
+
+        size_t end = std::string_view::npos;
+        if (json[pos] == '[') {
+            end = json.find(']', pos);
+            end = end == std::string_view::npos ? end : end + 1;
+        } else if (json[pos] == '"') {
+            end = pos + 1;
+            while (end < json.size() && json[end] != '"') {
+                end += json[end] == '\\' ? 2 : 1;
+            }
+            end = end < json.size() ? end + 1 : std::string_view::npos;
+        } else {
+            end = json.find_first_of(",}", pos);
+            end = end == std::string_view::npos ? json.size() : end;
+        }
+        if (end == std::string_view::npos) {
+            return {};
+        }
+        return trim(json.substr(pos, end - pos));
+    }
+
     inline std::ostream& bold_on(std::ostream& os) {
         return os << "\e[1m";
     }
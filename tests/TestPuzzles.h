@@ -0,0 +1,95 @@
+// Puzzles shared by the unit tests
+#pragma once
+
+#include <vector>
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+
+inline TrainTracks::Puzzle makeSimpleSolvablePuzzle() {
+    using namespace TrainTracks;
+    Puzzle p;
+    p.data.rowConstraints = {1, 1, 1};
+    p.data.colConstraints = {0, 3, 0};
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    // Two vertical pieces at (1,0) and (1,2) as exits
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
+    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
+    return p;
+}
+
+// The same exits, but the constraints leave no room to connect them
+inline TrainTracks::Puzzle makeSimpleUnsolvablePuzzle() {
+    TrainTracks::Puzzle p = makeSimpleSolvablePuzzle();
+    p.data.rowConstraints = {1, 0, 1};
+    p.data.colConstraints = {0, 2, 0};
+    return p;
+}
+
+/*
+  -+...
+  .|...
+  .+-+.
+  ...++
+  ....+
+*/
+inline TrainTracks::Puzzle makeSimplePuzzle5x5() {
+    using namespace TrainTracks;
+    Puzzle p;
+    p.data.rowConstraints = {2, 1, 3, 2, 1};
+    p.data.colConstraints = {1, 3, 1, 2, 2};
+    p.gridWidth = 5;
+    p.gridHeight = 5;
+    p.data.startingGrid.assign(25, Piece::Empty);
+    p.data.startingGrid[Point{0, 0}.project(5)] = Piece::Horizontal;
+    p.data.startingGrid[Point{4, 4}.project(5)] = Piece::CornerNE;
+    return p;
+}
+
+inline TrainTracks::Puzzle makeLargerSolvablePuzzle() {
+    using namespace TrainTracks;
+    Puzzle p;
+    p.data.rowConstraints = {2, 2, 2, 2, 2, 2, 2, 2, 2,};
+    p.data.colConstraints = {1, 2, 2, 2, 2, 2, 2, 2, 2, 1};
+    p.gridWidth = p.data.colConstraints.size();
+    p.gridHeight = p.data.rowConstraints.size();
+    p.data.startingGrid.assign(p.gridWidth * p.gridHeight, Piece::Empty);
+    p.data.startingGrid[Point{0, 0}.project(p.gridWidth)] = Piece::Horizontal;
+    p.data.startingGrid[Point{p.gridWidth - 1, p.gridHeight - 1}.project(p.gridWidth)] = Piece::Horizontal;
+    return p;
+}
+
+// puzzles/hard-12x12.json; takes PathSolver tens of thousands of steps and
+// SegmentSolver a few hundred
+inline TrainTracks::Puzzle makeHardPuzzle() {
+    using namespace TrainTracks;
+    Puzzle p;
+    p.gridWidth  = 12;
+    p.gridHeight = 12;
+    p.data.rowConstraints = {
+        5, 1, 2, 3, 9, 4, 6, 7, 7, 10, 7, 4
+    };
+    p.data.colConstraints = {
+        5, 10, 5, 4, 5, 8, 6, 6, 4, 3, 4, 5
+    };
+    std::vector<int> flat = {
+        0, 0, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 8,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 4, 0, 0, 0, 8, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0,
+        6, 0, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5,
+        0, 0, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0
+    };
+    for (int v : flat) {
+        p.data.startingGrid.push_back(static_cast<Piece>(v));
+    }
+    return p;
+}
@@ -0,0 +1,164 @@
+// Unit tests for the Arena and for solvers staying off the heap while searching
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Arena.h"
+#include "PathSolver.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+// Every heap allocation in this binary goes through here
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Not inlined, or GCC takes the free for a mismatch with operator new
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Remembers the allocation count at the first step and the largest change
+// seen at any step after it
+class AllocationWatcher : public ProgressReporter {
+public:
+    AllocationWatcher()
+        : ProgressReporter(1)
+    { }
+
+    void Report(uint64_t, const Point&) override {
+        const auto now = allocations.load(std::memory_order_relaxed);
+        if (reports++ == 0) {
+            first = now;
+        }
+        worst = std::max(worst, now - first);
+    }
+
+    uint64_t reports = 0;
+    uint64_t first = 0;
+    uint64_t worst = 0;
+};
+
+TEST(ArenaTest, AllocatesAlignedValues) {
+    Arena arena(256);
+    auto* c = arena.Allocate<char>(3, 'x');
+    auto* i = arena.Allocate<int64_t>(4, 7);
+
+    EXPECT_EQ(c[2], 'x');
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(i) % alignof(int64_t), 0u);
+    EXPECT_EQ(i[3], 7);
+    EXPECT_EQ(arena.Used(), 8u + 4 * sizeof(int64_t));
+}
+
+TEST(ArenaTest, ResetKeepsStorage) {
+    Arena arena(1024);
+    arena.Allocate<int>(100);
+    arena.Reset();
+
+    EXPECT_EQ(arena.Used(), 0u);
+    EXPECT_EQ(arena.Capacity(), 1024u);
+
+    const auto before = allocations.load();
+    arena.Allocate<int>(200);
+    EXPECT_EQ(allocations.load(), before);
+}
+
+TEST(ArenaTest, GrowsAndMergesOnReset) {
+    Arena arena(64);
+    arena.Allocate<int>(8);
+    const auto grown = allocations.load();
+    arena.Allocate<int>(1000);
+    EXPECT_GT(allocations.load(), grown);
+    EXPECT_GE(arena.Capacity(), 64u + 4000u);
+
+    const auto capacity = arena.Capacity();
+    arena.Reset();
+    EXPECT_EQ(arena.Capacity(), capacity);
+
+    // One block now, so the same solve fits without growing
+    const auto before = allocations.load();
+    arena.Allocate<int>(8);
+    arena.Allocate<int>(1000);
+    EXPECT_EQ(allocations.load(), before);
+}
+
+TEST(AllocationTest, PathSolverSearchDoesNotAllocate) {
+    Grid grid(makeHardPuzzle());
+    AllocationWatcher watcher;
+    PathSolver solver;
+    solver.Reporter(&watcher);
+
+    SolveOptions options;
+    options.maxSteps = 200000;
+    const auto result = solver.Solve(grid, options);
+
+    EXPECT_EQ(watcher.reports, result.steps);
+    EXPECT_EQ(watcher.worst, 0u);
+}
+
+TEST(AllocationTest, SegmentSolverSearchDoesNotAllocate) {
+    Grid grid(makeHardPuzzle());
+    AllocationWatcher watcher;
+    SegmentSolver solver;
+    solver.Reporter(&watcher);
+
+    const auto result = solver.Solve(grid, SolveOptions());
+
+    EXPECT_TRUE(result.solved());
+    EXPECT_GT(watcher.reports, 0u);
+    EXPECT_EQ(watcher.worst, 0u);
+}
+
+TEST(AllocationTest, ReusedSolverDoesNotAllocate) {
+    SegmentSolver solver;
+    {
+        Grid grid(makeHardPuzzle());
+        ASSERT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+    }
+
+    Grid grid(makeHardPuzzle());
+    const auto before = allocations.load();
+    const auto result = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(allocations.load(), before);
+    EXPECT_TRUE(result.solved());
+}
+
+TEST(AllocationTest, ReportsPeakBytes) {
+    Grid grid(makeHardPuzzle());
+    PathSolver solver;
+
+    SolveOptions options;
+    options.maxSteps = 1000;
+    const auto result = solver.Solve(grid, options);
+
+    // A few words of search and cut state for each cell
+    EXPECT_GE(result.peakBytes, 2u * 144);
+    EXPECT_LT(result.peakBytes, 32u * 144);
+
+    // Plus the nogood table, which is capped
+    PathSolverOptions config;
+    config.nogoodBits = 20;
+    PathSolver remembering(config);
+    const auto withNogoods = remembering.Solve(grid, options);
+    EXPECT_GT(withNogoods.peakBytes, result.peakBytes);
+    EXPECT_LE(withNogoods.peakBytes, result.peakBytes + (sizeof(uint64_t) << 20) + 8 * 144);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
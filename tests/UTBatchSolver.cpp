@@ -0,0 +1,142 @@
+// Unit tests for the BatchSolver class
+#include <gtest/gtest.h>
+#include "BatchSolver.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+static std::vector<Puzzle> pack(int size, double hints, int count) {
+    std::vector<Puzzle> puzzles;
+    for (int seed = 1; seed <= count; seed++) {
+        GeneratorOptions options;
+        options.width = size;
+        options.height = size;
+        options.seed = seed;
+        options.hints = hints;
+        puzzles.push_back(Generator::Generate(options));
+    }
+    return puzzles;
+}
+
+// Whether solution completes the puzzle, keeping its fixed pieces
+static bool solves(const Puzzle& puzzle, const std::vector<Piece>& solution) {
+    if (solution.size() != puzzle.data.startingGrid.size()) {
+        return false;
+    }
+    Grid grid(puzzle);
+    for (int y = 0; y < puzzle.gridHeight; y++) {
+        for (int x = 0; x < puzzle.gridWidth; x++) {
+            const Point pt{x, y};
+            const auto piece = solution[pt.project(puzzle.gridWidth)];
+            if (grid.isFilled(pt)) {
+                if (grid.at(pt) != piece) {
+                    return false;
+                }
+            } else if (piece != Piece::Empty) {
+                grid.place(pt, piece);
+            }
+        }
+    }
+    return grid.isComplete();
+}
+
+TEST(BatchSolver, SolvesSmallPacks) {
+    for (const int size : { 4, 6, 8 }) {
+        const auto puzzles = pack(size, 0.15, 40);
+        BatchSolver batch;
+        const auto results = batch.Solve(puzzles);
+        ASSERT_EQ(results.size(), puzzles.size());
+        for (size_t i = 0; i < puzzles.size(); i++) {
+            ASSERT_TRUE(results[i].solved()) << size << "x" << size << " seed " << i + 1;
+            EXPECT_TRUE(solves(puzzles[i], results[i].solution)) << size << "x" << size << " seed " << i + 1;
+            EXPECT_GT(results[i].steps, 0u);
+        }
+        EXPECT_EQ(batch.Stats().puzzles, puzzles.size());
+        EXPECT_EQ(batch.Stats().oversized, 0u);
+        // Most are settled by propagation alone
+        EXPECT_GT(batch.Stats().propagated, puzzles.size() / 2);
+    }
+}
+
+TEST(BatchSolver, LanesMatchOneAtATime) {
+    // Not a multiple of the lane count, so the last vector is part empty
+    const auto puzzles = pack(8, 0.15, 31);
+    BatchOptions scalar;
+    scalar.simd = false;
+    BatchSolver one(scalar);
+    BatchSolver lanes;
+    EXPECT_STREQ(one.Kernel(), "scalar");
+    EXPECT_NE(std::string(lanes.Kernel()), "");
+
+    const auto a = one.Solve(puzzles);
+    const auto b = lanes.Solve(puzzles);
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        EXPECT_EQ(a[i].status, b[i].status);
+        EXPECT_EQ(a[i].steps, b[i].steps);
+        EXPECT_EQ(a[i].solution, b[i].solution);
+    }
+    EXPECT_EQ(one.Stats().propagated, lanes.Stats().propagated);
+    EXPECT_EQ(one.Stats().branched, lanes.Stats().branched);
+}
+
+TEST(BatchSolver, ProvesUnsolvableWithoutSearching) {
+    BatchSolver batch;
+    const auto results = batch.Solve({ makeSimpleUnsolvablePuzzle(), makeSimpleSolvablePuzzle() });
+    EXPECT_EQ(results[0].status, SolveStatus::Unsolvable);
+    EXPECT_TRUE(results[0].solution.empty());
+    ASSERT_TRUE(results[1].solved());
+    EXPECT_TRUE(solves(makeSimpleSolvablePuzzle(), results[1].solution));
+    EXPECT_EQ(batch.Stats().searched, 0u);
+}
+
+TEST(BatchSolver, HandsOpenPuzzlesToTheFallback) {
+    // No branching, and only the entry and exit given, so some puzzles are
+    // left open by propagation
+    const auto puzzles = pack(8, 0, 20);
+    BatchOptions options;
+    options.branchNodes = 0;
+    BatchSolver batch(options);
+    const auto results = batch.Solve(puzzles);
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        ASSERT_TRUE(results[i].solved()) << "seed " << i + 1;
+        EXPECT_TRUE(solves(puzzles[i], results[i].solution)) << "seed " << i + 1;
+    }
+    EXPECT_GT(batch.Stats().searched, 0u);
+    EXPECT_EQ(batch.Stats().branched, 0u);
+    EXPECT_EQ(batch.Stats().propagated + batch.Stats().searched, puzzles.size());
+}
+
+TEST(BatchSolver, SearchesPuzzlesTooBigForABoard) {
+    auto puzzles = pack(6, 0.15, 3);
+    puzzles.insert(puzzles.begin() + 1, pack(12, 0.15, 1).front());
+    BatchSolver batch;
+    const auto results = batch.Solve(puzzles);
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        ASSERT_TRUE(results[i].solved());
+        EXPECT_TRUE(solves(puzzles[i], results[i].solution));
+    }
+    EXPECT_FALSE(BatchSolver::Fits(puzzles[1]));
+    EXPECT_EQ(batch.Stats().oversized, 1u);
+    EXPECT_EQ(batch.Stats().searched, 1u);
+}
+
+TEST(BatchSolver, RejectsInvalidPuzzles) {
+    BatchSolver batch;
+    Puzzle mismatched = makeSimpleSolvablePuzzle();
+    mismatched.data.rowConstraints = {1, 1, 0};
+    EXPECT_THROW(batch.Solve({ mismatched }), std::runtime_error);
+
+    Puzzle noExit = makeSimpleSolvablePuzzle();
+    noExit.data.startingGrid[Point{1, 2}.project(3)] = Piece::Empty;
+    EXPECT_THROW(batch.Solve({ noExit }), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
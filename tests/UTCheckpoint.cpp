@@ -0,0 +1,240 @@
+// Unit tests for PathSolver checkpoints
+#include <gtest/gtest.h>
+#include "Checkpoint.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "PathSolver.h"
+
+#include <optional>
+#include <sstream>
+
+using namespace TrainTracks;
+
+// Takes PathSolver about 30000 steps
+static Puzzle makePuzzle(int size = 10, uint64_t seed = 20) {
+    GeneratorOptions options;
+    options.width = size;
+    options.height = size;
+    options.seed = seed;
+    options.hints = 0;
+    return Generator::Generate(options);
+}
+
+class TryLog
+    : public SearchRecorder {
+public:
+    void Visit(const Point&) override { }
+    void Try(const Point& pos, Piece p) override { tries.emplace_back(pos, p); }
+    void Fail(const Point&, Piece) override { }
+    void Prune(const Point&) override { }
+
+    std::vector<std::pair<Point, Piece>> tries;
+};
+
+static std::vector<Piece> cells(const Grid& grid) {
+    std::vector<Piece> out;
+    for (int y = 0; y < grid.height(); y++) {
+        for (int x = 0; x < grid.width(); x++) {
+            out.push_back(grid.at(x, y));
+        }
+    }
+    return out;
+}
+
+// Once it has replayed down the saved path, a resumed search tries exactly
+// what the uninterrupted one tried from the same point on
+static void expectSameOrder(const PathSolverOptions& config) {
+    const auto puzzle = makePuzzle();
+    TryLog whole;
+    Grid full(puzzle);
+    PathSolver reference(config);
+    reference.Recorder(&whole);
+    const auto expected = reference.Solve(full, SolveOptions());
+    ASSERT_TRUE(expected.solved());
+
+    std::optional<PathCheckpoint> saved;
+    PathSolver first(config);
+    first.Checkpoints([&saved](const PathCheckpoint& c) { saved = c; }, std::chrono::hours(1));
+    Grid grid(puzzle);
+    SolveOptions limited;
+    limited.maxSteps = expected.steps / 2;
+    EXPECT_EQ(first.Solve(grid, limited).status, SolveStatus::TimedOut);
+    ASSERT_TRUE(saved);
+    EXPECT_EQ(cells(grid), cells(Grid(puzzle)));
+    EXPECT_GE(saved->steps, limited.maxSteps - 1);
+
+    TryLog resumed;
+    PathSolver second(config);
+    second.Recorder(&resumed);
+    const auto r = second.Resume(grid, *saved);
+    ASSERT_TRUE(r.solved());
+    EXPECT_EQ(cells(grid), cells(full));
+
+    const auto replayed = saved->levels.size() - 1;
+    ASSERT_GT(resumed.tries.size(), replayed);
+    const auto tail = resumed.tries.size() - replayed;
+    ASSERT_LE(tail, whole.tries.size());
+    EXPECT_TRUE(std::equal(resumed.tries.begin() + replayed, resumed.tries.end(), whole.tries.end() - tail));
+    for (size_t k = 0; k < replayed; k++) {
+        const auto& level = saved->levels[k];
+        EXPECT_EQ(resumed.tries[k], std::make_pair(level.cell, level.candidates[level.choice]));
+    }
+}
+
+TEST(Checkpoint, ResumesInTheSameOrder) {
+    expectSameOrder(PathSolverOptions());
+}
+
+TEST(Checkpoint, ResumesShuffledSearchesInTheSameOrder) {
+    PathSolverOptions config;
+    config.seed = 7;
+    expectSameOrder(config);
+}
+
+// Run a few thousand steps at a time, each run picking up the last one's
+// checkpoint, until it solves
+TEST(Checkpoint, ResumesRepeatedly) {
+    const auto puzzle = makePuzzle();
+    Grid full(puzzle);
+    PathSolver reference;
+    const auto expected = reference.Solve(full, SolveOptions());
+
+    std::optional<PathCheckpoint> saved;
+    SolveOptions chunk;
+    chunk.maxSteps = 3000;
+    Grid grid(puzzle);
+    SolveResult r;
+    int runs = 0;
+    uint64_t lastSteps = 0;
+    do {
+        PathSolver solver;
+        solver.Checkpoints([&saved](const PathCheckpoint& c) { saved = c; }, std::chrono::hours(1));
+        r = saved ? solver.Resume(grid, *saved, chunk) : solver.Solve(grid, chunk);
+        ASSERT_TRUE(saved);
+        if (!r.solved()) {
+            EXPECT_GT(saved->steps, lastSteps);
+            lastSteps = saved->steps;
+        }
+        runs++;
+    } while (!r.solved() && runs < 100);
+    ASSERT_TRUE(r.solved());
+    EXPECT_GT(runs, 5);
+    EXPECT_EQ(cells(grid), cells(full));
+    EXPECT_GE(lastSteps, expected.steps - chunk.maxSteps);
+}
+
+TEST(Checkpoint, SavesPeriodically) {
+    const auto puzzle = makePuzzle();
+    std::vector<PathCheckpoint> saved;
+    PathSolver solver;
+    solver.Checkpoints([&saved](const PathCheckpoint& c) { saved.push_back(c); }, std::chrono::nanoseconds(0));
+    Grid full(puzzle);
+    const auto expected = solver.Solve(full, SolveOptions());
+    ASSERT_TRUE(expected.solved());
+    EXPECT_GE(saved.size(), expected.steps / 4096 - 1);
+    ASSERT_FALSE(saved.empty());
+
+    // Any of them can be picked up again
+    for (const auto& c : { saved.front(), saved[saved.size() / 2], saved.back() }) {
+        Grid grid(puzzle);
+        PathSolver resumed;
+        EXPECT_TRUE(resumed.Resume(grid, c).solved());
+        EXPECT_EQ(cells(grid), cells(full));
+    }
+}
+
+TEST(Checkpoint, RoundTripsThroughAFile) {
+    const auto puzzle = makePuzzle();
+    std::optional<PathCheckpoint> saved;
+    PathSolver solver;
+    solver.Checkpoints([&saved](const PathCheckpoint& c) { saved = c; }, std::chrono::hours(1));
+    Grid grid(puzzle);
+    SolveOptions limited;
+    limited.maxSteps = 10000;
+    solver.Solve(grid, limited);
+    ASSERT_TRUE(saved);
+
+    std::stringstream file;
+    WriteCheckpoint(file, *saved);
+    // Eight bytes a level on top of the header and line counts
+    EXPECT_EQ(file.str().size(), 60 + 2 * (10 + 10) + 8 * saved->levels.size());
+    const auto back = ReadCheckpoint(file);
+    EXPECT_EQ(back.fromExit, saved->fromExit);
+    EXPECT_EQ(back.seed, saved->seed);
+    EXPECT_EQ(back.order, saved->order);
+    EXPECT_EQ(back.fingerprint, saved->fingerprint);
+    EXPECT_EQ(back.random, saved->random);
+    EXPECT_EQ(back.steps, saved->steps);
+    EXPECT_EQ(back.rowCounts, saved->rowCounts);
+    EXPECT_EQ(back.colCounts, saved->colCounts);
+    ASSERT_EQ(back.levels.size(), saved->levels.size());
+    for (size_t k = 0; k < back.levels.size(); k++) {
+        EXPECT_EQ(back.levels[k].cell, saved->levels[k].cell);
+        EXPECT_EQ(back.levels[k].count, saved->levels[k].count);
+        EXPECT_EQ(back.levels[k].choice, saved->levels[k].choice);
+        EXPECT_TRUE(std::equal(back.levels[k].candidates.begin(), back.levels[k].candidates.begin() + back.levels[k].count,
+            saved->levels[k].candidates.begin()));
+    }
+    PathSolver resumed;
+    EXPECT_TRUE(resumed.Resume(grid, back).solved());
+}
+
+TEST(Checkpoint, RejectsAnotherPuzzle) {
+    std::optional<PathCheckpoint> saved;
+    PathSolver solver;
+    solver.Checkpoints([&saved](const PathCheckpoint& c) { saved = c; }, std::chrono::hours(1));
+    Grid grid(makePuzzle());
+    SolveOptions limited;
+    limited.maxSteps = 5000;
+    solver.Solve(grid, limited);
+    ASSERT_TRUE(saved);
+
+    Grid other(makePuzzle(10, 7));
+    const auto before = cells(other);
+    PathSolver resumed;
+    EXPECT_THROW(resumed.Resume(other, *saved), std::runtime_error);
+    EXPECT_EQ(cells(other), before);
+
+    PathSolverOptions shuffled;
+    shuffled.seed = 3;
+    PathSolver different(shuffled);
+    EXPECT_THROW(different.Resume(grid, *saved), std::runtime_error);
+
+    auto broken = *saved;
+    broken.levels[1].cell = broken.levels[2].cell;
+    EXPECT_THROW(resumed.Resume(grid, broken), std::runtime_error);
+    EXPECT_EQ(cells(grid), cells(Grid(makePuzzle())));
+
+    // Still usable afterwards
+    EXPECT_TRUE(resumed.Resume(grid, *saved).solved());
+}
+
+TEST(Checkpoint, RejectsBadFiles) {
+    std::stringstream empty;
+    EXPECT_THROW(ReadCheckpoint(empty), std::runtime_error);
+    std::stringstream other("TTSEARCH and then some");
+    EXPECT_THROW(ReadCheckpoint(other), std::runtime_error);
+
+    PathCheckpoint c;
+    c.rowCounts.assign(3, 0);
+    c.colCounts.assign(3, 0);
+    c.levels.resize(2);
+    c.levels[0].count = 1;
+    c.levels[0].candidates[0] = Piece::Vertical;
+    c.levels[1].count = 1;
+    c.levels[1].candidates[0] = Piece::Vertical;
+    std::stringstream file;
+    WriteCheckpoint(file, c);
+    const auto bytes = file.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() - 3));
+    EXPECT_THROW(ReadCheckpoint(truncated), std::runtime_error);
+    auto corrupt = bytes;
+    corrupt[corrupt.size() - 3] = 0x0F;
+    std::stringstream badPiece(corrupt);
+    EXPECT_THROW(ReadCheckpoint(badPiece), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,202 @@
+// Unit tests for the FrontierSolver class
+#include <gtest/gtest.h>
+#include "FrontierSolver.h"
+#include "PathSolver.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+static Puzzle generate(int size, uint64_t seed, double hints) {
+    GeneratorOptions options;
+    options.width = size;
+    options.height = size;
+    options.seed = seed;
+    options.hints = hints;
+    return Generator::Generate(options);
+}
+
+// Counts solutions by walking every self-avoiding path from the entry
+class PathCounter {
+public:
+    explicit PathCounter(const Grid& grid)
+        : _grid(grid)
+        , _visited(grid.cells(), false)
+        , _rows(grid.height(), 0)
+        , _cols(grid.width(), 0)
+    { }
+
+    uint64_t Count() {
+        const auto entry = _grid.entry();
+        for (const auto& d : Connections::GetConnections(_grid.at(entry))) {
+            if (!_grid.isInBounds(entry + d)) {
+                Walk(entry, d.inverse());
+            }
+        }
+        return _count;
+    }
+
+private:
+    void Walk(const Point& pos, const Point& in) {
+        if (!_grid.isInBounds(pos)) {
+            return;
+        }
+        const auto idx = pos.project(_grid.width());
+        if (_visited[idx] || _rows[pos.y] == _grid.rowConstraint(pos.y) || _cols[pos.x] == _grid.colConstraint(pos.x)) {
+            return;
+        }
+        _visited[idx] = true;
+        _rows[pos.y]++;
+        _cols[pos.x]++;
+        if (_grid.isFilled(pos)) {
+            const auto p = _grid.at(pos);
+            if (Connections::ConnectsTo(p, in.inverse())) {
+                for (const auto& d : Connections::GetConnections(p)) {
+                    if (d != in.inverse()) {
+                        Next(pos, d);
+                    }
+                }
+            }
+        } else {
+            for (const auto& d : { Point::up(), Point::down(), Point::left(), Point::right() }) {
+                if (d != in.inverse()) {
+                    Next(pos, d);
+                }
+            }
+        }
+        _visited[idx] = false;
+        _rows[pos.y]--;
+        _cols[pos.x]--;
+    }
+
+    void Next(const Point& pos, const Point& d) {
+        if (!_grid.isInBounds(pos + d)) {
+            if (pos == _grid.exit() && Complete()) {
+                _count++;
+            }
+            return;
+        }
+        Walk(pos + d, d);
+    }
+
+    bool Complete() const {
+        for (int y = 0; y < _grid.height(); y++) {
+            if (_rows[y] != _grid.rowConstraint(y)) {
+                return false;
+            }
+            for (int x = 0; x < _grid.width(); x++) {
+                if (_grid.isFilled(Point{x, y}) && !_visited[Point{x, y}.project(_grid.width())]) {
+                    return false;
+                }
+            }
+        }
+        for (int x = 0; x < _grid.width(); x++) {
+            if (_cols[x] != _grid.colConstraint(x)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const Grid& _grid;
+    std::vector<bool> _visited;
+    std::vector<int> _rows;
+    std::vector<int> _cols;
+    uint64_t _count = 0;
+};
+
+TEST(FrontierSolver, SolvesSimplePuzzle) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    FrontierSolver solver;
+    const auto result = solver.Solve(grid, SolveOptions());
+    ASSERT_TRUE(result.solved());
+    EXPECT_TRUE(grid.isComplete());
+    EXPECT_EQ(solver.Stats().solutions, 1u);
+    EXPECT_GT(result.steps, 0u);
+    EXPECT_GT(result.peakBytes, 0u);
+}
+
+TEST(FrontierSolver, ProvesUnsolvable) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    const auto before = grid.toString();
+    FrontierSolver solver;
+    EXPECT_EQ(solver.Solve(grid, SolveOptions()).status, SolveStatus::Unsolvable);
+    EXPECT_EQ(solver.Stats().solutions, 0u);
+    EXPECT_EQ(grid.toString(), before);
+}
+
+TEST(FrontierSolver, SolvesGeneratedPuzzles) {
+    for (const int size : { 6, 10, 16 }) {
+        for (uint64_t seed = 1; seed <= 4; seed++) {
+            const auto puzzle = generate(size, seed, 0.15);
+            Grid grid(puzzle);
+            FrontierSolver solver;
+            const auto result = solver.Solve(grid, SolveOptions());
+            ASSERT_TRUE(result.solved()) << size << "x" << size << " seed " << seed;
+            EXPECT_TRUE(grid.isComplete());
+            EXPECT_GE(solver.Stats().solutions, 1u);
+            // Fixed pieces stay where they were
+            for (int i = 0; i < size * size; i++) {
+                if (puzzle.data.startingGrid[i] != Piece::Empty) {
+                    EXPECT_EQ(grid.at(Point{ i % size, i / size }), puzzle.data.startingGrid[i]);
+                }
+            }
+        }
+    }
+}
+
+TEST(FrontierSolver, CountsEverySolution) {
+    uint64_t most = 0;
+    for (uint64_t seed = 1; seed <= 8; seed++) {
+        // Only the entry and exit given, so there are often several
+        const auto puzzle = generate(5, seed, 0);
+        Grid grid(puzzle);
+        const auto expected = PathCounter(grid).Count();
+        FrontierSolver solver;
+        EXPECT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+        EXPECT_EQ(solver.Stats().solutions, expected) << "seed " << seed;
+        most = std::max(most, expected);
+    }
+    EXPECT_GT(most, 1u);
+}
+
+TEST(FrontierSolver, CountsWithoutThePresolver) {
+    const auto puzzle = generate(5, 3, 0);
+    Grid grid(puzzle);
+    const auto expected = PathCounter(grid).Count();
+    // Domains which rule nothing out
+    const CellDomains all(5, 5);
+    FrontierSolver solver;
+    solver.Domains(&all);
+    EXPECT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+    EXPECT_EQ(solver.Stats().solutions, expected);
+}
+
+TEST(FrontierSolver, GivesUpAtTheMemoryLimit) {
+    FrontierOptions options;
+    options.maxBytes = 1;
+    FrontierSolver solver(options);
+    Grid grid(generate(10, 1, 0.15));
+    const auto result = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(result.status, SolveStatus::TimedOut);
+    EXPECT_TRUE(solver.Stats().outOfMemory);
+}
+
+TEST(FrontierSolver, StopsAtTheStepBudget) {
+    FrontierSolver solver;
+    Grid grid(generate(16, 1, 0.15));
+    SolveOptions options;
+    options.maxSteps = 10;
+    const auto result = solver.Solve(grid, options);
+    EXPECT_EQ(result.status, SolveStatus::TimedOut);
+    EXPECT_FALSE(solver.Stats().outOfMemory);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+// Unit tests for the random puzzle Generator
+#include <gtest/gtest.h>
+#include <numeric>
+#include "Generator.h"
+#include "Grid.h"
+#include "SegmentSolver.h"
+
+using namespace TrainTracks;
+
+TEST(GeneratorTest, ConstraintsMatchSolution) {
+    GeneratorOptions options;
+    options.width = 7;
+    options.height = 11;
+    options.seed = 3;
+
+    std::vector<Piece> solution;
+    const auto p = Generator::Generate(options, &solution);
+
+    EXPECT_EQ(p.gridWidth, 7);
+    EXPECT_EQ(p.gridHeight, 11);
+    ASSERT_EQ(solution.size(), 77u);
+    ASSERT_EQ(p.data.startingGrid.size(), 77u);
+
+    std::vector<int> rows(11, 0), cols(7, 0);
+    for (int y = 0; y < 11; y++) {
+        for (int x = 0; x < 7; x++) {
+            const auto piece = solution[Point{x, y}.project(7)];
+            if (piece != Piece::Empty) {
+                rows[y]++;
+                cols[x]++;
+            }
+            // Hints are taken from the solution
+            const auto hint = p.data.startingGrid[Point{x, y}.project(7)];
+            EXPECT_TRUE(hint == Piece::Empty || hint == piece);
+        }
+    }
+    EXPECT_EQ(rows, p.data.rowConstraints);
+    EXPECT_EQ(cols, p.data.colConstraints);
+    EXPECT_GE(std::accumulate(rows.begin(), rows.end(), 0), 18);
+}
+
+TEST(GeneratorTest, SameSeedSamePuzzle) {
+    GeneratorOptions options;
+    options.width = 10;
+    options.height = 10;
+    options.seed = 42;
+
+    const auto a = Generator::Generate(options);
+    const auto b = Generator::Generate(options);
+    EXPECT_EQ(a.data.rowConstraints, b.data.rowConstraints);
+    EXPECT_EQ(a.data.colConstraints, b.data.colConstraints);
+    EXPECT_EQ(a.data.startingGrid, b.data.startingGrid);
+
+    options.seed = 43;
+    const auto c = Generator::Generate(options);
+    EXPECT_NE(a.data.startingGrid, c.data.startingGrid);
+}
+
+TEST(GeneratorTest, GeneratedPuzzlesSolve) {
+    for (uint64_t seed = 0; seed < 20; seed++) {
+        GeneratorOptions options;
+        options.width = 6 + seed % 3;
+        options.height = 5 + seed % 4;
+        options.seed = seed;
+        options.hints = 0.3;
+
+        Grid grid(Generator::Generate(options));
+        SegmentSolver solver;
+        EXPECT_TRUE(solver.Solve(grid)) << "seed " << seed;
+        EXPECT_TRUE(grid.isComplete()) << "seed " << seed;
+    }
+}
+
+TEST(GeneratorTest, LargeGrid) {
+    GeneratorOptions options;
+    options.width = 60;
+    options.height = 50;
+    options.seed = 1;
+
+    const auto p = Generator::Generate(options);
+    Grid grid(p);
+    EXPECT_EQ(grid.cells(), 3000u);
+    EXPECT_EQ(grid.width(), 60);
+    EXPECT_EQ(grid.height(), 50);
+}
+
+TEST(GeneratorTest, RejectsTinyGrid) {
+    GeneratorOptions options;
+    options.width = 1;
+    EXPECT_THROW(Generator::Generate(options), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -6,6 +6,7 @@
 #include "Piece.h"
 #include "Point.h"
 #include "PathSolver.h"
+#include "TestPuzzles.h"
 
 using namespace TrainTracks;
 
@@ -23,38 +24,6 @@ static Puzzle makeSimplePuzzle() {
     return p;
 }
 
-static Puzzle makeSimpleSolvablePuzzle() {
-    Puzzle p;
-    p.data.rowConstraints = {1, 1, 1};
-    p.data.colConstraints = {0, 3, 0};
-    p.gridWidth = 3;
-    p.gridHeight = 3;
-    // Two vertical pieces at (1,0) and (1,2) as exits
-    p.data.startingGrid.assign(9, Piece::Empty);
-    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
-    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
-    return p;
-}
-
-/*
-  -+...
-  .|...
-  .+-+.
-  ...++
-  ....+
-*/
-static Puzzle makeSimplePuzzle5x5() {
-    Puzzle p;
-    p.data.rowConstraints = {2, 1, 3, 2, 1};
-    p.data.colConstraints = {1, 3, 1, 2, 2};
-    p.gridWidth = 5;
-    p.gridHeight = 5;
-    p.data.startingGrid.assign(25, Piece::Empty);
-    p.data.startingGrid[Point{0, 0}.project(5)] = Piece::Horizontal;
-    p.data.startingGrid[Point{4, 4}.project(5)] = Piece::CornerNE;
-    return p;
-}
-
 TEST(GridTest, ConstructorThrowsOnNoExits) {
     // Puzzle with no fixed pieces should throw due to missing exits
     Puzzle p;
@@ -184,6 +153,217 @@ TEST(GridTest, PlaceObviousPieces) {
     std::cout << g;
 }
 
+/*
+  -+..
+  .|..
+  .+-+
+  ...|
+  ...|
+  ...|
+*/
+static Puzzle makeTallPuzzle() {
+    Puzzle p;
+    p.data.rowConstraints = {2, 1, 3, 1, 1, 1};
+    p.data.colConstraints = {1, 3, 1, 4};
+    p.gridWidth = 4;
+    p.gridHeight = 6;
+    p.data.startingGrid.assign(24, Piece::Empty);
+    p.data.startingGrid[Point{0, 0}.project(4)] = Piece::Horizontal;
+    p.data.startingGrid[Point{3, 5}.project(4)] = Piece::Vertical;
+    return p;
+}
+
+TEST(GridTest, RectangularIndexing) {
+    Grid g(makeTallPuzzle());
+    EXPECT_EQ(g.width(), 4);
+    EXPECT_EQ(g.height(), 6);
+    EXPECT_EQ(g.cells(), 24u);
+    EXPECT_EQ(g.flatten(Point{3, 5}), 23);
+    EXPECT_EQ(g.flatten(Point{0, 1}), 4);
+
+    // Every cell is distinct
+    for (int y = 0; y < g.height(); y++) {
+        for (int x = 0; x < g.width(); x++) {
+            if (g.isEmpty(Point{x, y})) {
+                g.place(Point{x, y}, Piece::Horizontal);
+                EXPECT_EQ(g.at(x, y), Piece::Horizontal);
+            }
+        }
+    }
+    EXPECT_EQ(g.placed(), 24);
+}
+
+TEST(GridTest, IsInBoundsRejectsNegativeRows) {
+    Grid g(makeTallPuzzle());
+    EXPECT_TRUE(g.isInBounds(Point{3, 5}));
+    EXPECT_FALSE(g.isInBounds(Point{1, -1}));
+    EXPECT_FALSE(g.isInBounds(Point{4, 0}));
+    EXPECT_FALSE(g.isInBounds(Point{0, 6}));
+}
+
+TEST(GridTest, SolvesRectangularPuzzle) {
+    Grid g(makeTallPuzzle());
+    PathSolver s;
+    EXPECT_TRUE(s.Solve(g));
+    EXPECT_TRUE(g.isComplete());
+    EXPECT_EQ(g.at(Point{1, 2}), Piece::CornerNE);
+    EXPECT_EQ(g.at(Point{3, 2}), Piece::CornerSW);
+}
+
+TEST(GridTest, BytesGrowLinearly) {
+    Puzzle small = makeTallPuzzle();
+    Grid g(small);
+
+    Puzzle big;
+    big.gridWidth = 40;
+    big.gridHeight = 60;
+    big.data.rowConstraints.assign(60, 1);
+    big.data.colConstraints.assign(40, 0);
+    big.data.colConstraints[0] = 60;
+    big.data.startingGrid.assign(2400, Piece::Empty);
+    big.data.startingGrid[0] = Piece::Vertical;
+    big.data.startingGrid[Point{0, 59}.project(40)] = Piece::Vertical;
+    Grid b(big);
+
+    // 100 times the cells, the 16 bit counts per row and column keep it
+    // a little under 100 times the memory
+    EXPECT_GT(b.bytes(), g.bytes() * 40);
+    EXPECT_LT(b.bytes(), g.bytes() * 100);
+    // A byte per cell and a constraint and count per row and column
+    EXPECT_EQ(b.bytes(), b.cells() + 2 * sizeof(uint16_t) * (b.width() + b.height()));
+}
+
+TEST(GridTest, RemembersFixedPieces) {
+    Grid g(makeTallPuzzle());
+    EXPECT_TRUE(g.isFixed(Point{0, 0}));
+    EXPECT_TRUE(g.isFixed(Point{3, 5}));
+    EXPECT_FALSE(g.isFixed(Point{1, 0}));
+    EXPECT_EQ(g.fixedCount(), 2);
+
+    // Searching over a free cell leaves it free
+    g.place(Point{2, 3}, Piece::Horizontal);
+    EXPECT_FALSE(g.isFixed(Point{2, 3}));
+    g.remove(Point{2, 3});
+    EXPECT_TRUE(g.isEmpty(Point{2, 3}));
+    EXPECT_TRUE(g.isFixed(Point{0, 0}));
+}
+
+TEST(GridTest, ConnectedPathNeedsEveryPiece) {
+    Puzzle p;
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    p.data.rowConstraints = {1, 1, 1};
+    p.data.colConstraints = {0, 3, 0};
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
+    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
+    Grid g(p);
+    EXPECT_FALSE(g.isSingleConnectedPath());
+
+    g.place(Point{1, 1}, Piece::Vertical);
+    EXPECT_TRUE(g.isSingleConnectedPath());
+    EXPECT_TRUE(g.isComplete());
+
+    // A piece off the path breaks it even though the path is whole
+    g.remove(Point{1, 1});
+    g.place(Point{1, 1}, Piece::Horizontal);
+    EXPECT_FALSE(g.isSingleConnectedPath());
+}
+
+TEST(GridTest, RejectsConstraintsOutsideTheLine) {
+    Puzzle p = makeTallPuzzle();
+    p.data.rowConstraints[1] = 5;
+    EXPECT_THROW(Grid{p}, std::runtime_error);
+
+    p = makeTallPuzzle();
+    p.data.colConstraints[2] = -1;
+    EXPECT_THROW(Grid{p}, std::runtime_error);
+}
+
+TEST(GridTest, ResetMatchesAFreshGrid) {
+    Puzzle big;
+    big.gridWidth = 40;
+    big.gridHeight = 60;
+    big.data.rowConstraints.assign(60, 1);
+    big.data.colConstraints.assign(40, 0);
+    big.data.colConstraints[0] = 60;
+    big.data.startingGrid.assign(2400, Piece::Empty);
+    big.data.startingGrid[0] = Piece::Vertical;
+    big.data.startingGrid[Point{0, 59}.project(40)] = Piece::Vertical;
+
+    Grid g(big);
+    const auto bytes = g.bytes();
+    g.place(Point{0, 5}, Piece::Vertical);
+
+    const auto tall = makeTallPuzzle();
+    g.reset(tall);
+    const Grid fresh(tall);
+    EXPECT_EQ(g.width(), 4);
+    EXPECT_EQ(g.height(), 6);
+    EXPECT_EQ(g.toString(), fresh.toString());
+    EXPECT_EQ(g.placed(), fresh.placed());
+    EXPECT_EQ(g.target(), fresh.target());
+    EXPECT_EQ(g.fixedCount(), 2);
+    EXPECT_EQ(g.entry(), fresh.entry());
+    EXPECT_EQ(g.exit(), fresh.exit());
+    for (int y = 0; y < 6; y++) {
+        EXPECT_EQ(g.trackInRowCount(y), fresh.trackInRowCount(y));
+        EXPECT_EQ(g.rowConstraint(y), fresh.rowConstraint(y));
+    }
+    for (int x = 0; x < 4; x++) {
+        EXPECT_EQ(g.trackInColCount(x), fresh.trackInColCount(x));
+        EXPECT_EQ(g.colConstraint(x), fresh.colConstraint(x));
+    }
+    // The big puzzle's storage is kept for the small one
+    EXPECT_EQ(g.bytes(), bytes);
+
+    g.reset(big);
+    EXPECT_EQ(g.toString(), Grid(big).toString());
+    EXPECT_EQ(g.bytes(), bytes);
+}
+
+TEST(GridTest, ResetAfterABadPuzzle) {
+    Grid g(makeTallPuzzle());
+    Puzzle bad = makeTallPuzzle();
+    bad.data.startingGrid[0] = Piece::Empty;
+    EXPECT_THROW(g.reset(bad), std::runtime_error);
+
+    g.reset(makeTallPuzzle());
+    EXPECT_EQ(g.toString(), Grid(makeTallPuzzle()).toString());
+}
+
+TEST(GridTest, CopiesAreIndependent) {
+    const Grid original(makeTallPuzzle());
+    Grid copy(makeSimplePuzzle());
+    copy.copyFrom(original);
+    EXPECT_EQ(copy.toString(), original.toString());
+    EXPECT_EQ(copy.width(), original.width());
+    EXPECT_EQ(copy.entry(), original.entry());
+
+    copy.place(Point{2, 3}, Piece::Horizontal);
+    EXPECT_TRUE(original.isEmpty(Point{2, 3}));
+    EXPECT_EQ(copy.placed(), original.placed() + 1);
+
+    copy.copyFrom(copy);
+    EXPECT_EQ(copy.at(Point{2, 3}), Piece::Horizontal);
+}
+
+TEST(GridTest, Moves) {
+    Grid a(makeTallPuzzle());
+    const auto text = a.toString();
+    Grid b(std::move(a));
+    EXPECT_EQ(b.toString(), text);
+
+    Grid c(makeSimplePuzzle());
+    c = std::move(b);
+    EXPECT_EQ(c.toString(), text);
+    EXPECT_EQ(c.width(), 4);
+
+    // A moved from grid can be reset
+    b.reset(makeTallPuzzle());
+    EXPECT_EQ(b.toString(), text);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,144 @@
+// Unit tests for the HintEngine
+#include <gtest/gtest.h>
+#include "HintEngine.h"
+#include "Generator.h"
+#include "PathSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+// The top row is all track, so its far corner can only turn down
+//   ┌─┐
+//   │ │
+//   ┘ │
+static Puzzle makeFullRowPuzzle() {
+    Puzzle p;
+    p.data.rowConstraints = {3, 2, 2};
+    p.data.colConstraints = {3, 1, 3};
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{0, 2}.project(3)] = Piece::CornerNW;
+    p.data.startingGrid[Point{2, 2}.project(3)] = Piece::Vertical;
+    return p;
+}
+
+static Puzzle generate(int size, uint64_t seed) {
+    GeneratorOptions options;
+    options.width = size;
+    options.height = size;
+    options.seed = seed;
+    options.hints = 0.15;
+    return Generator::Generate(options);
+}
+
+// Enough time that only the rules decide, even in debug builds
+static HintOptions unhurried() {
+    HintOptions options;
+    options.budget = std::chrono::seconds(10);
+    return options;
+}
+
+TEST(HintEngine, SaturatedLineForcesACorner) {
+    Grid grid(makeFullRowPuzzle());
+    ASSERT_TRUE(grid.isEmpty(Point{2, 0}));
+    HintEngine engine(grid, unhurried());
+    const auto hint = engine.Next();
+    ASSERT_TRUE(hint.found());
+    EXPECT_EQ(hint.rule, HintRule::Saturation);
+    EXPECT_EQ(hint.cell, (Point{2, 0}));
+    EXPECT_EQ(hint.piece, Piece::CornerSW);
+    EXPECT_EQ(hint.probes, 0u);
+}
+
+TEST(HintEngine, HintsAgreeWithTheSolution) {
+    for (const uint64_t seed : { 1, 3, 4, 6 }) {
+        const auto puzzle = generate(16, seed);
+        Grid solved(puzzle);
+        PathSolver solver;
+        ASSERT_TRUE(solver.Solve(solved, SolveOptions()).solved());
+
+        // Forced pieces are in every solution, so follow the hints as far
+        // as they go
+        Grid grid(puzzle);
+        int hints = 0;
+        bool lookahead = false;
+        for (;;) {
+            HintEngine engine(grid, unhurried());
+            const auto hint = engine.Next();
+            if (!hint.found()) {
+                EXPECT_EQ(hint.status, HintStatus::None);
+                break;
+            }
+            ASSERT_TRUE(grid.isEmpty(hint.cell));
+            EXPECT_EQ(hint.piece, solved.at(hint.cell)) << "seed " << seed << " at " << hint.cell;
+            lookahead |= hint.rule == HintRule::Lookahead;
+            grid.place(hint.cell, hint.piece);
+            hints++;
+        }
+        EXPECT_GT(hints, 0);
+        if (seed == 1) {
+            EXPECT_TRUE(lookahead);
+        }
+    }
+}
+
+TEST(HintEngine, LookaheadCanBeTurnedOff) {
+    const auto puzzle = generate(16, 1);
+    Grid grid(puzzle);
+    auto options = unhurried();
+    options.lookahead = false;
+    for (;;) {
+        HintEngine engine(grid, options);
+        const auto hint = engine.Next();
+        if (!hint.found()) {
+            EXPECT_EQ(hint.status, HintStatus::None);
+            break;
+        }
+        EXPECT_NE(hint.rule, HintRule::Lookahead);
+        EXPECT_EQ(hint.probes, 0u);
+        grid.place(hint.cell, hint.piece);
+    }
+
+    // Where the cheaper rules stop, lookahead still finds more
+    HintEngine engine(grid, unhurried());
+    const auto hint = engine.Next();
+    ASSERT_TRUE(hint.found());
+    EXPECT_EQ(hint.rule, HintRule::Lookahead);
+    EXPECT_GT(hint.probes, 0u);
+}
+
+TEST(HintEngine, LeavesTheGridAlone) {
+    Grid grid(generate(16, 3));
+    const auto before = grid.toString();
+    const auto placed = grid.placed();
+    HintEngine engine(grid, unhurried());
+    ASSERT_TRUE(engine.Next().found());
+    EXPECT_EQ(grid.toString(), before);
+    EXPECT_EQ(grid.placed(), placed);
+}
+
+TEST(HintEngine, ReportsContradictions) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    HintEngine engine(grid, unhurried());
+    EXPECT_EQ(engine.Next().status, HintStatus::Contradiction);
+}
+
+TEST(HintEngine, StopsAtTheBudget) {
+    Grid grid(generate(30, 1));
+    HintOptions options;
+    options.budget = std::chrono::nanoseconds(0);
+    HintEngine engine(grid, options);
+    const auto hint = engine.Next();
+    EXPECT_EQ(hint.status, HintStatus::TimedOut);
+    EXPECT_LT(hint.elapsed, std::chrono::milliseconds(5));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
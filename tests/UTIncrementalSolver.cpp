@@ -0,0 +1,200 @@
+// Unit tests for the IncrementalSolver
+#include <gtest/gtest.h>
+#include "IncrementalSolver.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+static Puzzle generate(int size, uint64_t seed) {
+    GeneratorOptions options;
+    options.width = size;
+    options.height = size;
+    options.seed = seed;
+    options.hints = 0.15;
+    return Generator::Generate(options);
+}
+
+// Whether cells are a solution of the puzzle: they keep its fixed pieces and
+// make a complete grid when given as its starting grid
+static bool solves(const Puzzle& puzzle, const std::vector<Piece>& cells) {
+    if (cells.size() != puzzle.data.startingGrid.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < cells.size(); i++) {
+        const auto fixed = puzzle.data.startingGrid[i];
+        if (fixed != Piece::Empty && fixed != cells[i]) {
+            return false;
+        }
+    }
+    Puzzle filled = puzzle;
+    filled.data.startingGrid = cells;
+    return Grid(filled).isComplete();
+}
+
+// Moves the first corner of the track it can to the opposite cell of the
+// square it turns in, so the track cuts the corner the other way:
+//   ┐.     ..
+//   └┘  -> ┌┘
+// Returns the fourth cell, which the new track now passes through.
+static Point flipCorner(const Puzzle& puzzle, std::vector<Piece>& cells) {
+    const auto width = puzzle.gridWidth;
+    const Grid grid(puzzle);
+    const auto replace = [](Piece p, const Point& from, const Point& to) {
+        const auto conns = Connections::GetConnections(p);
+        const auto first = conns.front();
+        const auto second = conns.back();
+        return Connections::GetPiece(first == from ? to : first, second == from ? to : second);
+    };
+    for (int y = 0; y < puzzle.gridHeight; y++) {
+        for (int x = 0; x < width; x++) {
+            const Point c{x, y};
+            const auto piece = cells[c.project(width)];
+            if (piece == Piece::Empty || piece == Piece::Horizontal || piece == Piece::Vertical) {
+                continue;
+            }
+            const auto conns = Connections::GetConnections(piece);
+            const auto a = conns.front();
+            const auto b = conns.back();
+            const auto d = c + a + b;
+            const auto n1 = c + a;
+            const auto n2 = c + b;
+            if (!grid.isInBounds(d) || !grid.isInBounds(n1) || !grid.isInBounds(n2) ||
+                cells[d.project(width)] != Piece::Empty ||
+                puzzle.data.startingGrid[c.project(width)] != Piece::Empty ||
+                puzzle.data.startingGrid[n1.project(width)] != Piece::Empty ||
+                puzzle.data.startingGrid[n2.project(width)] != Piece::Empty) {
+                continue;
+            }
+            cells[n1.project(width)] = replace(cells[n1.project(width)], a.inverse(), b);
+            cells[n2.project(width)] = replace(cells[n2.project(width)], b.inverse(), a);
+            cells[d.project(width)] = Connections::GetPiece(b.inverse(), a.inverse());
+            cells[c.project(width)] = Piece::Empty;
+            return d;
+        }
+    }
+    return Point{-1, -1};
+}
+
+TEST(IncrementalSolver, FirstResolveSearches) {
+    IncrementalSolver solver(makeSimpleSolvablePuzzle());
+    const auto result = solver.Resolve();
+    ASSERT_TRUE(result.solved());
+    EXPECT_EQ(result.method, ResolveMethod::Searched);
+    EXPECT_EQ(result.repairs, 0);
+    EXPECT_EQ(result.solution, solver.solution());
+    EXPECT_TRUE(solves(solver.puzzle(), solver.solution()));
+}
+
+TEST(IncrementalSolver, KeepsASolutionTheEditAgreesWith) {
+    const auto puzzle = generate(12, 3);
+    IncrementalSolver solver(puzzle);
+    ASSERT_TRUE(solver.Resolve().solved());
+    const auto before = solver.solution();
+
+    // Fix a piece the solution already has
+    for (size_t i = 0; i < before.size(); i++) {
+        if (before[i] != Piece::Empty && puzzle.data.startingGrid[i] == Piece::Empty) {
+            solver.Fix(Point{ static_cast<int>(i % 12), static_cast<int>(i / 12) }, before[i]);
+            break;
+        }
+    }
+    auto result = solver.Resolve();
+    ASSERT_TRUE(result.solved());
+    EXPECT_EQ(result.method, ResolveMethod::Kept);
+    EXPECT_EQ(result.steps, 0u);
+    EXPECT_EQ(solver.solution(), before);
+
+    // Freeing a hint keeps it too
+    solver.Edit(puzzle);
+    result = solver.Resolve();
+    EXPECT_EQ(result.method, ResolveMethod::Kept);
+    EXPECT_EQ(solver.solution(), before);
+}
+
+TEST(IncrementalSolver, RepairsAroundAnEdit) {
+    // Seeds PathSolver solves quickly from scratch
+    for (const uint64_t seed : { 1, 3, 5, 7 }) {
+        const auto puzzle = generate(16, seed);
+        IncrementalSolver solver(puzzle);
+        ASSERT_TRUE(solver.Resolve().solved());
+
+        // Edit the puzzle so the solution must change: cut one corner the
+        // other way, fixing the cell the track now passes through
+        auto cells = solver.solution();
+        const auto moved = flipCorner(puzzle, cells);
+        ASSERT_TRUE(Grid(puzzle).isInBounds(moved));
+        Puzzle edited = puzzle;
+        edited.data.rowConstraints.assign(16, 0);
+        edited.data.colConstraints.assign(16, 0);
+        for (size_t i = 0; i < cells.size(); i++) {
+            if (cells[i] != Piece::Empty) {
+                edited.data.rowConstraints[i / 16]++;
+                edited.data.colConstraints[i % 16]++;
+            }
+        }
+        edited.data.startingGrid[moved.project(16)] = cells[moved.project(16)];
+        solver.Edit(edited);
+
+        const auto result = solver.Resolve();
+        ASSERT_TRUE(result.solved());
+        EXPECT_EQ(result.method, ResolveMethod::Repaired);
+        EXPECT_GE(result.repairs, 1);
+        EXPECT_TRUE(solves(edited, solver.solution()));
+    }
+}
+
+TEST(IncrementalSolver, RejectsInvalidEditsUntilFixed) {
+    IncrementalSolver solver(makeSimpleSolvablePuzzle());
+    ASSERT_TRUE(solver.Resolve().solved());
+
+    // Rows and columns no longer add up to the same track
+    solver.RowConstraint(0, 2);
+    EXPECT_THROW(solver.Resolve(), std::runtime_error);
+    solver.RowConstraint(0, 1);
+    const auto result = solver.Resolve();
+    ASSERT_TRUE(result.solved());
+    EXPECT_EQ(result.method, ResolveMethod::Kept);
+
+    EXPECT_THROW(solver.Fix(Point{3, 0}, Piece::Vertical), std::runtime_error);
+}
+
+TEST(IncrementalSolver, SearchesWhenNoRepairCan) {
+    IncrementalSolver solver(makeSimpleSolvablePuzzle());
+    ASSERT_TRUE(solver.Resolve().solved());
+
+    // The middle row may no longer hold track, so nothing joins the ends
+    solver.RowConstraint(1, 0);
+    solver.ColConstraint(1, 2);
+    const auto result = solver.Resolve();
+    EXPECT_EQ(result.status, SolveStatus::Unsolvable);
+    EXPECT_EQ(result.method, ResolveMethod::Searched);
+    EXPECT_TRUE(solver.solution().empty());
+}
+
+TEST(IncrementalSolver, StopsAtTheStepBudget) {
+    IncrementalOptions options;
+    options.repairSteps = 1;
+    const auto puzzle = generate(16, 1);
+    IncrementalSolver solver(puzzle, nullptr, options);
+    ASSERT_TRUE(solver.Resolve().solved());
+
+    auto cells = solver.solution();
+    const auto moved = flipCorner(puzzle, cells);
+    solver.Fix(moved, cells[moved.project(16)]);
+    SolveOptions limits;
+    limits.maxSteps = 1;
+    const auto result = solver.Resolve(limits);
+    EXPECT_EQ(result.status, SolveStatus::TimedOut);
+    EXPECT_LE(result.steps, 1u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,115 @@
+// Unit tests for the LiveRenderer class
+#include <gtest/gtest.h>
+#include "LiveRenderer.h"
+#include "PathSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+#include <sstream>
+
+using namespace TrainTracks;
+
+static LiveRendererOptions manual() {
+    LiveRendererOptions options;
+    options.fps = 0;
+    return options;
+}
+
+static size_t count(const std::string& s, const std::string& what) {
+    size_t n = 0;
+    for (auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+TEST(LiveRenderer, FirstFrameDrawsEveryCell) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::ostringstream out;
+    LiveRenderer renderer(grid, out, manual());
+
+    renderer.Report(10, Point{1, 1});
+    EXPECT_TRUE(renderer.Tick());
+    EXPECT_EQ(renderer.Frames(), 1u);
+
+    const auto frame = out.str();
+    EXPECT_EQ(frame.rfind("\033[2J", 0), 0u);
+    // One move per row and one for the status line
+    EXPECT_EQ(count(frame, "H"), 4u);
+    EXPECT_EQ(count(frame, PieceSymbol(Piece::Vertical)), 2u);
+    EXPECT_NE(frame.find("Steps: 10"), std::string::npos);
+    EXPECT_NE(frame.find("Current: {1,1}"), std::string::npos);
+}
+
+TEST(LiveRenderer, LaterFramesDrawOnlyChangedCells) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::ostringstream out;
+    LiveRenderer renderer(grid, out, manual());
+
+    renderer.Report(1, Point{1, 0});
+    ASSERT_TRUE(renderer.Tick());
+    const auto first = renderer.LastFrameBytes();
+    out.str("");
+
+    grid.place(Point{1, 1}, Piece::Vertical);
+    renderer.Report(2, Point{1, 1});
+    ASSERT_TRUE(renderer.Tick());
+
+    const auto frame = out.str();
+    EXPECT_EQ(frame.find("\033[2J"), std::string::npos);
+    EXPECT_NE(frame.find("\033[2;2H" + std::string(PieceSymbol(Piece::Vertical))), std::string::npos);
+    EXPECT_EQ(count(frame, "H"), 2u);
+    EXPECT_LT(renderer.LastFrameBytes(), first);
+}
+
+TEST(LiveRenderer, NothingDrawnWithoutReport) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::ostringstream out;
+    LiveRenderer renderer(grid, out, manual());
+
+    EXPECT_FALSE(renderer.Tick());
+    renderer.Report(1, Point{1, 0});
+    EXPECT_TRUE(renderer.Tick());
+    EXPECT_FALSE(renderer.Tick());
+    EXPECT_EQ(renderer.Frames(), 1u);
+}
+
+TEST(LiveRenderer, ReportsWhileDrawPendingAreDropped) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::ostringstream out;
+    LiveRenderer renderer(grid, out, manual());
+
+    renderer.Report(1, Point{1, 0});
+    renderer.Report(2, Point{1, 1});
+    ASSERT_TRUE(renderer.Tick());
+    EXPECT_NE(out.str().find("Steps: 1 "), std::string::npos);
+}
+
+TEST(LiveRenderer, StopDrawsTheFinishedGrid) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::ostringstream out;
+    LiveRendererOptions options;
+    options.fps = 1000;
+    options.interval = 1;
+    LiveRenderer renderer(grid, out, options);
+
+    PathSolver solver;
+    solver.Reporter(&renderer);
+    const auto result = solver.Solve(grid, SolveOptions());
+    ASSERT_TRUE(result.solved());
+    renderer.Stop();
+
+    EXPECT_GE(renderer.Frames(), 1u);
+    // The final frame has the solved column, however much was drawn before
+    const auto frame = out.str();
+    EXPECT_GE(count(frame, PieceSymbol(Piece::Vertical)), 3u);
+    EXPECT_EQ(frame.back(), '\n');
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
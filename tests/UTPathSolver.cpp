@@ -7,47 +7,11 @@
 #include "Piece.h"
 #include "Point.h"
 #include "ConsoleReporter.h"
+#include "Generator.h"
+#include "TestPuzzles.h"
 
 using namespace TrainTracks;
 
-static Puzzle makeSimpleSolvablePuzzle() {
-    Puzzle p;
-    p.data.rowConstraints = {1, 1, 1};
-    p.data.colConstraints = {0, 3, 0};
-    p.gridWidth = 3;
-    p.gridHeight = 3;
-    // Two vertical pieces at (1,0) and (1,2) as exits
-    p.data.startingGrid.assign(9, Piece::Empty);
-    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
-    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
-    return p;
-}
-
-static Puzzle makeSimpleUnsolvablePuzzle() {
-    Puzzle p;
-    p.data.rowConstraints = {1, 0, 1};
-    p.data.colConstraints = {0, 2, 0};
-    p.gridWidth = 3;
-    p.gridHeight = 3;
-    // Two vertical pieces at (1,0) and (1,2) as exits, but they can't connect
-    p.data.startingGrid.assign(9, Piece::Empty);
-    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
-    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
-    return p;
-}
-
-static Puzzle makeLargerSolvablePuzzle() {
-    Puzzle p;
-    p.data.rowConstraints = {2, 2, 2, 2, 2, 2, 2, 2, 2,};
-    p.data.colConstraints = {1, 2, 2, 2, 2, 2, 2, 2, 2, 1};
-    p.gridWidth = p.data.colConstraints.size();
-    p.gridHeight = p.data.rowConstraints.size();
-    p.data.startingGrid.assign(p.gridWidth * p.gridHeight, Piece::Empty);
-    p.data.startingGrid[Point{0, 0}.project(p.gridWidth)] = Piece::Horizontal;
-    p.data.startingGrid[Point{p.gridWidth - 1, p.gridHeight - 1}.project(p.gridWidth)] = Piece::Horizontal;
-    return p;
-}
-
 TEST(PathSolverTest, SolvesSimplePuzzle) {
     const auto p = makeSimpleSolvablePuzzle();
     Grid g(p);
@@ -64,8 +28,9 @@ TEST(PathSolverTest, DoesntSolvesimplePuzzle) {
 
     PathSolver ps;
     EXPECT_FALSE(ps.Solve(g));
-    // Entry, then no where to go
-    EXPECT_EQ(ps.Steps(), 2);
+    // The empty middle row cuts the entry off from the exit
+    EXPECT_EQ(ps.Steps(), 1);
+    EXPECT_EQ(ps.Stats().cuts, 1u);
 }
 
 TEST(PathSolverTest, SolvesLargerPuzzle)
@@ -160,6 +125,96 @@ TEST(PathSolverTest, LargeJsonPuzzle) {
     EXPECT_EQ(grid_string, solution);
 }
 
+// Cuts only drop branches which can't succeed, so the search still finds
+// the same first solution
+TEST(PathSolverTest, CutsKeepTheSameSolution) {
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        GeneratorOptions options;
+        options.width = 8;
+        options.height = 8;
+        options.seed = seed;
+        options.hints = 0.1;
+        const auto p = Generator::Generate(options);
+
+        PathSolverOptions plain;
+        plain.cuts = false;
+        PathSolver without(plain);
+        Grid a(p);
+        ASSERT_TRUE(without.Solve(a)) << "seed " << seed;
+
+        PathSolver with;
+        Grid b(p);
+        ASSERT_TRUE(with.Solve(b)) << "seed " << seed;
+        EXPECT_EQ(a.toString(), b.toString()) << "seed " << seed;
+        EXPECT_LE(with.Steps(), without.Steps()) << "seed " << seed;
+        EXPECT_EQ(without.Stats().cuts, 0u);
+    }
+}
+
+// Backjumps only skip decisions a dead end doesn't depend on, so the first
+// solution is the same too
+TEST(PathSolverTest, BackjumpsKeepTheSameSolution) {
+    std::vector<Puzzle> puzzles{ makeHardPuzzle() };
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        GeneratorOptions options;
+        options.width = 10;
+        options.height = 10;
+        options.seed = seed;
+        options.hints = 0.1;
+        puzzles.push_back(Generator::Generate(options));
+    }
+    for (size_t i = 0; i < puzzles.size(); i++) {
+        PathSolverOptions plain;
+        plain.backjumps = false;
+        PathSolver without(plain);
+        Grid a(puzzles[i]);
+        ASSERT_TRUE(without.Solve(a)) << "puzzle " << i;
+
+        PathSolver with;
+        Grid b(puzzles[i]);
+        ASSERT_TRUE(with.Solve(b)) << "puzzle " << i;
+        EXPECT_EQ(a.toString(), b.toString()) << "puzzle " << i;
+        EXPECT_LE(with.Steps(), without.Steps()) << "puzzle " << i;
+        EXPECT_EQ(without.Stats().backjumps, 0u);
+    }
+
+    // The hard puzzle's fixed pieces are often left pointing at a full row
+    // or column long before the search runs into them
+    PathSolverOptions plain;
+    plain.backjumps = false;
+    PathSolver without(plain);
+    PathSolver with;
+    Grid a(puzzles[0]);
+    Grid b(puzzles[0]);
+    ASSERT_TRUE(without.Solve(a));
+    ASSERT_TRUE(with.Solve(b));
+    EXPECT_GT(with.Stats().backjumps, 0u);
+    EXPECT_LT(with.Steps() * 2, without.Steps());
+}
+
+TEST(PathSolverTest, NogoodsKeepTheSameSolution) {
+    GeneratorOptions options;
+    options.width = 9;
+    options.height = 9;
+    options.seed = 4;
+    options.hints = 0.05;
+    const auto p = Generator::Generate(options);
+
+    PathSolver plain;
+    Grid a(p);
+    ASSERT_TRUE(plain.Solve(a));
+
+    PathSolverOptions config;
+    config.nogoodBits = 12;
+    PathSolver remembering(config);
+    Grid b(p);
+    ASSERT_TRUE(remembering.Solve(b));
+    EXPECT_EQ(a.toString(), b.toString());
+    EXPECT_LE(remembering.Steps(), plain.Steps());
+    EXPECT_GT(remembering.Stats().nogoods, 0u);
+    EXPECT_EQ(plain.Stats().nogoods, 0u);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,84 @@
+// Unit tests for PerfCounters
+#include <gtest/gtest.h>
+#include "PerfCounters.h"
+
+using namespace TrainTracks;
+
+static uint64_t busyWork(int n) {
+    volatile uint64_t total = 0;
+    for (int i = 0; i < n; i++) {
+        total = total + static_cast<uint64_t>(i) * 3;
+    }
+    return total;
+}
+
+TEST(PerfCounters, ExplainsWhatIsMissing) {
+    PerfCounters counters;
+    if (!counters.Available()) {
+        EXPECT_FALSE(counters.Error().empty());
+    }
+    for (size_t i = 0; i < PerfEventCount; i++) {
+        if (!counters.Available(static_cast<PerfEvent>(i))) {
+            EXPECT_FALSE(counters.Error().empty());
+        }
+    }
+}
+
+TEST(PerfCounters, SamplesOnlyWhatOpened) {
+    PerfCounters counters;
+    counters.Start();
+    busyWork(1000);
+    const auto sample = counters.Stop();
+
+    EXPECT_EQ(sample.any(), counters.Available());
+    for (size_t i = 0; i < PerfEventCount; i++) {
+        const auto e = static_cast<PerfEvent>(i);
+        EXPECT_EQ(sample.has(e), counters.Available(e));
+        if (!sample.has(e)) {
+            EXPECT_EQ(sample[e], 0u);
+        }
+    }
+}
+
+TEST(PerfCounters, CountsGrowWithWork) {
+    PerfCounters counters;
+    if (!counters.Available(PerfEvent::Instructions)) {
+        GTEST_SKIP() << "No instruction counter: " << counters.Error();
+    }
+    counters.Start();
+    busyWork(1000);
+    const auto small = counters.Stop();
+    counters.Start();
+    busyWork(1000000);
+    const auto large = counters.Stop();
+
+    EXPECT_GT(small[PerfEvent::Instructions], 0u);
+    EXPECT_GT(large[PerfEvent::Instructions], small[PerfEvent::Instructions] * 10);
+}
+
+TEST(PerfCounters, SamplesAddUp) {
+    PerfSample a;
+    a.valid[static_cast<size_t>(PerfEvent::Cycles)] = true;
+    a.values[static_cast<size_t>(PerfEvent::Cycles)] = 100;
+    PerfSample b;
+    b.valid[static_cast<size_t>(PerfEvent::Cycles)] = true;
+    b.values[static_cast<size_t>(PerfEvent::Cycles)] = 300;
+    b.valid[static_cast<size_t>(PerfEvent::Instructions)] = true;
+    b.values[static_cast<size_t>(PerfEvent::Instructions)] = 800;
+
+    PerfSample total;
+    EXPECT_FALSE(total.any());
+    EXPECT_EQ(total.ipc(), 0.0);
+    total += a;
+    EXPECT_EQ(total.ipc(), 0.0);
+    total += b;
+    EXPECT_TRUE(total.has(PerfEvent::Instructions));
+    EXPECT_FALSE(total.has(PerfEvent::LLCMisses));
+    EXPECT_EQ(total[PerfEvent::Cycles], 400u);
+    EXPECT_DOUBLE_EQ(total.ipc(), 2.0);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
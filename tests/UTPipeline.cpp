@@ -0,0 +1,160 @@
+// Unit tests for the Pipeline class
+#include <gtest/gtest.h>
+#include "Pipeline.h"
+#include "Generator.h"
+#include "Puzzle.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace TrainTracks;
+
+static std::string format(const PipelineRecord& r) {
+    return r.id + " " + (r.error.empty() ? SolveStatusName(r.result.status) : "Error") + "\n";
+}
+
+static std::vector<std::string> lines(const std::string& s) {
+    std::vector<std::string> out;
+    std::istringstream is(s);
+    std::string line;
+    while (std::getline(is, line)) {
+        out.push_back(line);
+    }
+    return out;
+}
+
+// count generated puzzles, one per line, with every seventh line broken
+static std::string input(int count) {
+    std::string in;
+    for (int i = 0; i < count; i++) {
+        if (i % 7 == 3) {
+            in.append("{\"rows\":[1,2],\"cols\":[]}\n");
+            continue;
+        }
+        GeneratorOptions options;
+        options.width = 6;
+        options.height = 6;
+        options.seed = i;
+        in.append(Generator::Generate(options).toJson()).append("\n");
+    }
+    return in;
+}
+
+static std::string expected(int i) {
+    return std::to_string(i + 1) + (i % 7 == 3 ? " Error" : " Solved");
+}
+
+TEST(Pipeline, WritesResultsInInputOrder) {
+    PipelineOptions options;
+    options.parsers = 2;
+    options.presolvers = 2;
+    options.searchers = 3;
+    options.serialisers = 2;
+    options.queueCapacity = 4;
+    options.window = 16;
+    Pipeline pipeline(format, options);
+
+    std::istringstream in(input(100));
+    std::ostringstream out;
+    const auto stats = pipeline.Run(in, out);
+
+    const auto got = lines(out.str());
+    ASSERT_EQ(got.size(), 100u);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(got[i], expected(i));
+    }
+    EXPECT_EQ(stats.records, 100u);
+    EXPECT_EQ(stats.errors, 14u);
+    EXPECT_EQ(stats.counts[static_cast<int>(SolveStatus::Solved)], 86u);
+    EXPECT_GT(stats.steps, 0u);
+    EXPECT_LT(stats.maxHeld, options.window);
+}
+
+TEST(Pipeline, UnorderedWritesEverything) {
+    PipelineOptions options;
+    options.searchers = 3;
+    options.window = 8;
+    options.ordered = false;
+    Pipeline pipeline(format, options);
+
+    std::istringstream in(input(50));
+    std::ostringstream out;
+    const auto stats = pipeline.Run(in, out);
+
+    auto got = lines(out.str());
+    std::vector<std::string> want;
+    for (int i = 0; i < 50; i++) {
+        want.push_back(expected(i));
+    }
+    std::sort(got.begin(), got.end());
+    std::sort(want.begin(), want.end());
+    EXPECT_EQ(got, want);
+    EXPECT_EQ(stats.records, 50u);
+    EXPECT_EQ(stats.maxHeld, 0u);
+}
+
+TEST(Pipeline, KeepsRequestIdsAndSkipsBlankLines) {
+    Pipeline pipeline(format);
+    std::istringstream in(
+        "{\"id\":\"first\",\"rows\":[1,1,1],\"cols\":[0,3,0],\"startingGrid\":[0,4,0,0,0,0,0,4,0]}\n"
+        "\n"
+        "  \n"
+        "{\"rows\":[1,0,1],\"cols\":[0,2,0],\"startingGrid\":[0,4,0,0,0,0,0,4,0]}\n"
+        "{\"id\":9,\"rows\":[1,1,1],\"cols\":[0,3,0],\"startingGrid\":[0,4,0]}\n");
+    std::ostringstream out;
+    const auto stats = pipeline.Run(in, out);
+
+    EXPECT_EQ(lines(out.str()), (std::vector<std::string>{ "\"first\" Solved", "4 Unsolvable", "9 Error" }));
+    EXPECT_EQ(stats.records, 3u);
+    EXPECT_EQ(stats.errors, 1u);
+}
+
+TEST(Pipeline, SolvesWithTheSearchOptions) {
+    PipelineOptions options;
+    options.solve.maxSteps = 1;
+    Pipeline pipeline(format, options);
+
+    GeneratorOptions generator;
+    generator.width = 10;
+    generator.height = 10;
+    generator.hints = 0;
+    std::istringstream in(Generator::Generate(generator).toJson() + "\n");
+    std::ostringstream out;
+    const auto stats = pipeline.Run(in, out);
+
+    EXPECT_EQ(out.str(), "1 TimedOut\n");
+    EXPECT_EQ(stats.counts[static_cast<int>(SolveStatus::TimedOut)], 1u);
+}
+
+TEST(Pipeline, RunsAgain) {
+    Pipeline pipeline(format);
+    for (int i = 0; i < 2; i++) {
+        std::istringstream in(input(5));
+        std::ostringstream out;
+        EXPECT_EQ(pipeline.Run(in, out).records, 5u);
+        EXPECT_EQ(lines(out.str()).size(), 5u);
+    }
+}
+
+TEST(Pipeline, EmptyInput) {
+    Pipeline pipeline(format);
+    std::istringstream in("");
+    std::ostringstream out;
+    EXPECT_EQ(pipeline.Run(in, out).records, 0u);
+    EXPECT_TRUE(out.str().empty());
+}
+
+TEST(Pipeline, RejectsBadOptions) {
+    PipelineOptions options;
+    options.presolvers = 0;
+    EXPECT_THROW(Pipeline(format, options), std::runtime_error);
+    options = PipelineOptions();
+    options.window = 0;
+    EXPECT_THROW(Pipeline(format, options), std::runtime_error);
+    EXPECT_THROW(Pipeline(nullptr), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,161 @@
+// Unit tests for the PortfolioSolver class
+#include <gtest/gtest.h>
+#include "PortfolioSolver.h"
+#include "PathSolver.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+static std::vector<PortfolioEntry> pathOnly() {
+    return {
+        { "path", [] { return std::make_unique<PathSolver>(); } },
+        { "path-exit", [] {
+            PathSolverOptions options;
+            options.fromExit = true;
+            return std::make_unique<PathSolver>(options);
+        } },
+    };
+}
+
+TEST(PortfolioSolverTest, SolvesIntoCallersGrid) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    PortfolioSolver solver;
+    const auto r = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(r.status, SolveStatus::Solved);
+    EXPECT_TRUE(grid.isComplete());
+    EXPECT_EQ(grid.at(Point{1, 1}), Piece::Vertical);
+    EXPECT_GT(r.steps, 0u);
+    EXPECT_GT(r.peakBytes, 0u);
+    EXPECT_GE(solver.LastWinner(), 0);
+}
+
+TEST(PortfolioSolverTest, SegmentWinsHardPuzzle) {
+    Grid grid(makeHardPuzzle());
+    PortfolioSolver solver;
+    const auto r = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(r.status, SolveStatus::Solved);
+    EXPECT_TRUE(grid.isComplete());
+
+    const auto stats = solver.Stats();
+    ASSERT_EQ(stats.size(), 4u);
+    EXPECT_EQ(stats[solver.LastWinner()].name, "segment");
+}
+
+TEST(PortfolioSolverTest, Unsolvable) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    PortfolioSolver solver(pathOnly());
+    const auto r = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(r.status, SolveStatus::Unsolvable);
+    EXPECT_FALSE(grid.isComplete());
+}
+
+TEST(PortfolioSolverTest, DeadlineInterruptsEveryEntry) {
+    Grid grid(makeHardPuzzle());
+    PortfolioSolver solver(pathOnly());
+    SolveOptions options;
+    options.deadline = SolveClock::now() + std::chrono::milliseconds(50);
+    const auto r = solver.Solve(grid, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(solver.LastWinner(), -1);
+    EXPECT_LT(r.elapsed, std::chrono::seconds(5));
+}
+
+TEST(PortfolioSolverTest, ExternalCancel) {
+    Grid grid(makeHardPuzzle());
+    PortfolioSolver solver(pathOnly());
+    std::atomic<bool> cancel(false);
+    SolveOptions options;
+    options.cancel = &cancel;
+
+    std::thread canceller([&cancel] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancel = true;
+    });
+    const auto r = solver.Solve(grid, options);
+    canceller.join();
+    EXPECT_EQ(r.status, SolveStatus::Cancelled);
+}
+
+TEST(PortfolioSolverTest, StepBudgetSpansEntries) {
+    Grid grid(makeHardPuzzle());
+    PortfolioSolver solver(pathOnly());
+    SolveOptions options;
+    options.maxSteps = 1001;
+    const auto r = solver.Solve(grid, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(r.steps, 1001u);
+    const auto stats = solver.Stats();
+    EXPECT_EQ(stats[0].steps, 501u);
+    EXPECT_EQ(stats[1].steps, 500u);
+
+    // Too few to go round
+    Grid small(makeSimpleSolvablePuzzle());
+    options.maxSteps = 2;
+    EXPECT_LE(solver.Solve(small, options).steps, 2u);
+}
+
+class CountingReporter
+    : public ProgressReporter {
+public:
+    CountingReporter()
+        : ProgressReporter(1)
+    { }
+
+    void Report(uint64_t, const Point&) override { reports++; }
+
+    uint64_t reports = 0;
+};
+
+TEST(PortfolioSolverTest, ReportsTheFirstEntry) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    PortfolioSolver solver(pathOnly());
+    CountingReporter reporter;
+    solver.Reporter(&reporter);
+    ASSERT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+    EXPECT_GT(reporter.reports, 0u);
+    EXPECT_LE(reporter.reports, solver.Stats().front().steps);
+}
+
+TEST(PortfolioSolverTest, RecordsWinRates) {
+    PortfolioSolver solver(pathOnly());
+    for (int i = 0; i < 3; i++) {
+        Grid grid(makeSimpleSolvablePuzzle());
+        EXPECT_TRUE(solver.Solve(grid));
+    }
+
+    const auto stats = solver.Stats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].name, "path");
+    EXPECT_EQ(stats[0].runs, 3u);
+    EXPECT_EQ(stats[1].runs, 3u);
+    EXPECT_EQ(stats[0].wins + stats[1].wins, 3u);
+    EXPECT_DOUBLE_EQ(stats[0].winRate() + stats[1].winRate(), 1.0);
+}
+
+TEST(PortfolioSolverTest, RejectsEmptyPortfolio) {
+    EXPECT_THROW(PortfolioSolver(std::vector<PortfolioEntry>{}), std::runtime_error);
+}
+
+TEST(PathSolverOptionsTest, FromExitAndShuffled) {
+    PathSolverOptions fromExit;
+    fromExit.fromExit = true;
+    PathSolverOptions shuffled;
+    shuffled.seed = 7;
+
+    for (const auto& options : { fromExit, shuffled }) {
+        Grid grid(makeSimpleSolvablePuzzle());
+        PathSolver solver(options);
+        EXPECT_TRUE(solver.Solve(grid));
+        EXPECT_TRUE(grid.isComplete());
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+// Unit tests for the Presolver class
+#include <gtest/gtest.h>
+#include "Presolver.h"
+#include "PathSolver.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+TEST(DomainsTest, BitsRoundTrip) {
+    EXPECT_EQ(DomainBit(Piece::Empty), EmptyDomain);
+    for (const auto p : ValidPieces) {
+        EXPECT_TRUE(IsSingleton(DomainBit(p)));
+        EXPECT_EQ(DomainBit(p) & EmptyDomain, 0);
+        EXPECT_EQ(DomainPiece(DomainBit(p)), p);
+    }
+    EXPECT_EQ(DomainPiece(EmptyDomain), Piece::Empty);
+    EXPECT_EQ(DomainPiece(TrackDomain), Piece::Empty);
+    EXPECT_FALSE(IsSingleton(TrackDomain));
+}
+
+TEST(PresolverTest, EmptyLinesAndEdges) {
+    const auto p = makeSimplePuzzle5x5();
+    Grid g(p);
+    Presolver pre(g);
+    EXPECT_TRUE(pre.Propagate());
+
+    const auto& d = pre.domains();
+    // Nothing may leave the grid apart from the entry and exit
+    EXPECT_FALSE(d.allows(Point{0, 2}, Piece::Horizontal));
+    EXPECT_FALSE(d.allows(Point{2, 4}, Piece::Vertical));
+    // Fixed pieces keep their value
+    EXPECT_EQ(d.known(Point{0, 0}), Piece::Horizontal);
+    EXPECT_EQ(d.known(Point{4, 4}), Piece::CornerNE);
+}
+
+TEST(PresolverTest, CommitsForcedPieces) {
+    const auto p = makeSimpleSolvablePuzzle();
+    Grid g(p);
+    Presolver pre(g);
+    EXPECT_TRUE(pre.Propagate());
+
+    // Columns 0 and 2 are empty, so the middle must be a vertical
+    EXPECT_EQ(pre.domains().at(Point{0, 1}), EmptyDomain);
+    EXPECT_EQ(pre.domains().at(Point{2, 1}), EmptyDomain);
+    EXPECT_EQ(pre.Commit(), 1);
+    EXPECT_EQ(g.at(Point{1, 1}), Piece::Vertical);
+    EXPECT_TRUE(g.isComplete());
+
+    // Nothing new the second time around
+    EXPECT_TRUE(pre.Propagate());
+    EXPECT_EQ(pre.Commit(), 0);
+}
+
+TEST(PresolverTest, DetectsContradiction) {
+    const auto p = makeSimpleUnsolvablePuzzle();
+    Grid g(p);
+    Presolver pre(g);
+    EXPECT_FALSE(pre.Propagate());
+}
+
+TEST(PresolverTest, DomainsNarrowSearch) {
+    const auto p = makeSimplePuzzle5x5();
+    Grid plain(p);
+    PathSolver ps;
+    EXPECT_TRUE(ps.Solve(plain));
+
+    Grid g(p);
+    Presolver pre(g);
+    EXPECT_TRUE(pre.Propagate());
+    pre.Commit();
+
+    PathSolver narrowed;
+    narrowed.Domains(&pre.domains());
+    EXPECT_TRUE(narrowed.Solve(g));
+    EXPECT_EQ(g.toString(), plain.toString());
+    EXPECT_LE(narrowed.Steps(), ps.Steps());
+
+    Grid s(p);
+    SegmentSolver ss;
+    ss.Domains(&pre.domains());
+    EXPECT_TRUE(ss.Solve(s));
+    EXPECT_EQ(s.toString(), plain.toString());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,165 @@
+// Unit tests for the Profiler zones
+#include <gtest/gtest.h>
+#include "Profiler.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+
+#include <sstream>
+#include <thread>
+
+using namespace TrainTracks;
+
+static const ProfileZoneStats* find(const std::vector<ProfileZoneStats>& stats, const std::string& path) {
+    for (const auto& s : stats) {
+        if (s.path == path) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+static size_t count(const std::string& s, const std::string& what) {
+    size_t n = 0;
+    for (auto pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+class ProfilerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Profiler::Reset();
+        Profiler::Enable();
+    }
+
+    void TearDown() override {
+        Profiler::Enable(false);
+        Profiler::Reset();
+    }
+};
+
+TEST_F(ProfilerTest, DisabledRecordsNothing) {
+    Profiler::Enable(false);
+    {
+        PROFILE_ZONE("outer");
+        PROFILE_ZONE("inner");
+    }
+    EXPECT_TRUE(Profiler::Stats().empty());
+}
+
+TEST_F(ProfilerTest, NestedZonesAggregateByPath) {
+    for (int i = 0; i < 3; i++) {
+        PROFILE_ZONE("outer");
+        for (int j = 0; j < 2; j++) {
+            PROFILE_ZONE("inner");
+        }
+    }
+    {
+        PROFILE_ZONE("inner");
+    }
+
+    const auto stats = Profiler::Stats();
+    ASSERT_EQ(stats.size(), 3u);
+    // Parents before their children
+    EXPECT_EQ(stats[0].path, "inner");
+    EXPECT_EQ(stats[1].path, "outer");
+    EXPECT_EQ(stats[2].path, "outer/inner");
+    EXPECT_EQ(stats[2].name, "inner");
+    EXPECT_EQ(stats[2].depth, 1);
+
+    EXPECT_EQ(stats[0].count, 1u);
+    EXPECT_EQ(stats[1].count, 3u);
+    EXPECT_EQ(stats[2].count, 6u);
+    for (const auto& s : stats) {
+        EXPECT_LE(s.min, s.avg());
+        EXPECT_LE(s.avg(), s.max);
+        EXPECT_LE(s.p99, s.max);
+        EXPECT_GE(s.p99, s.min);
+    }
+    EXPECT_GE(stats[1].total, stats[2].total);
+}
+
+TEST_F(ProfilerTest, P99FindsTheSlowZones) {
+    for (int i = 0; i < 98; i++) {
+        PROFILE_ZONE("zone");
+    }
+    for (int i = 0; i < 2; i++) {
+        PROFILE_ZONE("zone");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    const auto stats = Profiler::Stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].count, 100u);
+    EXPECT_GE(stats[0].p99, 2000000u * 7 / 8);
+    EXPECT_LT(stats[0].min, 1000000u);
+}
+
+TEST_F(ProfilerTest, MergesThreads) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([] {
+            for (int i = 0; i < 10; i++) {
+                PROFILE_ZONE("work");
+                PROFILE_ZONE("step");
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const auto stats = Profiler::Stats();
+    ASSERT_NE(find(stats, "work"), nullptr);
+    ASSERT_NE(find(stats, "work/step"), nullptr);
+    EXPECT_EQ(find(stats, "work")->count, 40u);
+    EXPECT_EQ(find(stats, "work/step")->count, 40u);
+}
+
+TEST_F(ProfilerTest, WritesChromeTrace) {
+    {
+        PROFILE_ZONE("outer");
+        PROFILE_ZONE("inner");
+    }
+    std::ostringstream out;
+    Profiler::WriteChromeTrace(out);
+    const auto json = out.str();
+
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(count(json, "\"ph\":\"X\""), 2u);
+    EXPECT_EQ(count(json, "\"name\":\"outer\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"inner\""), 1u);
+    EXPECT_NE(json.find("]}"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, TimesSolveStages) {
+    Puzzle p;
+    p.data.rowConstraints = {1, 1, 1};
+    p.data.colConstraints = {0, 3, 0};
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
+    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
+
+    Grid grid(Puzzle::fromJson(p.toJson()));
+    PathSolver solver;
+    ASSERT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+
+    const auto stats = Profiler::Stats();
+    EXPECT_NE(find(stats, "load"), nullptr);
+    EXPECT_NE(find(stats, "placeObviousPieces"), nullptr);
+    EXPECT_NE(find(stats, "search"), nullptr);
+    EXPECT_NE(find(stats, "search/verify"), nullptr);
+
+    std::ostringstream table;
+    Profiler::Print(table);
+    EXPECT_NE(table.str().find("\n  verify "), std::string::npos);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
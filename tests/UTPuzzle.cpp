@@ -1,5 +1,6 @@
 // Expanded unit tests for the Puzzle class
 #include <gtest/gtest.h>
+#include <sstream>
 #include <fstream>
 #include <cstdio>
 #include "Puzzle.h"
@@ -82,13 +83,45 @@ TEST(PuzzleTest, LoadFromFileValid) {
     Puzzle p = Puzzle::loadFromFile(filename);
     EXPECT_EQ(p.data.rowConstraints, std::vector<int>({10, 20, 30}));
     EXPECT_EQ(p.data.colConstraints, std::vector<int>({1, 2}));
-    EXPECT_EQ(p.gridWidth, 3);
-    EXPECT_EQ(p.gridHeight, 2);
+    EXPECT_EQ(p.gridWidth, 2);
+    EXPECT_EQ(p.gridHeight, 3);
     EXPECT_EQ(p.data.startingGrid.size(), 6);
 
     std::remove(filename.c_str());
 }
 
+TEST(PuzzleTest, LoadFromFileRectangularFixed) {
+    const std::string filename = "rectPuzzle.txt";
+    std::ofstream ofs(filename);
+    ofs << "ROWS: 1 1 1\n";
+    ofs << "COLS: 0 3\n";
+    ofs << "FIXED:\n";
+    ofs << "1,0: Vertical\n";
+    ofs << "1,2: Vertical\n";
+    ofs.close();
+
+    Puzzle p = Puzzle::loadFromFile(filename);
+    EXPECT_EQ(p.gridWidth, 2);
+    EXPECT_EQ(p.gridHeight, 3);
+    EXPECT_EQ(p.data.startingGrid[1], Piece::Vertical);
+    EXPECT_EQ(p.data.startingGrid[5], Piece::Vertical);
+
+    std::remove(filename.c_str());
+}
+
+TEST(PuzzleTest, LoadFromFileFixedOutsideGrid) {
+    const std::string filename = "outsidePuzzle.txt";
+    std::ofstream ofs(filename);
+    ofs << "ROWS: 1 1 1\n";
+    ofs << "COLS: 0 3\n";
+    ofs << "FIXED:\n";
+    ofs << "2,0: Vertical\n";
+    ofs.close();
+
+    EXPECT_THROW(Puzzle::loadFromFile(filename), std::runtime_error);
+    std::remove(filename.c_str());
+}
+
 TEST(PuzzleTest, LoadFromFileMissingRows) {
     const std::string filename = "noRows.txt";
     std::ofstream ofs(filename);
@@ -115,6 +148,56 @@ TEST(PuzzleTest, LoadFromFileNonexistent) {
     EXPECT_THROW(Puzzle::loadFromFile("nonexistent_file.txt"), std::runtime_error);
 }
 
+TEST(PuzzleTest, LoadFromStream) {
+    std::istringstream is("ROWS: 1 1 1\nCOLS: 0 3 0\nFIXED:\n1,0: Vertical\n1,2: Vertical\n");
+    const auto p = Puzzle::load(is);
+    EXPECT_EQ(p.gridWidth, 3);
+    EXPECT_EQ(p.gridHeight, 3);
+    EXPECT_EQ(p.data.startingGrid[1], Piece::Vertical);
+    EXPECT_EQ(p.data.startingGrid[7], Piece::Vertical);
+
+    std::istringstream empty("");
+    EXPECT_THROW(Puzzle::load(empty), std::runtime_error);
+}
+
+TEST(PuzzleTest, JsonRoundTrip) {
+    Puzzle p;
+    p.gridWidth = 3;
+    p.gridHeight = 2;
+    p.data.rowConstraints = {2, 1};
+    p.data.colConstraints = {1, 1, 1};
+    p.data.startingGrid = {
+        Piece::Horizontal, Piece::CornerSW, Piece::Empty,
+        Piece::Empty, Piece::Vertical, Piece::Empty };
+
+    const auto json = p.toJson();
+    EXPECT_EQ(json, "{\"rows\":[2,1],\"cols\":[1,1,1],\"startingGrid\":[3,7,0,0,4,0]}");
+
+    const auto q = Puzzle::fromJson(json);
+    EXPECT_EQ(q.gridWidth, 3);
+    EXPECT_EQ(q.gridHeight, 2);
+    EXPECT_EQ(q.data.rowConstraints, p.data.rowConstraints);
+    EXPECT_EQ(q.data.colConstraints, p.data.colConstraints);
+    EXPECT_EQ(q.data.startingGrid, p.data.startingGrid);
+}
+
+TEST(PuzzleTest, FromJsonIgnoresOtherKeys) {
+    const auto p = Puzzle::fromJson(R"({"id": "a,b", "cols": [1, 2], "rows" : [3], "extra": 4})");
+    EXPECT_EQ(p.gridWidth, 2);
+    EXPECT_EQ(p.gridHeight, 1);
+    EXPECT_EQ(p.data.startingGrid.size(), 2);
+    EXPECT_EQ(json_value(R"({"id": "a,b", "n": 12})", "id"), "\"a,b\"");
+    EXPECT_EQ(json_value(R"({"id": "a,b", "n": 12})", "n"), "12");
+    EXPECT_TRUE(json_value(R"({"id": "a,b"})", "missing").empty());
+}
+
+TEST(PuzzleTest, FromJsonInvalid) {
+    EXPECT_THROW(Puzzle::fromJson("{}"), std::runtime_error);
+    EXPECT_THROW(Puzzle::fromJson(R"({"rows":[1],"cols":[]})"), std::runtime_error);
+    EXPECT_THROW(Puzzle::fromJson(R"({"rows":[1],"cols":[1],"startingGrid":[0,0]})"), std::runtime_error);
+    EXPECT_THROW(Puzzle::fromJson(R"({"rows":[1],"cols":[1],"startingGrid":[2]})"), std::runtime_error);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
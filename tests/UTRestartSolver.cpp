@@ -0,0 +1,133 @@
+// Unit tests for the RestartSolver class
+#include <gtest/gtest.h>
+#include <numeric>
+#include "RestartSolver.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+static Puzzle makeGeneratedPuzzle() {
+    GeneratorOptions options;
+    options.width = 10;
+    options.height = 10;
+    options.seed = 5;
+    options.hints = 0.05;
+    return Generator::Generate(options);
+}
+
+TEST(RestartSolverTest, LubySequence) {
+    const std::vector<uint64_t> expected{ 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, 1 };
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(RestartSolver::Luby(i + 1), expected[i]) << "i " << i + 1;
+    }
+    EXPECT_EQ(RestartSolver::Luby(1023), 512u);
+}
+
+TEST(RestartSolverTest, Cutoffs) {
+    RestartOptions options;
+    options.scale = 100;
+    EXPECT_EQ(RestartSolver(options).Cutoff(7), 400u);
+
+    options.schedule = RestartSchedule::Geometric;
+    options.growth = 2.0;
+    const RestartSolver geometric(options);
+    EXPECT_EQ(geometric.Cutoff(1), 100u);
+    EXPECT_EQ(geometric.Cutoff(4), 800u);
+    // Saturates rather than overflowing
+    EXPECT_GT(geometric.Cutoff(200), geometric.Cutoff(50));
+}
+
+TEST(RestartSolverTest, RejectsBadOptions) {
+    RestartOptions options;
+    options.scale = 0;
+    EXPECT_THROW(RestartSolver{options}, std::runtime_error);
+
+    options.scale = 10;
+    options.schedule = RestartSchedule::Geometric;
+    options.growth = 0.5;
+    EXPECT_THROW(RestartSolver{options}, std::runtime_error);
+}
+
+TEST(RestartSolverTest, Solves) {
+    Grid grid(makeSimpleSolvablePuzzle());
+    RestartSolver solver;
+    const auto r = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(r.status, SolveStatus::Solved);
+    EXPECT_TRUE(grid.isComplete());
+    EXPECT_EQ(solver.Stats().attempts, 1u);
+    // The attempt's scratch
+    EXPECT_GT(r.peakBytes, 0u);
+}
+
+TEST(RestartSolverTest, RestartsUntilSolved) {
+    RestartOptions options;
+    options.scale = 16;
+    RestartSolver solver(options);
+
+    Grid grid(makeGeneratedPuzzle());
+    const auto r = solver.Solve(grid, SolveOptions());
+    ASSERT_EQ(r.status, SolveStatus::Solved);
+    EXPECT_TRUE(grid.isComplete());
+
+    const auto& stats = solver.Stats();
+    EXPECT_GT(stats.restarts(), 0u);
+    EXPECT_EQ(stats.attemptSteps.size(), stats.attempts);
+    EXPECT_EQ(std::accumulate(stats.attemptSteps.begin(), stats.attemptSteps.end(), uint64_t(0)), r.steps);
+    // Every attempt but the last used its whole cutoff
+    for (uint64_t i = 0; i + 1 < stats.attempts; i++) {
+        EXPECT_EQ(stats.attemptSteps[i], solver.Cutoff(i + 1));
+    }
+}
+
+TEST(RestartSolverTest, DeterministicForSeed) {
+    RestartOptions options;
+    options.scale = 16;
+    options.seed = 99;
+
+    RestartSolver a(options), b(options);
+    Grid ga(makeGeneratedPuzzle()), gb(makeGeneratedPuzzle());
+    const auto ra = a.Solve(ga, SolveOptions());
+    const auto rb = b.Solve(gb, SolveOptions());
+    EXPECT_EQ(ra.steps, rb.steps);
+    EXPECT_EQ(a.Stats().attemptSteps, b.Stats().attemptSteps);
+    EXPECT_EQ(a.Stats().lastSeed, b.Stats().lastSeed);
+
+    options.seed = 100;
+    RestartSolver c(options);
+    Grid gc(makeGeneratedPuzzle());
+    c.Solve(gc, SolveOptions());
+    EXPECT_NE(a.Stats().lastSeed, c.Stats().lastSeed);
+}
+
+TEST(RestartSolverTest, Unsolvable) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    RestartSolver solver;
+    const auto r = solver.Solve(grid, SolveOptions());
+    EXPECT_EQ(r.status, SolveStatus::Unsolvable);
+}
+
+TEST(RestartSolverTest, StepBudgetSpansAttempts) {
+    RestartOptions options;
+    options.scale = 4;
+    RestartSolver solver(options);
+
+    Grid grid(makeGeneratedPuzzle());
+    const auto before = grid.placed();
+    SolveOptions limits;
+    limits.maxSteps = 50;
+    const auto r = solver.Solve(grid, limits);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(r.steps, 50u);
+    EXPECT_GT(solver.Stats().attempts, 1u);
+    EXPECT_EQ(grid.placed(), before);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
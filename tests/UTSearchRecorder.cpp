@@ -0,0 +1,207 @@
+// Unit tests for the SearchLog recorder and SearchReplay
+#include <gtest/gtest.h>
+#include "SearchRecorder.h"
+#include "FrontierSolver.h"
+#include "PathSolver.h"
+#include "PortfolioSolver.h"
+#include "RestartSolver.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+#include <sstream>
+
+using namespace TrainTracks;
+
+static int trackLength(const Puzzle& p) {
+    int total = 0;
+    for (const auto c : p.data.rowConstraints) {
+        total += c;
+    }
+    return total;
+}
+
+// Solves with a recorder attached and replays the recording
+static SearchReplay record(Solver& solver, const Puzzle& puzzle, SolveResult& result, size_t top = 10,
+        const SolveOptions& options = SolveOptions()) {
+    Grid grid(puzzle);
+    std::stringstream file;
+    {
+        SearchLog log(file, grid);
+        solver.Recorder(&log);
+        result = solver.Solve(grid, options);
+        solver.Recorder(nullptr);
+    }
+    return SearchReplay(file, top);
+}
+
+TEST(SearchRecorder, ReplaysASolvedPathSearch) {
+    const auto puzzle = makeHardPuzzle();
+    PathSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, puzzle, result);
+    ASSERT_TRUE(result.solved());
+
+    EXPECT_TRUE(replay.Solved());
+    // Only steps off the grid go unrecorded
+    EXPECT_LE(replay.Visits(), result.steps);
+    EXPECT_GT(replay.Visits(), result.steps / 2);
+    // Every try failed bar those on the solution path, up to the exit
+    EXPECT_EQ(replay.Tries() - replay.Fails(), static_cast<uint64_t>(trackLength(puzzle) - 1));
+    EXPECT_EQ(replay.MaxDepth(), trackLength(puzzle) - 1);
+    EXPECT_EQ(replay.Prunes(), solver.Stats().cuts + solver.Stats().nogoodHits);
+
+    uint64_t visits = 0, backtracks = 0, prunes = 0;
+    for (int y = 0; y < replay.height(); y++) {
+        for (int x = 0; x < replay.width(); x++) {
+            visits += replay.Visits(Point{x, y});
+            backtracks += replay.Backtracks(Point{x, y});
+            prunes += replay.Prunes(Point{x, y});
+        }
+    }
+    EXPECT_EQ(visits, replay.Visits());
+    EXPECT_EQ(backtracks, replay.Fails());
+    EXPECT_EQ(prunes, replay.Prunes());
+}
+
+TEST(SearchRecorder, KeepsTheLargestFailedSubtrees) {
+    PathSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, makeHardPuzzle(), result, 5);
+
+    const auto& failed = replay.LargestFailures();
+    ASSERT_EQ(failed.size(), 5u);
+    for (size_t i = 1; i < failed.size(); i++) {
+        EXPECT_GE(failed[i - 1].visits, failed[i].visits);
+    }
+    EXPECT_LE(failed.front().visits, replay.Visits());
+    EXPECT_GE(failed.front().height, 1);
+    EXPECT_NE(failed.front().piece, Piece::Empty);
+}
+
+TEST(SearchRecorder, UnsolvableSearchUnwindsCompletely) {
+    PathSolverOptions options;
+    options.cuts = false;
+    PathSolver solver(options);
+    SolveResult result;
+    const auto replay = record(solver, makeSimpleUnsolvablePuzzle(), result);
+    ASSERT_EQ(result.status, SolveStatus::Unsolvable);
+
+    EXPECT_FALSE(replay.Solved());
+    EXPECT_EQ(replay.Tries(), replay.Fails());
+    EXPECT_GT(replay.Tries(), 0u);
+}
+
+TEST(SearchRecorder, RecordsSegmentSolver) {
+    const auto puzzle = makeHardPuzzle();
+    SegmentSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, puzzle, result);
+    ASSERT_TRUE(result.solved());
+
+    // Including those the grid places itself
+    const Grid start(puzzle);
+    int fixed = 0;
+    for (int y = 0; y < start.height(); y++) {
+        for (int x = 0; x < start.width(); x++) {
+            fixed += start.isFilled(Point{x, y});
+        }
+    }
+    EXPECT_TRUE(replay.Solved());
+    EXPECT_EQ(replay.Visits(), result.steps);
+    EXPECT_EQ(replay.Tries() - replay.Fails(), static_cast<uint64_t>(trackLength(puzzle) - fixed));
+}
+
+TEST(SearchRecorder, RecordsEveryRestartAttempt) {
+    RestartOptions options;
+    options.scale = 1;
+    RestartSolver solver(options);
+    SolveResult result;
+    const auto replay = record(solver, makeSimpleSolvablePuzzle(), result);
+    ASSERT_TRUE(result.solved());
+    ASSERT_GT(solver.Stats().restarts(), 0u);
+
+    EXPECT_TRUE(replay.Solved());
+    EXPECT_EQ(replay.Tries() - replay.Fails(), static_cast<uint64_t>(trackLength(makeSimpleSolvablePuzzle()) - 1));
+}
+
+TEST(SearchRecorder, RecordsHowTheSolveEnded) {
+    PathSolver solver;
+    SolveResult result;
+    SolveOptions options;
+    options.maxSteps = 1000;
+    const auto replay = record(solver, makeHardPuzzle(), result, 10, options);
+    ASSERT_EQ(result.status, SolveStatus::TimedOut);
+    EXPECT_EQ(replay.Status(), SolveStatus::TimedOut);
+    EXPECT_FALSE(replay.Solved());
+
+    std::ostringstream out;
+    replay.Print(out);
+    EXPECT_NE(out.str().find(", not solved (TimedOut)"), std::string::npos);
+
+    // Cut short before the solve finished
+    Grid grid(makeSimpleSolvablePuzzle());
+    std::stringstream file;
+    {
+        SearchLog log(file, grid);
+        log.Try(Point{1, 1}, Piece::Vertical);
+    }
+    EXPECT_FALSE(SearchReplay(file).Status().has_value());
+}
+
+// Through the entry searching the caller's grid
+TEST(SearchRecorder, RecordsPortfolioSolver) {
+    PortfolioSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, makeSimpleSolvablePuzzle(), result);
+    ASSERT_TRUE(result.solved());
+    EXPECT_TRUE(replay.Solved());
+    EXPECT_GT(replay.Visits(), 0u);
+}
+
+TEST(SearchRecorder, RecordsFrontierSolver) {
+    const auto puzzle = makeHardPuzzle();
+    FrontierSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, puzzle, result);
+    ASSERT_TRUE(result.solved());
+    EXPECT_TRUE(replay.Solved());
+    EXPECT_GT(replay.Visits(), 0u);
+    EXPECT_EQ(replay.Fails(), 0u);
+
+    const Grid start(puzzle);
+    int fixed = 0;
+    for (int y = 0; y < start.height(); y++) {
+        for (int x = 0; x < start.width(); x++) {
+            fixed += start.isFilled(Point{x, y});
+        }
+    }
+    EXPECT_EQ(replay.Tries(), static_cast<uint64_t>(trackLength(puzzle) - fixed));
+}
+
+TEST(SearchRecorder, PrintsHeatmaps) {
+    PathSolver solver;
+    SolveResult result;
+    const auto replay = record(solver, makeSimpleSolvablePuzzle(), result);
+
+    std::ostringstream out;
+    replay.Print(out);
+    const auto text = out.str();
+    EXPECT_NE(text.find("Visits ("), std::string::npos);
+    EXPECT_NE(text.find("Backtracks ("), std::string::npos);
+    EXPECT_NE(text.find("Prunes ("), std::string::npos);
+    EXPECT_NE(text.find(", solved"), std::string::npos);
+}
+
+TEST(SearchRecorder, RejectsOtherFiles) {
+    std::istringstream in("not a search log");
+    EXPECT_THROW(SearchReplay replay(in), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,128 @@
+// Unit tests for the SegmentSolver class
+#include <gtest/gtest.h>
+#include <sstream>
+#include "SegmentSolver.h"
+#include "PathSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+/*
+  -+...
+  .|...
+  .+-+.
+  ...++
+  ....+
+*/
+
+TEST(SegmentSolverTest, SolvesSimplePuzzle) {
+    const auto p = makeSimpleSolvablePuzzle();
+    Grid g(p);
+
+    SegmentSolver ss;
+    EXPECT_TRUE(ss.Solve(g));
+    EXPECT_TRUE(g.isComplete());
+    // Only the middle cell needs to be searched
+    EXPECT_EQ(ss.Steps(), 1);
+}
+
+TEST(SegmentSolverTest, DoesntSolveSimplePuzzle) {
+    const auto p = makeSimpleUnsolvablePuzzle();
+    Grid g(p);
+
+    SegmentSolver ss;
+    EXPECT_FALSE(ss.Solve(g));
+    EXPECT_EQ(ss.Steps(), 0);
+    // Nothing is left behind
+    EXPECT_EQ(g.placed(), 2);
+}
+
+TEST(SegmentSolverTest, RejectsClosedLoop) {
+    // A 2x2 loop of fixed corners can never join the path
+    Puzzle p;
+    p.data.rowConstraints = {1, 3, 3, 1};
+    p.data.colConstraints = {0, 4, 2, 2};
+    p.gridWidth = 4;
+    p.gridHeight = 4;
+    p.data.startingGrid.assign(16, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(4)] = Piece::Vertical;
+    p.data.startingGrid[Point{1, 3}.project(4)] = Piece::Vertical;
+    p.data.startingGrid[Point{2, 1}.project(4)] = Piece::CornerSE;
+    p.data.startingGrid[Point{3, 1}.project(4)] = Piece::CornerSW;
+    p.data.startingGrid[Point{2, 2}.project(4)] = Piece::CornerNE;
+    p.data.startingGrid[Point{3, 2}.project(4)] = Piece::CornerNW;
+    Grid g(p);
+
+    SegmentSolver ss;
+    EXPECT_FALSE(ss.Solve(g));
+    EXPECT_EQ(ss.Steps(), 0);
+}
+
+TEST(SegmentSolverTest, SolvesLargerPuzzle) {
+    const auto p = makeLargerSolvablePuzzle();
+    Grid g(p);
+
+    SegmentSolver ss;
+    EXPECT_TRUE(ss.Solve(g));
+    EXPECT_TRUE(g.isComplete());
+}
+
+TEST(SegmentSolverTest, JoinsObviousPieces) {
+    const auto p = makeSimplePuzzle5x5();
+    Grid g(p);
+    const auto preplaced = g.placed();
+
+    SegmentSolver ss;
+    EXPECT_TRUE(ss.Solve(g));
+    EXPECT_TRUE(g.isComplete());
+    // Never needs more steps than there are empty cells on the path
+    EXPECT_LE(ss.Steps(), static_cast<uint64_t>(g.placed() - preplaced));
+}
+
+TEST(SegmentSolverTest, MatchesPathSolver) {
+    const auto p = makeSimplePuzzle5x5();
+    Grid a(p);
+    Grid b(p);
+
+    PathSolver ps;
+    SegmentSolver ss;
+    EXPECT_TRUE(ps.Solve(a));
+    EXPECT_TRUE(ss.Solve(b));
+    EXPECT_EQ(a.toString(), b.toString());
+    EXPECT_LE(ss.Steps(), ps.Steps());
+}
+
+TEST(SegmentSolverTest, LargeJsonPuzzle) {
+    const auto p = makeHardPuzzle();
+
+    Grid g(p);
+    SegmentSolver ss;
+    EXPECT_TRUE(ss.Solve(g));
+    EXPECT_TRUE(g.isComplete());
+    // PathSolver needs tens of thousands of steps for this one
+    EXPECT_LT(ss.Steps(), 1000);
+
+    const std::string solution = R"( ┌───┘      
+ │          
+┌┘          
+│    ┌┐     
+└┐   │└────┐
+ │   │    ┌┘
+ │   │ ┌──┘ 
+ │┌──┘┌┘    
+ └┘   │ ┌──┐
+┌─────┘┌┘  │
+└───┐  │   └
+    └──┘    
+)";
+    EXPECT_EQ(g.toString(), solution);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,155 @@
+// Unit tests for splitting a PathSolver search into shards
+#include <gtest/gtest.h>
+#include "Shard.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+
+using namespace TrainTracks;
+
+static Puzzle makeSimpleUnsolvablePuzzle() {
+    Puzzle p;
+    p.data.rowConstraints = {1, 1, 1};
+    p.data.colConstraints = {0, 3, 0};
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
+    p.data.startingGrid[Point{2, 2}.project(3)] = Piece::Horizontal;
+    return p;
+}
+
+static Puzzle generate(int size, uint64_t seed) {
+    GeneratorOptions options;
+    options.width = size;
+    options.height = size;
+    options.seed = seed;
+    options.hints = 0;
+    return Generator::Generate(options);
+}
+
+static std::vector<Piece> cells(const Grid& grid) {
+    SolveResult r;
+    TakeSolution(grid, r);
+    return r.solution;
+}
+
+// The first shard to solve, in shard order, finds what the whole search does
+TEST(Shard, ShardsFindTheSameSolution) {
+    for (uint64_t seed = 1; seed <= 10; seed++) {
+        const auto puzzle = generate(8, seed);
+        Grid whole(puzzle);
+        PathSolver solver;
+        const auto expected = solver.Solve(whole, SolveOptions());
+        ASSERT_TRUE(expected.solved());
+
+        Grid grid(puzzle);
+        const auto split = SplitIntoShards(grid, 6);
+        ASSERT_EQ(split.result.status, SolveStatus::Unsolvable);
+        ASSERT_FALSE(split.shards.empty());
+        EXPECT_EQ(cells(grid), cells(Grid(puzzle)));
+
+        bool found = false;
+        for (const auto& shard : split.shards) {
+            const auto r = SolveShard(shard);
+            if (r.solved()) {
+                EXPECT_EQ(r.solution, cells(whole)) << "seed " << seed << " shard " << shard.index;
+                found = true;
+                break;
+            }
+        }
+        EXPECT_TRUE(found) << "seed " << seed;
+    }
+}
+
+TEST(Shard, UnsolvableShards) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    const auto split = SplitIntoShards(grid, 2);
+    EXPECT_FALSE(split.result.solved());
+    for (const auto& shard : split.shards) {
+        EXPECT_EQ(SolveShard(shard).status, SolveStatus::Unsolvable);
+    }
+}
+
+TEST(Shard, SplitBeyondThePathSolves) {
+    const auto puzzle = generate(5, 3);
+    Grid grid(puzzle);
+    const auto split = SplitIntoShards(grid, static_cast<int>(grid.cells()) + 1);
+    EXPECT_TRUE(split.result.solved());
+    EXPECT_TRUE(split.shards.empty());
+    EXPECT_EQ(split.result.solution.size(), grid.cells());
+    EXPECT_TRUE(grid.isComplete());
+}
+
+TEST(Shard, RoundTripsThroughJson) {
+    Grid grid(generate(7, 4));
+    const auto split = SplitIntoShards(grid, 4);
+    ASSERT_FALSE(split.shards.empty());
+    for (const auto& shard : split.shards) {
+        const auto line = shard.toJson();
+        EXPECT_EQ(line.find('\n'), std::string::npos);
+        const auto back = Shard::fromJson(line);
+        EXPECT_EQ(back.index, shard.index);
+        EXPECT_EQ(back.fromExit, shard.fromExit);
+        EXPECT_EQ(back.prefix.path, shard.prefix.path);
+        EXPECT_EQ(back.prefix.steps, shard.prefix.steps);
+        EXPECT_EQ(back.puzzle.toJson(), shard.puzzle.toJson());
+        EXPECT_EQ(SolveShard(back).status, SolveShard(shard).status);
+    }
+}
+
+TEST(Shard, SplitsFromTheExit) {
+    const auto puzzle = generate(6, 5);
+    PathSolverOptions config;
+    config.fromExit = true;
+    Grid grid(puzzle);
+    const auto split = SplitIntoShards(grid, 3, config);
+    ASSERT_FALSE(split.shards.empty());
+    EXPECT_EQ(split.shards.front().prefix.path.front().first, grid.exit());
+
+    bool found = false;
+    for (const auto& shard : split.shards) {
+        EXPECT_TRUE(Shard::fromJson(shard.toJson()).fromExit);
+        found = found || SolveShard(shard).solved();
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(Shard, ResumeRejectsABrokenPrefix) {
+    Grid grid(generate(6, 6));
+    const auto split = SplitIntoShards(grid, 4);
+    ASSERT_FALSE(split.shards.empty());
+
+    auto prefix = split.shards.front().prefix;
+    std::swap(prefix.path[1], prefix.path[2]);
+    const auto before = cells(grid);
+    PathSolver solver;
+    EXPECT_THROW(solver.Resume(grid, prefix), std::runtime_error);
+    EXPECT_EQ(cells(grid), before);
+
+    // Still usable afterwards
+    EXPECT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+}
+
+TEST(Shard, ResumeLeavesTheGridIfUnsolved) {
+    Grid grid(makeSimpleUnsolvablePuzzle());
+    const auto before = cells(grid);
+    PathPrefix prefix;
+    prefix.path.emplace_back(grid.entry(), grid.at(grid.entry()));
+    PathSolver solver;
+    EXPECT_EQ(solver.Resume(grid, prefix).status, SolveStatus::Unsolvable);
+    EXPECT_EQ(cells(grid), before);
+}
+
+TEST(Shard, RejectsBadShards) {
+    EXPECT_THROW(Shard::fromJson("{\"rows\":[1],\"cols\":[1],\"path\":[]}"), std::runtime_error);
+    EXPECT_THROW(Shard::fromJson("{\"shard\":0,\"rows\":[1],\"cols\":[1]}"), std::runtime_error);
+    EXPECT_THROW(Shard::fromJson("{\"shard\":0,\"rows\":[1],\"cols\":[1],\"path\":[0,0]}"), std::runtime_error);
+    EXPECT_THROW(Shard::fromJson("{\"shard\":0,\"rows\":[1],\"cols\":[1],\"path\":[0,0,9]}"), std::runtime_error);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
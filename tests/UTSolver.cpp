@@ -0,0 +1,144 @@
+// Unit tests for the Solver options, deadlines and cancellation
+#include <gtest/gtest.h>
+#include <thread>
+#include "PathSolver.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+using namespace TrainTracks;
+
+TEST(SolverTest, StatusNames) {
+    EXPECT_STREQ(SolveStatusName(SolveStatus::Solved), "Solved");
+    EXPECT_STREQ(SolveStatusName(SolveStatus::Unsolvable), "Unsolvable");
+    EXPECT_STREQ(SolveStatusName(SolveStatus::TimedOut), "TimedOut");
+    EXPECT_STREQ(SolveStatusName(SolveStatus::Cancelled), "Cancelled");
+}
+
+TEST(SolverTest, SolvedAndUnsolvable) {
+    {
+        Grid g(makeSimpleSolvablePuzzle());
+        PathSolver ps;
+        const auto r = ps.Solve(g, SolveOptions());
+        EXPECT_EQ(r.status, SolveStatus::Solved);
+        EXPECT_TRUE(r.solved());
+        EXPECT_EQ(r.steps, 3);
+        EXPECT_TRUE(g.isComplete());
+    }
+    {
+        Grid g(makeSimpleUnsolvablePuzzle());
+        PathSolver ps;
+        const auto r = ps.Solve(g, SolveOptions());
+        EXPECT_EQ(r.status, SolveStatus::Unsolvable);
+        EXPECT_EQ(r.steps, 1);
+    }
+}
+
+TEST(SolverTest, StepBudgetRestoresGrid) {
+    Grid g(makeHardPuzzle());
+    const auto before = g.toString();
+    const auto placed = g.placed();
+
+    SolveOptions options;
+    options.maxSteps = 5000;
+
+    PathSolver ps;
+    const auto r = ps.Solve(g, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(r.steps, 5000);
+    EXPECT_EQ(g.toString(), before);
+    EXPECT_EQ(g.placed(), placed);
+
+    // The budget is per solve
+    const auto again = ps.Solve(g, options);
+    EXPECT_EQ(again.status, SolveStatus::TimedOut);
+    EXPECT_EQ(again.steps, 5000);
+    EXPECT_EQ(ps.Steps(), 10000);
+}
+
+TEST(SolverTest, DeadlineInThePast) {
+    Grid g(makeHardPuzzle());
+    SolveOptions options;
+    options.deadline = SolveClock::now() - std::chrono::seconds(1);
+
+    PathSolver ps;
+    const auto r = ps.Solve(g, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(r.steps, 0);
+}
+
+TEST(SolverTest, DeadlineStopsSearch) {
+    Grid g(makeHardPuzzle());
+    const auto before = g.toString();
+    SolveOptions options;
+    options.deadline = SolveClock::now() + std::chrono::milliseconds(20);
+
+    PathSolver ps;
+    const auto r = ps.Solve(g, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_LT(r.elapsed, std::chrono::seconds(1));
+    EXPECT_EQ(g.toString(), before);
+}
+
+TEST(SolverTest, TimeoutStartsWithSolve) {
+    Grid g(makeHardPuzzle());
+    SolveOptions options;
+    options.timeout = std::chrono::milliseconds(20);
+
+    PathSolver ps;
+    const auto r = ps.Solve(g, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_GE(r.elapsed, std::chrono::milliseconds(20));
+    EXPECT_LT(r.elapsed, std::chrono::seconds(1));
+
+    // The earlier of the two wins
+    options.deadline = SolveClock::now() - std::chrono::seconds(1);
+    options.timeout = std::chrono::seconds(10);
+    const auto past = ps.Solve(g, options);
+    EXPECT_EQ(past.status, SolveStatus::TimedOut);
+    EXPECT_EQ(past.steps, 0);
+}
+
+TEST(SolverTest, CancelledFromAnotherThread) {
+    Grid g(makeHardPuzzle());
+    const auto before = g.toString();
+    std::atomic<bool> cancel{false};
+    SolveOptions options;
+    options.cancel = &cancel;
+
+    std::thread canceller([&cancel] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        cancel = true;
+    });
+
+    PathSolver ps;
+    const auto r = ps.Solve(g, options);
+    canceller.join();
+    EXPECT_EQ(r.status, SolveStatus::Cancelled);
+    EXPECT_EQ(g.toString(), before);
+}
+
+TEST(SolverTest, SegmentSolverHonoursBudget) {
+    Grid g(makeHardPuzzle());
+    const auto before = g.toString();
+    SolveOptions options;
+    options.maxSteps = 10;
+
+    SegmentSolver ss;
+    const auto r = ss.Solve(g, options);
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_EQ(r.steps, 10);
+    EXPECT_EQ(g.toString(), before);
+
+    // Without the budget it gets there
+    EXPECT_TRUE(ss.Solve(g, SolveOptions()).solved());
+    EXPECT_TRUE(g.isComplete());
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,152 @@
+// Unit tests for the SolverPool class
+#include <gtest/gtest.h>
+#include "SolverPool.h"
+#include "SegmentSolver.h"
+#include "Grid.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+#include "TestPuzzles.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace TrainTracks;
+
+TEST(BoundedQueueTest, PushPopAndClose) {
+    BoundedQueue<int> q(2);
+    EXPECT_EQ(q.Capacity(), 2);
+    EXPECT_TRUE(q.Push(1));
+    EXPECT_TRUE(q.TryPush(2));
+    EXPECT_FALSE(q.TryPush(3));
+    EXPECT_EQ(q.Size(), 2);
+
+    int v = 0;
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(v, 1);
+    EXPECT_TRUE(q.TryPush(3));
+
+    q.Close();
+    EXPECT_FALSE(q.Push(4));
+    // Queued items drain after closing
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(v, 2);
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(v, 3);
+    EXPECT_FALSE(q.Pop(v));
+}
+
+TEST(SolverPoolTest, SolvesSubmittedPuzzles) {
+    SolverPoolOptions options;
+    options.workers = 4;
+    SolverPool pool(options);
+    EXPECT_EQ(pool.Workers(), 4);
+
+    std::vector<std::future<SolveResult>> futures;
+    for (int i = 0; i < 16; i++) {
+        futures.push_back(pool.Submit(i % 2 ? makeSimpleUnsolvablePuzzle() : makeSimpleSolvablePuzzle()));
+    }
+
+    for (size_t i = 0; i < futures.size(); i++) {
+        const auto r = futures[i].get();
+        if (i % 2) {
+            EXPECT_EQ(r.status, SolveStatus::Unsolvable);
+            EXPECT_TRUE(r.solution.empty());
+        } else {
+            EXPECT_EQ(r.status, SolveStatus::Solved);
+            ASSERT_EQ(r.solution.size(), 9u);
+            EXPECT_EQ(r.solution[4], Piece::Vertical);
+        }
+    }
+
+    const auto stats = pool.Stats();
+    EXPECT_EQ(stats.submitted, 16);
+    EXPECT_EQ(stats.completed, 16);
+    EXPECT_EQ(stats.rejected, 0);
+    EXPECT_EQ(stats.queueDepth, 0);
+    EXPECT_LE(stats.maxQueueDepth, 64u);
+    EXPECT_GE(stats.totalSolve, stats.maxSolve);
+}
+
+TEST(SolverPoolTest, InvalidPuzzleThrowsFromFuture) {
+    SolverPool pool;
+    Puzzle p;
+    p.data.rowConstraints = {0, 0};
+    p.data.colConstraints = {0, 0};
+    p.gridWidth = 2;
+    p.gridHeight = 2;
+    p.data.startingGrid.assign(4, Piece::Empty);
+
+    auto f = pool.Submit(p);
+    EXPECT_THROW(f.get(), std::runtime_error);
+}
+
+TEST(SolverPoolTest, TaskTimeout) {
+    SolverPoolOptions options;
+    options.workers = 1;
+    options.taskTimeout = std::chrono::milliseconds(20);
+    SolverPool pool(options);
+
+    const auto r = pool.Submit(makeHardPuzzle()).get();
+    EXPECT_EQ(r.status, SolveStatus::TimedOut);
+    EXPECT_LT(r.elapsed, std::chrono::seconds(1));
+}
+
+TEST(SolverPoolTest, RejectsWhenFull) {
+    SolverPoolOptions options;
+    options.workers = 1;
+    options.queueCapacity = 1;
+    std::future<SolveResult> running;
+    std::future<SolveResult> queued;
+    {
+        SolverPool pool(options);
+        running = pool.Submit(makeHardPuzzle());
+        queued = pool.Submit(makeHardPuzzle());
+
+        // One solving and one waiting, so there is no room left
+        EXPECT_FALSE(pool.TrySubmit(makeSimpleSolvablePuzzle()).has_value());
+        EXPECT_EQ(pool.Stats().rejected, 1);
+    }
+
+    // Shutting the pool down cancels the rest
+    EXPECT_EQ(running.get().status, SolveStatus::Cancelled);
+    EXPECT_EQ(queued.get().status, SolveStatus::Cancelled);
+}
+
+// Tasks with their own token are cancelled by the pool too
+TEST(SolverPoolTest, ShutdownCancelsCallerTokens) {
+    SolverPoolOptions options;
+    options.workers = 1;
+    options.queueCapacity = 1;
+    std::atomic<bool> never(false);
+    SolveOptions solve;
+    solve.cancel = &never;
+    std::future<SolveResult> running;
+    std::future<SolveResult> queued;
+    const auto start = SolveClock::now();
+    {
+        SolverPool pool(options);
+        running = pool.Submit(makeHardPuzzle(), solve);
+        queued = pool.Submit(makeHardPuzzle(), solve);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_LT(SolveClock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(running.get().status, SolveStatus::Cancelled);
+    EXPECT_EQ(queued.get().status, SolveStatus::Cancelled);
+    EXPECT_FALSE(never.load());
+}
+
+TEST(SolverPoolTest, CustomSolver) {
+    SolverPoolOptions options;
+    options.workers = 2;
+    SolverPool pool(options, [] { return std::make_unique<SegmentSolver>(); });
+
+    const auto r = pool.Submit(makeHardPuzzle()).get();
+    EXPECT_EQ(r.status, SolveStatus::Solved);
+    EXPECT_EQ(r.solution.size(), 144u);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
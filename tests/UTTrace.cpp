@@ -0,0 +1,208 @@
+// Unit tests for the Trace ring buffers and decoder
+#include <gtest/gtest.h>
+#include "Trace.h"
+#include "Debug.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "Puzzle.h"
+#include "Piece.h"
+#include "Point.h"
+
+#include <cstdio>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace TrainTracks;
+
+static std::string tracePath() {
+    return "/tmp/UTTrace." + std::to_string(getpid()) + ".trace";
+}
+
+static std::vector<std::string> decode(const std::string& path, TraceStats* stats = nullptr) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    const auto s = Trace::Decode(in, out);
+    if (stats) {
+        *stats = s;
+    }
+    std::remove(path.c_str());
+
+    std::vector<std::string> lines;
+    std::istringstream text(out.str());
+    for (std::string line; std::getline(text, line); ) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+static void traced(const Point& pt, Piece p, int count, bool flag) {
+    TRACE(pt, p, count + 1, flag);
+}
+
+TEST(Trace, DisabledRecordsNothing) {
+    EXPECT_FALSE(Trace::Enabled());
+    traced(Point{1, 2}, Piece::Vertical, 3, true);
+
+    const auto path = tracePath();
+    Trace::Start(path);
+    const auto stats = Trace::Stop();
+    EXPECT_EQ(stats.records, 0u);
+    EXPECT_TRUE(decode(path).empty());
+}
+
+TEST(Trace, DecodesToLogLines) {
+    const auto path = tracePath();
+    Trace::Start(path);
+    traced(Point{1, 2}, Piece::Vertical, 3, true);
+    traced(Point{-1, 0}, Piece::CornerNE, -5, false);
+    const auto stats = Trace::Stop();
+    EXPECT_EQ(stats.records, 2u);
+    EXPECT_EQ(stats.dropped, 0u);
+
+    const auto lines = decode(path);
+    ASSERT_EQ(lines.size(), 2u);
+    const std::regex stamp(R"(^\d\d/\d\d/\d\d \d\d:\d\d:\d\d\.\d{6} )");
+    EXPECT_TRUE(std::regex_search(lines[0], stamp)) << lines[0];
+    EXPECT_EQ(lines[0].substr(25), "traced : pt={1,2} p=│ count + 1=4 flag=1 ");
+    EXPECT_EQ(lines[1].substr(25), "traced : pt={-1,0} p=└ count + 1=-4 flag=0 ");
+}
+
+TEST(Trace, SplitsNamesOnlyAtTopLevelCommas) {
+    const auto path = tracePath();
+    Trace::Start(path);
+    const auto add = [](int a, int b) { return a + b; };
+    TRACE(add(1, 2), std::max(3, 4));
+    Trace::Stop();
+
+    const auto lines = decode(path);
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_NE(lines[0].find(": add(1, 2)=3 std::max(3, 4)=4 "), std::string::npos) << lines[0];
+}
+
+TEST(Trace, MergesThreadsInTimeOrder) {
+    const auto path = tracePath();
+    TraceOptions options;
+    options.flushInterval = std::chrono::milliseconds(1);
+    Trace::Start(path, options);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 1000; i++) {
+                TRACE(t, i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    const auto stats = Trace::Stop();
+    EXPECT_EQ(stats.records, 4000u);
+
+    const auto lines = decode(path);
+    ASSERT_EQ(lines.size(), 4000u);
+    // Each thread's own records stay in order
+    std::vector<int> next(4, 0);
+    for (const auto& line : lines) {
+        int t, i;
+        ASSERT_EQ(std::sscanf(line.c_str() + line.find(": ") + 2, "t=%d i=%d", &t, &i), 2) << line;
+        EXPECT_EQ(i, next[t]++);
+    }
+}
+
+TEST(Trace, FullRingDropsNewRecords) {
+    const auto path = tracePath();
+    TraceOptions options;
+    options.flushInterval = std::chrono::hours(1);
+    Trace::Start(path, options);
+    for (size_t i = 0; i < Trace::RingRecords + 100; i++) {
+        TRACE(i);
+    }
+    const auto stats = Trace::Stop();
+    EXPECT_EQ(stats.records, Trace::RingRecords);
+    EXPECT_EQ(stats.dropped, 100u);
+
+    TraceStats decoded;
+    const auto lines = decode(path, &decoded);
+    EXPECT_EQ(lines.size(), Trace::RingRecords);
+    EXPECT_EQ(decoded.dropped, 100u);
+    EXPECT_NE(lines.back().find("i=16383 "), std::string::npos) << lines.back();
+}
+
+TEST(Trace, RejectsOtherFiles) {
+    std::istringstream in("not a trace");
+    std::ostringstream out;
+    EXPECT_THROW(Trace::Decode(in, out), std::runtime_error);
+    EXPECT_THROW(Trace::Stop(), std::runtime_error);
+}
+
+// Event definitions with no id or too many arguments
+TEST(Trace, RejectsCorruptEvents) {
+    const auto path = tracePath();
+    Trace::Start(path);
+    Trace::Stop();
+    std::ifstream file(path, std::ios::binary);
+    const std::string header((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+
+    const auto event = [](uint32_t id, uint8_t argc) {
+        const auto name = [](std::string& e) {
+            const uint16_t length = 1;
+            e.append(reinterpret_cast<const char*>(&length), sizeof(length)).append("f");
+        };
+        std::string e(1, 'E');
+        e.append(reinterpret_cast<const char*>(&id), sizeof(id));
+        name(e);
+        e.append(1, static_cast<char>(argc));
+        for (uint8_t i = 0; i < argc; i++) {
+            e.append(1, static_cast<char>(TraceType::Int));
+            name(e);
+        }
+        return e;
+    };
+    {
+        std::istringstream in(header + event(1, 6));
+        std::ostringstream out;
+        EXPECT_NO_THROW(Trace::Decode(in, out));
+    }
+    for (const auto& bad : { event(0, 0), event(1, 7) }) {
+        std::istringstream in(header + bad);
+        std::ostringstream out;
+        EXPECT_THROW(Trace::Decode(in, out), std::runtime_error);
+    }
+}
+
+#ifndef NDEBUG
+TEST(Trace, DebugLogTracesTheSearch) {
+    Puzzle p;
+    p.data.rowConstraints = {1, 1, 1};
+    p.data.colConstraints = {0, 3, 0};
+    p.gridWidth = 3;
+    p.gridHeight = 3;
+    p.data.startingGrid.assign(9, Piece::Empty);
+    p.data.startingGrid[Point{1, 0}.project(3)] = Piece::Vertical;
+    p.data.startingGrid[Point{1, 2}.project(3)] = Piece::Vertical;
+
+    const auto path = tracePath();
+    Trace::Start(path);
+    Grid grid(p);
+    PathSolver solver;
+    ASSERT_TRUE(solver.Solve(grid, SolveOptions()).solved());
+    Trace::Stop();
+
+    const auto lines = decode(path);
+    EXPECT_FALSE(lines.empty());
+    const auto tryBuild = std::count_if(lines.begin(), lines.end(), [](const auto& l) {
+        return l.find(" TryBuild : ") != std::string::npos;
+    });
+    EXPECT_GT(tryBuild, 0);
+}
+#endif
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,346 @@
+#include "BatchSolver.h"
+#include "FrontierSolver.h"
+#include "Generator.h"
+#include "Grid.h"
+#include "PathSolver.h"
+#include "PerfCounters.h"
+#include "PortfolioSolver.h"
+#include "RestartSolver.h"
+#include "SegmentSolver.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Bench [--sizes 6,12,...] [--puzzles N] [--steps N] [--deadline ms] [--hints F]
+//       [--seed N] [--solver path|segment|restart|portfolio|frontier|batch|all] [--perf] [--csv]
+//
+// Generates random square puzzles of growing size and solves each one with a
+// step budget and deadline, charting search speed (steps/sec) and memory
+// (grid plus solver scratch) against grid size. --perf also reads the CPU's
+// cycle, instruction, cache miss and branch miss counters around each solve
+// and reports them per step and per puzzle, or n/a where Linux won't let us.
+// batch hands each size's puzzles to a BatchSolver together, for comparing
+// its throughput on small puzzles with solving them one at a time.
+
+namespace {
+    struct Row {
+        int size = 0;
+        std::string solver;
+        int solved = 0;
+        int puzzles = 0;
+        uint64_t steps = 0;
+        double seconds = 0;
+        size_t gridBytes = 0;
+        size_t peakBytes = 0;
+        TrainTracks::PerfSample perf;
+
+        double stepsPerSecond() const {
+            return seconds > 0 ? steps / seconds : 0;
+        }
+
+        double perStep(TrainTracks::PerfEvent e) const {
+            return steps > 0 ? static_cast<double>(perf[e]) / steps : 0;
+        }
+
+        double perPuzzle(TrainTracks::PerfEvent e) const {
+            return puzzles > 0 ? static_cast<double>(perf[e]) / puzzles : 0;
+        }
+    };
+
+    const TrainTracks::PerfEvent PerfEvents[] = {
+        TrainTracks::PerfEvent::Cycles,
+        TrainTracks::PerfEvent::Instructions,
+        TrainTracks::PerfEvent::L1DMisses,
+        TrainTracks::PerfEvent::LLCMisses,
+        TrainTracks::PerfEvent::BranchMisses,
+    };
+
+    struct SolverEntry {
+        const char* name;
+        std::unique_ptr<TrainTracks::Solver> (*make)();
+    };
+
+    // Every engine --solver all runs, bar batch which isn't a Solver
+    const SolverEntry Solvers[] = {
+        { "path", [] () -> std::unique_ptr<TrainTracks::Solver> { return std::make_unique<TrainTracks::PathSolver>(); } },
+        { "segment", [] () -> std::unique_ptr<TrainTracks::Solver> { return std::make_unique<TrainTracks::SegmentSolver>(); } },
+        { "restart", [] () -> std::unique_ptr<TrainTracks::Solver> { return std::make_unique<TrainTracks::RestartSolver>(); } },
+        { "portfolio", [] () -> std::unique_ptr<TrainTracks::Solver> { return std::make_unique<TrainTracks::PortfolioSolver>(); } },
+        { "frontier", [] () -> std::unique_ptr<TrainTracks::Solver> { return std::make_unique<TrainTracks::FrontierSolver>(); } },
+    };
+
+    const SolverEntry* FindSolver(const std::string& name) {
+        for (const auto& entry : Solvers) {
+            if (name == entry.name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    std::unique_ptr<TrainTracks::Solver> MakeSolver(const std::string& name) {
+        return FindSolver(name)->make();
+    }
+
+    int Usage(const char* name) {
+        std::cerr << "Usage: " << name << " [--sizes 6,12,...] [--puzzles N] [--steps N] [--deadline ms]"
+                  << " [--hints F] [--seed N] [--solver path|segment|restart|portfolio|frontier|batch|all] [--perf] [--csv]" << std::endl;
+        return 64;
+    }
+
+    std::string Bar(double value, double max, int width) {
+        const int n = max > 0 ? static_cast<int>(value / max * width + 0.5) : 0;
+        return std::string(std::max(n, value > 0 ? 1 : 0), '#');
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes;
+    for (int s = 6; s <= 60; s += 6) {
+        sizes.push_back(s);
+    }
+    int puzzles = 5;
+    uint64_t steps = 2000000;
+    int deadlineMs = 2000;
+    double hints = 0.15;
+    uint64_t seed = 1;
+    std::vector<std::string> solvers{ "path", "segment" };
+    bool csv = false;
+    bool perf = false;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--sizes" && hasValue) {
+                sizes.clear();
+                TrainTracks::parse_as_integers(std::string(argv[++i]), ',', [&sizes](int s) {
+                    sizes.push_back(s);
+                });
+            } else if (arg == "--puzzles" && hasValue) {
+                puzzles = std::stoi(argv[++i]);
+            } else if (arg == "--steps" && hasValue) {
+                steps = std::stoull(argv[++i]);
+            } else if (arg == "--deadline" && hasValue) {
+                deadlineMs = std::stoi(argv[++i]);
+            } else if (arg == "--hints" && hasValue) {
+                hints = std::stod(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--solver" && hasValue) {
+                const std::string name = argv[++i];
+                solvers.clear();
+                if (name == "all") {
+                    for (const auto& entry : Solvers) {
+                        solvers.push_back(entry.name);
+                    }
+                    solvers.push_back("batch");
+                } else if (name == "batch" || FindSolver(name)) {
+                    solvers.push_back(name);
+                } else {
+                    return Usage(argv[0]);
+                }
+            } else if (arg == "--csv") {
+                csv = true;
+            } else if (arg == "--perf") {
+                perf = true;
+            } else {
+                return Usage(argv[0]);
+            }
+        }
+    } catch (const std::exception&) {
+        return Usage(argv[0]);
+    }
+
+    std::unique_ptr<TrainTracks::PerfCounters> counters;
+    if (perf) {
+        counters = std::make_unique<TrainTracks::PerfCounters>();
+        if (!counters->Error().empty()) {
+            std::cerr << "Hardware counters " << (counters->Available() ? "partly" : "not")
+                      << " available (" << counters->Error() << ")" << std::endl;
+        }
+    }
+
+    std::vector<Row> rows;
+    // Generate throws for sizes it can't make a puzzle of
+    try {
+        for (const auto size : sizes) {
+            for (const auto& name : solvers) {
+                Row row;
+                row.size = size;
+                row.solver = name;
+
+                if (name == "batch") {
+                    std::vector<TrainTracks::Puzzle> pack;
+                    for (int n = 0; n < puzzles; n++) {
+                        TrainTracks::GeneratorOptions options;
+                        options.width = size;
+                        options.height = size;
+                        options.seed = seed + n;
+                        options.hints = hints;
+                        pack.push_back(TrainTracks::Generator::Generate(options));
+                    }
+                    TrainTracks::SolveOptions limits;
+                    limits.maxSteps = steps;
+                    limits.deadline = TrainTracks::SolveClock::now() + std::chrono::milliseconds(deadlineMs);
+                    TrainTracks::BatchSolver batch;
+                    if (counters) {
+                        counters->Start();
+                    }
+                    const auto results = batch.Solve(pack, limits);
+                    if (counters) {
+                        row.perf += counters->Stop();
+                    }
+                    for (const auto& result : results) {
+                        row.puzzles++;
+                        row.solved += result.solved();
+                        row.steps += result.steps;
+                        row.seconds += std::chrono::duration<double>(result.elapsed).count();
+                        row.peakBytes = std::max(row.peakBytes, result.peakBytes);
+                    }
+                    row.gridBytes = TrainTracks::BatchSolver::Fits(pack.front()) ? sizeof(TrainTracks::Bitboard) : 0;
+                    rows.push_back(row);
+                    continue;
+                }
+
+                auto solver = MakeSolver(name);
+                std::optional<TrainTracks::Grid> grid;
+
+                for (int n = 0; n < puzzles; n++) {
+                    TrainTracks::GeneratorOptions options;
+                    options.width = size;
+                    options.height = size;
+                    options.seed = seed + n;
+                    options.hints = hints;
+                    const auto puzzle = TrainTracks::Generator::Generate(options);
+                    if (grid) {
+                        grid->reset(puzzle);
+                    } else {
+                        grid.emplace(puzzle);
+                    }
+
+                    TrainTracks::SolveOptions limits;
+                    limits.maxSteps = steps;
+                    limits.deadline = TrainTracks::SolveClock::now() + std::chrono::milliseconds(deadlineMs);
+                    if (counters) {
+                        counters->Start();
+                    }
+                    const auto result = solver->Solve(*grid, limits);
+                    if (counters) {
+                        row.perf += counters->Stop();
+                    }
+
+                    row.puzzles++;
+                    row.solved += result.solved();
+                    row.steps += result.steps;
+                    row.seconds += std::chrono::duration<double>(result.elapsed).count();
+                    row.gridBytes = std::max(row.gridBytes, grid->bytes());
+                    row.peakBytes = std::max(row.peakBytes, result.peakBytes);
+                }
+                rows.push_back(row);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return Usage(argv[0]);
+    }
+
+    if (csv) {
+        std::cout << "size,solver,solved,puzzles,steps,seconds,steps_per_sec,grid_bytes,peak_bytes";
+        if (perf) {
+            for (const auto e : PerfEvents) {
+                std::cout << ',' << PerfEventName(e) << "_per_step," << PerfEventName(e) << "_per_puzzle";
+            }
+            std::cout << ",ipc";
+        }
+        std::cout << std::endl;
+        for (const auto& r : rows) {
+            std::cout << r.size << ',' << r.solver << ',' << r.solved << ',' << r.puzzles << ','
+                      << r.steps << ',' << r.seconds << ',' << static_cast<uint64_t>(r.stepsPerSecond()) << ','
+                      << r.gridBytes << ',' << r.peakBytes;
+            if (perf) {
+                // Empty cells for counters we couldn't read
+                for (const auto e : PerfEvents) {
+                    if (r.perf.has(e)) {
+                        std::cout << ',' << r.perStep(e) << ',' << static_cast<uint64_t>(r.perPuzzle(e));
+                    } else {
+                        std::cout << ",,";
+                    }
+                }
+                std::cout << ',';
+                if (r.perf.ipc() > 0) {
+                    std::cout << r.perf.ipc();
+                }
+            }
+            std::cout << std::endl;
+        }
+        return 0;
+    }
+
+    double maxRate = 0;
+    size_t maxBytes = 0;
+    for (const auto& r : rows) {
+        maxRate = std::max(maxRate, r.stepsPerSecond());
+        maxBytes = std::max(maxBytes, r.gridBytes + r.peakBytes);
+    }
+
+    std::cout << std::setw(7) << "size" << std::setw(10) << "solver" << std::setw(8) << "solved"
+              << std::setw(12) << "Msteps/s" << std::setw(10) << "grid KiB" << std::setw(10) << "peak KiB"
+              << "  steps/sec" << std::string(20, ' ') << "memory" << std::endl;
+    for (const auto& r : rows) {
+        std::ostringstream size;
+        size << r.size << 'x' << r.size;
+        std::ostringstream solved;
+        solved << r.solved << '/' << r.puzzles;
+        std::cout << std::setw(7) << size.str() << std::setw(10) << r.solver << std::setw(8) << solved.str()
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << r.stepsPerSecond() / 1e6
+                  << std::setw(10) << r.gridBytes / 1024.0
+                  << std::setw(10) << r.peakBytes / 1024.0
+                  << "  " << std::left << std::setw(29) << Bar(r.stepsPerSecond(), maxRate, 28)
+                  << Bar(static_cast<double>(r.gridBytes + r.peakBytes), static_cast<double>(maxBytes), 28)
+                  << std::right << std::endl;
+    }
+
+    if (perf) {
+        const auto cell = [](const TrainTracks::PerfSample& perf, TrainTracks::PerfEvent e, double value, int width) {
+            std::ostringstream out;
+            if (perf.has(e)) {
+                out << std::fixed << std::setprecision(2) << value;
+            } else {
+                out << "n/a";
+            }
+            return std::string(std::max(0, width - static_cast<int>(out.str().size())), ' ') + out.str();
+        };
+        std::cout << std::endl << std::setw(7) << "size" << std::setw(10) << "solver"
+                  << std::setw(11) << "cyc/step" << std::setw(11) << "ins/step" << std::setw(7) << "IPC"
+                  << std::setw(10) << "L1D/step" << std::setw(10) << "LLC/step" << std::setw(10) << "br/step"
+                  << std::setw(11) << "Mcyc/puz" << std::setw(11) << "Mins/puz" << std::setw(11) << "kL1D/puz"
+                  << std::setw(11) << "kLLC/puz" << std::setw(11) << "kbr/puz" << std::endl;
+        for (const auto& r : rows) {
+            using TrainTracks::PerfEvent;
+            std::ostringstream size;
+            size << r.size << 'x' << r.size;
+            std::cout << std::setw(7) << size.str() << std::setw(10) << r.solver
+                      << cell(r.perf, PerfEvent::Cycles, r.perStep(PerfEvent::Cycles), 11)
+                      << cell(r.perf, PerfEvent::Instructions, r.perStep(PerfEvent::Instructions), 11)
+                      << (r.perf.ipc() > 0 ? cell(r.perf, PerfEvent::Cycles, r.perf.ipc(), 7) : "    n/a")
+                      << cell(r.perf, PerfEvent::L1DMisses, r.perStep(PerfEvent::L1DMisses), 10)
+                      << cell(r.perf, PerfEvent::LLCMisses, r.perStep(PerfEvent::LLCMisses), 10)
+                      << cell(r.perf, PerfEvent::BranchMisses, r.perStep(PerfEvent::BranchMisses), 10)
+                      << cell(r.perf, PerfEvent::Cycles, r.perPuzzle(PerfEvent::Cycles) / 1e6, 11)
+                      << cell(r.perf, PerfEvent::Instructions, r.perPuzzle(PerfEvent::Instructions) / 1e6, 11)
+                      << cell(r.perf, PerfEvent::L1DMisses, r.perPuzzle(PerfEvent::L1DMisses) / 1e3, 11)
+                      << cell(r.perf, PerfEvent::LLCMisses, r.perPuzzle(PerfEvent::LLCMisses) / 1e3, 11)
+                      << cell(r.perf, PerfEvent::BranchMisses, r.perPuzzle(PerfEvent::BranchMisses) / 1e3, 11)
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "SearchRecorder.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// SearchReplay [--top N] <recording>
+//
+// Rebuilds a search written by Runner --record and prints where it spent its
+// time: visits, backtracks and prunes per cell, and the failed subtrees
+// which cost the most.
+
+int main(int argc, char** argv) {
+    size_t top = 10;
+    std::string path;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--top" && i + 1 < argc) {
+            top = std::stoul(argv[++i]);
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--top N] <recording>" << std::endl;
+        return 64;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open " << path << std::endl;
+        return 1;
+    }
+    try {
+        TrainTracks::SearchReplay replay(in, top);
+        replay.Print(std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << path << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
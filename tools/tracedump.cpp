@@ -0,0 +1,31 @@
+#include "Trace.h"
+
+#include <fstream>
+#include <iostream>
+
+// TraceDump <trace file>
+//
+// Prints the records in a file written by Runner --trace, oldest first, in
+// the same format as LOG.
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+        return 64;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open " << argv[1] << std::endl;
+        return 1;
+    }
+    try {
+        const auto stats = TrainTracks::Trace::Decode(in, std::cout);
+        if (stats.dropped > 0) {
+            std::cerr << stats.dropped << " records were dropped while tracing" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}